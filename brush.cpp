@@ -280,6 +280,7 @@ void Brush::clear_now()
   // redraw based on changed selection.  Candidate for "pull out method(s)" refactoring?
   pws[1]->color_array_from_selection();
   pws[1]->redraw_all_plots(0);
+  Plot_Window::record_selection();
 }
 
 //***************************************************************************
@@ -0,0 +1,444 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: brush_algebra.cpp
+//
+// Class definitions:
+//   Brush_Algebra -- Set algebra on brush memberships
+//
+// Classes referenced:
+//   Plot_Window -- Gathers and redraws the combined selection
+//   Worker_Pool -- Runs the word-parallel loops
+//   Brush -- Source of the brush to store
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    Blitz++ 0.9 -- Various math routines
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <brush_algebra.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "brush_algebra.h"
+#include "worker_pool.h"
+#include "plot_window.h"
+#include "brush.h"
+
+//***************************************************************************
+// Brush_Algebra::Brush_Algebra() -- Constructor
+Brush_Algebra::Brush_Algebra() :
+  window_( NULL), operands_browser_( NULL), op_choice_( NULL),
+  target_choice_( NULL), slot_choice_( NULL), status_box_( NULL)
+{
+  data_changed();
+}
+
+//***************************************************************************
+// Brush_Algebra::~Brush_Algebra() -- Destructor
+Brush_Algebra::~Brush_Algebra()
+{}
+
+//***************************************************************************
+// Brush_Algebra::count_bits( word) -- STATIC method to count the bits set
+// in a 64-bit word.
+int Brush_Algebra::count_bits( unsigned long long word)
+{
+  word = word - ( ( word >> 1) & 0x5555555555555555ULL);
+  word = ( word & 0x3333333333333333ULL) + ( ( word >> 2) & 0x3333333333333333ULL);
+  word = ( word + ( word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (int) ( ( word * 0x0101010101010101ULL) >> 56);
+}
+
+//***************************************************************************
+// Brush_Algebra::data_changed() -- Discard stored sets, since they refer to
+// points that no longer exist or have moved.
+void Brush_Algebra::data_changed()
+{
+  for( int k=0; k<nstored; k++) {
+    stored_[k].npoints = 0;
+    stored_[k].count = 0;
+    stored_[k].source_brush = -1;
+    stored_[k].state.clear();
+    stored_[k].words.clear();
+  }
+  if( window_ != NULL) refresh_operands();
+}
+
+//***************************************************************************
+// Brush_Algebra::run_chunks( fn, job) -- Run fn over every chunk of points,
+// on the worker pool if there is one.  job->counts receives one entry per
+// chunk.
+void Brush_Algebra::run_chunks( void (*fn)( int, int, int, void*), Job *job)
+{
+  int nchunks = ( npoints + chunk_size - 1) >> chunk_bits;
+  job->counts.assign( nchunks, 0);
+  if( nchunks <= 0) return;
+  if( worker_pool == NULL) {
+    (*fn)( 0, nchunks, 0, (void*) job);
+    return;
+  }
+  int nparts = 4 * ( worker_pool->nthreads() + 1);
+  if( nparts > nchunks) nparts = nchunks;
+  worker_pool->parallel_for( nchunks, nparts, fn, (void*) job);
+}
+
+//***************************************************************************
+// Brush_Algebra::store_chunks( begin, end, ichunk, *data) -- STATIC body of
+// store().  Build the bitmap of one brush for chunks [begin,end) and
+// compress each chunk.
+void Brush_Algebra::store_chunks( int begin, int end, int ichunk, void *data)
+{
+  Job *job = (Job *) data;
+  Stored_Set &set = job->owner->stored_[ job->slot];
+  const int *codes = selected.data();
+  int brush = job->brush;
+
+  for( int c=begin; c<end; c++) {
+    int base = c << chunk_bits;
+    int n = npoints - base;
+    if( n > chunk_size) n = chunk_size;
+    int nwords = ( n + 63) >> 6;
+
+    std::vector<unsigned long long> &words = set.words[c];
+    words.assign( nwords, 0);
+    long count = 0;
+    for( int w=0; w<nwords; w++) {
+      unsigned long long bits = 0;
+      int i0 = base + (w << 6);
+      int nbits = n - (w << 6);
+      if( nbits > 64) nbits = 64;
+      for( int j=0; j<nbits; j++)
+        bits |= (unsigned long long) ( codes[ i0+j] == brush) << j;
+      words[w] = bits;
+      count += count_bits( bits);
+    }
+
+    if( count == 0) set.state[c] = CHUNK_EMPTY;
+    else if( count == n) set.state[c] = CHUNK_FULL;
+    else set.state[c] = CHUNK_MIXED;
+    if( set.state[c] != CHUNK_MIXED) std::vector<unsigned long long>().swap( words);
+    job->counts[c] = count;
+  }
+}
+
+//***************************************************************************
+// Brush_Algebra::store( slot, brush) -- Store the current membership of a
+// brush in a slot.  Returns the number of points stored.
+long Brush_Algebra::store( int slot, int brush)
+{
+  if( slot < 0 || slot >= nstored || brush < 0 || brush >= NBRUSHES) return 0;
+  Stored_Set &set = stored_[ slot];
+  int nchunks = ( npoints + chunk_size - 1) >> chunk_bits;
+  set.npoints = npoints;
+  set.source_brush = brush;
+  set.state.assign( nchunks, CHUNK_EMPTY);
+  set.words.clear();
+  set.words.resize( nchunks);
+
+  Job job;
+  job.owner = this;
+  job.brush = brush;
+  job.slot = slot;
+  run_chunks( store_chunks, &job);
+
+  set.count = 0;
+  for( unsigned int c=0; c<job.counts.size(); c++) set.count += job.counts[c];
+  if( window_ != NULL) refresh_operands();
+  return set.count;
+}
+
+//***************************************************************************
+// Brush_Algebra::combine_chunks( begin, end, ichunk, *data) -- STATIC body
+// of combine().  For each chunk in [begin,end), derive bitmaps of the live
+// brushes from selected in one pass, fold the operands together a word at
+// a time, and write the result back to selected.
+void Brush_Algebra::combine_chunks( int begin, int end, int ichunk, void *data)
+{
+  Job *job = (Job *) data;
+  Brush_Algebra *owner = job->owner;
+  int *codes = selected.data();
+  int target = job->target;
+  int noperands = job->operands.size();
+
+  std::vector<unsigned long long> brush_words( NBRUSHES*words_per_chunk);
+  std::vector<unsigned long long> result( words_per_chunk);
+
+  // Loop: Process successive chunks
+  for( int c=begin; c<end; c++) {
+    int base = c << chunk_bits;
+    int n = npoints - base;
+    if( n > chunk_size) n = chunk_size;
+    int nwords = ( n + 63) >> 6;
+    unsigned long long last_mask = ( n & 63) ? ( 1ULL << ( n & 63)) - 1 : ~0ULL;
+
+    // Bitmaps of every live brush, in a single pass over the chunk
+    std::fill( brush_words.begin(), brush_words.end(), 0ULL);
+    for( int i=0; i<n; i++)
+      brush_words[ codes[ base+i] * words_per_chunk + (i >> 6)] |=
+        1ULL << (i & 63);
+
+    // Fold operands into the result, one word at a time
+    for( int k=0; k<noperands; k++) {
+      int operand = job->operands[k];
+      const unsigned long long *words = NULL;
+      unsigned long long fill = 0ULL;
+      if( operand < NBRUSHES) words = &brush_words[ operand*words_per_chunk];
+      else {
+        const Stored_Set &set = owner->stored_[ operand-NBRUSHES];
+        if( set.state[c] == CHUNK_MIXED) words = &(set.words[c][0]);
+        else if( set.state[c] == CHUNK_FULL) fill = ~0ULL;
+      }
+      for( int w=0; w<nwords; w++) {
+        unsigned long long bits = ( words != NULL) ? words[w] : fill;
+        if( k == 0) result[w] = bits;
+        else if( job->op == OP_AND) result[w] &= bits;
+        else if( job->op == OP_OR) result[w] |= bits;
+        else if( job->op == OP_XOR) result[w] ^= bits;
+        else result[w] &= ~bits;
+      }
+    }
+    result[ nwords-1] &= last_mask;
+
+    // Write the result back.  The target brush ends up holding exactly the
+    // result, so its other points are deselected.
+    long count = 0;
+    for( int w=0; w<nwords; w++) {
+      unsigned long long bits = result[w];
+      unsigned long long in_target = brush_words[ target*words_per_chunk + w];
+      count += count_bits( bits);
+      unsigned long long changes = bits | in_target;
+      int i0 = base + (w << 6);
+      for( int j=0; changes != 0; j++, changes >>= 1, bits >>= 1) {
+        if( ( changes & 1) == 0) continue;
+        codes[ i0+j] = ( bits & 1) ? target : 0;
+      }
+    }
+    job->counts[c] = count;
+  }
+}
+
+//***************************************************************************
+// Brush_Algebra::combine( op, operands, target) -- Combine the operands with
+// the given operation and make the result the membership of the target
+// brush, then gather, redraw, and record the new selection.  Stored sets
+// that don't match the current data are ignored.  Returns the number of
+// points in the result, or -1 if there was nothing to do.
+long Brush_Algebra::combine(
+  int op, const std::vector<int> &operands, int target)
+{
+  if( target < 0 || target >= NBRUSHES || npoints <= 0) return -1;
+
+  Job job;
+  job.owner = this;
+  job.op = op;
+  job.target = target;
+  for( unsigned int k=0; k<operands.size(); k++) {
+    int operand = operands[k];
+    if( operand >= 0 && operand < NBRUSHES) job.operands.push_back( operand);
+    else if( operand >= NBRUSHES && operand < NBRUSHES+nstored &&
+             stored_[ operand-NBRUSHES].npoints == npoints)
+      job.operands.push_back( operand);
+  }
+  if( job.operands.empty()) return -1;
+
+  run_chunks( combine_chunks, &job);
+  long count = 0;
+  for( unsigned int c=0; c<job.counts.size(); c++) count += job.counts[c];
+
+  // The combination is a complete brushing operation
+  previously_selected = selected;
+  newly_selected = 0;
+  selection_is_inverted = false;
+  pws[0]->color_array_from_selection();
+  Plot_Window::redraw_all_plots( 0);
+  Plot_Window::record_selection();
+  return count;
+}
+
+//***************************************************************************
+// Brush_Algebra::refresh_operands() -- Regenerate the list of operands,
+// preserving which ones are checked.
+void Brush_Algebra::refresh_operands()
+{
+  std::vector<int> checked( NBRUSHES+nstored, 0);
+  int nitems = operands_browser_->nitems();
+  for( int i=1; i<=nitems && i<=NBRUSHES+nstored; i++)
+    checked[i-1] = operands_browser_->checked( i);
+
+  operands_browser_->clear();
+  for( int b=0; b<NBRUSHES; b++) {
+    ostringstream oss;
+    oss << "brush " << b;
+    if( b == 0) oss << " (unselected)";
+    operands_browser_->add( oss.str().c_str(), checked[b]);
+  }
+  for( int k=0; k<nstored; k++) {
+    ostringstream oss;
+    oss << "stored set " << (char) ('A'+k);
+    if( stored_[k].npoints != npoints || stored_[k].source_brush < 0)
+      oss << " (empty)";
+    else oss << " (brush " << stored_[k].source_brush
+             << ", " << stored_[k].count << " pts)";
+    operands_browser_->add( oss.str().c_str(), checked[ NBRUSHES+k]);
+  }
+}
+
+//***************************************************************************
+// Brush_Algebra::apply_cb( *o, *data) -- STATIC callback for the Apply
+// button.  Combine the checked operands and report the result.
+void Brush_Algebra::apply_cb( Fl_Widget *o, void *data)
+{
+  Brush_Algebra *algebra = (Brush_Algebra *) data;
+  std::vector<int> operands;
+  int nitems = algebra->operands_browser_->nitems();
+  for( int i=1; i<=nitems; i++)
+    if( algebra->operands_browser_->checked( i)) operands.push_back( i-1);
+
+  struct timeval tp;
+  (void) gettimeofday( &tp, (struct timezone *)0);
+  double start_time = (double)tp.tv_sec + 1.0E-6*(double)tp.tv_usec;
+
+  long count = algebra->combine(
+    algebra->op_choice_->value(), operands, algebra->target_choice_->value());
+
+  (void) gettimeofday( &tp, (struct timezone *)0);
+  double elapsed_time =
+    (double)tp.tv_sec + 1.0E-6*(double)tp.tv_usec - start_time;
+
+  ostringstream oss;
+  if( count < 0) oss << "Check at least one valid operand";
+  else oss << count << " points in brush " << algebra->target_choice_->value()
+           << " (" << (int) (1000.0*elapsed_time + 0.5) << " ms)";
+  algebra->status_ = oss.str();
+  algebra->status_box_->label( algebra->status_.c_str());
+  algebra->window_->redraw();
+}
+
+//***************************************************************************
+// Brush_Algebra::store_cb( *o, *data) -- STATIC callback for the Store
+// button.  Store the brush on the active brush tab in the chosen slot.
+void Brush_Algebra::store_cb( Fl_Widget *o, void *data)
+{
+  Brush_Algebra *algebra = (Brush_Algebra *) data;
+  Brush *bp = dynamic_cast <Brush*> (brushes_tab->value());
+  assert( bp);
+  int slot = algebra->slot_choice_->value();
+  long count = algebra->store( slot, bp->index);
+
+  ostringstream oss;
+  oss << "Stored " << count << " points from brush " << bp->index
+      << " in set " << (char) ('A'+slot);
+  algebra->status_ = oss.str();
+  algebra->status_box_->label( algebra->status_.c_str());
+  algebra->window_->redraw();
+}
+
+//***************************************************************************
+// Brush_Algebra::close_cb( *o, *data) -- STATIC callback to close the
+// window.  Stored sets are kept.
+void Brush_Algebra::close_cb( Fl_Widget *o, void *data)
+{
+  Brush_Algebra *algebra = (Brush_Algebra *) data;
+  algebra->window_->hide();
+}
+
+//***************************************************************************
+// Brush_Algebra::make_window() -- Create the non-modal 'Tools|Combine
+// Brushes' window, if necessary, and show it.
+void Brush_Algebra::make_window()
+{
+  if( window_ == NULL) {
+    Fl::scheme( "plastic");  // optional
+    window_ = new Fl_Window( 360, 270, "Combine Brushes");
+    window_->begin();
+    window_->selection_color( FL_BLUE);
+    window_->labelsize( 10);
+
+    // Operands, in the order they are folded together
+    operands_browser_ = new Fl_Check_Browser( 10, 25, 190, 185, "Operands");
+    operands_browser_->align( FL_ALIGN_TOP_LEFT);
+    operands_browser_->labelsize( 12);
+    operands_browser_->textsize( 12);
+    operands_browser_->tooltip(
+      "Brushes and stored sets to combine, from top to bottom");
+
+    // Operation
+    op_choice_ = new Fl_Choice( 210, 25, 140, 20, "Operation");
+    op_choice_->align( FL_ALIGN_TOP_LEFT);
+    op_choice_->labelsize( 12);
+    op_choice_->textsize( 12);
+    op_choice_->add( "AND");
+    op_choice_->add( "OR");
+    op_choice_->add( "XOR");
+    op_choice_->add( "AND NOT");
+    op_choice_->value( OP_AND);
+    op_choice_->tooltip(
+      "AND NOT removes every later operand from the first one");
+
+    // Target brush
+    target_choice_ = new Fl_Choice( 210, 65, 140, 20, "Result brush");
+    target_choice_->align( FL_ALIGN_TOP_LEFT);
+    target_choice_->labelsize( 12);
+    target_choice_->textsize( 12);
+    for( int b=0; b<NBRUSHES; b++) {
+      ostringstream oss;
+      oss << "brush " << b;
+      target_choice_->add( oss.str().c_str());
+    }
+    target_choice_->value( 1);
+    target_choice_->tooltip(
+      "Brush that will hold exactly the result of the combination");
+
+    Fl_Button *apply_button = new Fl_Button( 210, 95, 140, 25, "&Apply");
+    apply_button->callback( (Fl_Callback*) apply_cb, (void*) this);
+
+    // Store the active brush for later combination
+    slot_choice_ = new Fl_Choice( 210, 150, 140, 20, "Store active brush in");
+    slot_choice_->align( FL_ALIGN_TOP_LEFT);
+    slot_choice_->labelsize( 12);
+    slot_choice_->textsize( 12);
+    for( int k=0; k<nstored; k++) {
+      ostringstream oss;
+      oss << "set " << (char) ('A'+k);
+      slot_choice_->add( oss.str().c_str());
+    }
+    slot_choice_->value( 0);
+
+    Fl_Button *store_button = new Fl_Button( 210, 180, 140, 25, "&Store");
+    store_button->callback( (Fl_Callback*) store_cb, (void*) this);
+    store_button->tooltip(
+      "Remember the points in the active brush so they can be combined later");
+
+    status_box_ = new Fl_Box( 10, 215, 340, 20, "");
+    status_box_->align( FL_ALIGN_INSIDE | FL_ALIGN_LEFT);
+    status_box_->labelsize( 12);
+
+    Fl_Button* close_button = new Fl_Button( 150, 240, 60, 25, "&Close");
+    close_button->callback( (Fl_Callback*) close_cb, (void*) this);
+
+    window_->resizable( NULL);
+    window_->callback( (Fl_Callback*) close_cb, (void*) this);
+    window_->end();
+  }
+  refresh_operands();
+  window_->show();
+}
+
+//***************************************************************************
+// Brush_Algebra::static_make_window( *o, *data) -- STATIC menu callback to
+// show the window for the global Brush_Algebra object.
+void Brush_Algebra::static_make_window( Fl_Widget *o, void *data)
+{
+  if( brush_algebra != NULL) brush_algebra->make_window();
+}
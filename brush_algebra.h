@@ -0,0 +1,150 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: brush_algebra.h
+//
+// Class definitions:
+//   Brush_Algebra -- Set algebra on brush memberships
+//
+// Classes referenced:
+//   Plot_Window -- Gathers and redraws the combined selection
+//   Worker_Pool -- Runs the word-parallel loops
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Combine brush memberships with AND, OR, XOR, and AND NOT into a
+//   target brush, replacing the mask_out_deselected / brush-0 hack in
+//   Plot_Window::update_selection_from_footprint().
+//
+// General design philosophy:
+//   1) Since every point carries exactly one brush code, the live brushes
+//      are disjoint sets.  To make intersections meaningful, the membership
+//      of a brush can also be stored in one of several slots and combined
+//      later with live brushes or other stored sets.
+//   2) Points are split into chunks of 65536.  For each chunk, bitmaps of
+//      all live brushes are derived from selected in one pass, operands are
+//      folded together 64 points at a time, and the result is written back
+//      to selected in the same pass.  Chunks run in parallel.
+//   3) Stored sets are compressed per chunk: chunks that are empty or full
+//      cost nothing, and the rest are kept as 8 KB bitmaps.
+//   4) The target brush ends up containing exactly the result.  Points in
+//      the result move to the target brush, and points that were in the
+//      target brush but are not in the result are deselected.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef BRUSH_ALGEBRA_H
+#define BRUSH_ALGEBRA_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Brush_Algebra
+//
+// Class definitions:
+//   Brush_Algebra -- Set algebra on brush memberships
+//
+// Classes referenced:
+//   Plot_Window, Worker_Pool
+//
+// Purpose: Combine live and stored brush memberships into a target brush
+//   and provide a non-modal window to drive it.
+//
+// Functions:
+//   Brush_Algebra() -- Constructor
+//   ~Brush_Algebra() -- Destructor
+//
+//   store( slot, brush) -- Store the membership of a brush in a slot
+//   combine( op, operands, target) -- Combine operands into target brush
+//   data_changed() -- Discard stored sets because the data have changed
+//   make_window() -- Create and show the window
+//
+//   run_chunks( fn, job) -- Run fn over all chunks, in parallel if possible
+//   refresh_operands() -- Regenerate the list of operands in the window
+//
+// Static functions:
+//   count_bits( word) -- Number of bits set in a word
+//   store_chunks( begin, end, ichunk, *data) -- Body of store()
+//   combine_chunks( begin, end, ichunk, *data) -- Body of combine()
+//   apply_cb( *o, *data) -- Callback for the Apply button
+//   store_cb( *o, *data) -- Callback for the Store button
+//   close_cb( *o, *data) -- Callback to close the window
+//   static_make_window( *o, *data) -- Menu callback
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Brush_Algebra
+{
+  public:
+    // Set operations.  Operands are folded from left to right, so AND NOT
+    // removes every later operand from the first.
+    enum operations { OP_AND=0, OP_OR, OP_XOR, OP_ANDNOT};
+
+    // Operands 0..NBRUSHES-1 are live brushes, and operand NBRUSHES+k is
+    // stored set k
+    static const int nstored = 4;
+
+    // Chunk size, in points and in 64-bit words
+    static const int chunk_bits = 16;
+    static const int chunk_size = 1 << chunk_bits;
+    static const int words_per_chunk = chunk_size/64;
+
+  protected:
+    // Compressed membership of a stored set
+    enum chunk_states { CHUNK_EMPTY=0, CHUNK_FULL, CHUNK_MIXED};
+    struct Stored_Set {
+      int npoints;
+      long count;
+      int source_brush;
+      std::vector<unsigned char> state;
+      std::vector< std::vector<unsigned long long> > words;
+    };
+    Stored_Set stored_[ nstored];
+
+    // Arguments and per-chunk results for the parallel loops
+    struct Job {
+      Brush_Algebra *owner;
+      int op, target, brush, slot;
+      std::vector<int> operands;
+      std::vector<long> counts;
+    };
+
+    // Window and widgets
+    Fl_Window *window_;
+    Fl_Check_Browser *operands_browser_;
+    Fl_Choice *op_choice_, *target_choice_, *slot_choice_;
+    Fl_Box *status_box_;
+    std::string status_;
+
+    void run_chunks( void (*fn)( int, int, int, void*), Job *job);
+    void refresh_operands();
+
+    static int count_bits( unsigned long long word);
+    static void store_chunks( int begin, int end, int ichunk, void *data);
+    static void combine_chunks( int begin, int end, int ichunk, void *data);
+    static void apply_cb( Fl_Widget *o, void *data);
+    static void store_cb( Fl_Widget *o, void *data);
+    static void close_cb( Fl_Widget *o, void *data);
+
+  public:
+    Brush_Algebra();
+    ~Brush_Algebra();
+
+    long store( int slot, int brush);
+    long combine( int op, const std::vector<int> &operands, int target);
+    void data_changed();
+    void make_window();
+    static void static_make_window( Fl_Widget *o, void *data);
+};
+
+#endif   // BRUSH_ALGEBRA_H
@@ -0,0 +1,512 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: brush_statistics.cpp
+//
+// Class definitions:
+//   Brush_Statistics -- Live per-brush descriptive statistics
+//
+// Classes referenced:
+//   Plot_Window -- Source of selection deltas
+//   Control_Panel_Window -- Source of the plotted columns
+//   Worker_Pool -- Runs background recomputations
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    Blitz++ 0.9 -- Various math routines
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <brush_statistics.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "brush_statistics.h"
+#include "data_file_manager.h"
+#include "plot_window.h"
+#include "control_panel_window.h"
+#include "column_info.h"
+#include "worker_pool.h"
+
+// Interval between checks on the background job, in seconds
+const double Brush_Statistics::poll_interval = 0.1;
+
+//***************************************************************************
+// Brush_Statistics::Brush_Statistics() -- Constructor
+Brush_Statistics::Brush_Statistics() :
+  moments_valid_( 0), quantiles_valid_( 0), quantiles_generation_( -1),
+  job_( NULL), job_done_( 0), cancel_( 0), job_pending_( 0),
+  window_( NULL), output_( NULL), display_dirty_( 0)
+{
+  for( int b=0; b<NBRUSHES; b++) count_[ b] = 0.0;
+  pthread_mutex_init( &mutex_, NULL);
+  pthread_cond_init( &cond_, NULL);
+}
+
+//***************************************************************************
+// Brush_Statistics::~Brush_Statistics() -- Destructor
+Brush_Statistics::~Brush_Statistics()
+{
+  cancel_job();
+  Fl::remove_timeout( timeout_cb, (void*) this);
+  pthread_cond_destroy( &cond_);
+  pthread_mutex_destroy( &mutex_);
+}
+
+//***************************************************************************
+// Brush_Statistics::find_tracked_columns( columns, pair_x, pair_y) -- Find
+// the distinct columns shown on any axis of any plot, and the distinct
+// (x,y) pairs of those columns.  Returns 1 if this differs from the set
+// currently being tracked.
+int Brush_Statistics::find_tracked_columns(
+  std::vector<int> &columns,
+  std::vector<int> &pair_x, std::vector<int> &pair_y)
+{
+  columns.clear();
+  pair_x.clear();
+  pair_y.clear();
+  std::map<int,int> column_index;
+  for( int i=0; i<nplots; i++) {
+    if( cps[i] == NULL) continue;
+    int axes[ 3];
+    axes[ 0] = cps[i]->varindex1->value();
+    axes[ 1] = cps[i]->varindex2->value();
+    axes[ 2] = cps[i]->varindex3->value();
+    for( int m=0; m<3; m++) {
+      if( axes[m] < 0 || axes[m] >= nvars) continue;
+      if( column_index.find( axes[m]) == column_index.end()) {
+        column_index[ axes[m]] = columns.size();
+        columns.push_back( axes[m]);
+      }
+    }
+    if( axes[0] < 0 || axes[0] >= nvars || axes[1] < 0 || axes[1] >= nvars ||
+        axes[0] == axes[1]) continue;
+    int kx = column_index[ axes[0]], ky = column_index[ axes[1]];
+    int bFound = 0;
+    for( unsigned int p=0; p<pair_x.size(); p++)
+      if( pair_x[p] == kx && pair_y[p] == ky) bFound = 1;
+    if( !bFound) {
+      pair_x.push_back( kx);
+      pair_y.push_back( ky);
+    }
+  }
+  return columns != columns_ || pair_x != pair_x_ || pair_y != pair_y_;
+}
+
+//***************************************************************************
+// Brush_Statistics::apply_point( i, brush, sign) -- Add (sign=1) or remove
+// (sign=-1) point i from the running sums for a brush.
+void Brush_Statistics::apply_point( int i, int brush, double sign)
+{
+  if( brush < 0 || brush >= NBRUSHES) return;
+  int ncolumns = columns_.size(), npairs = pair_x_.size();
+  count_[ brush] += sign;
+
+  // Shifted values of this point, in the order of columns_
+  std::vector<double> &x = scratch_;
+  x.resize( ncolumns);
+  for( int k=0; k<ncolumns; k++) {
+    x[k] = Data_File_Manager::column_info[ columns_[k]].points(i) - shift_[k];
+    sum_[ brush*ncolumns+k] += sign*x[k];
+    sum2_[ brush*ncolumns+k] += sign*x[k]*x[k];
+  }
+  for( int p=0; p<npairs; p++)
+    sumxy_[ brush*npairs+p] += sign*x[ pair_x_[p]]*x[ pair_y_[p]];
+}
+
+//***************************************************************************
+// Brush_Statistics::update_from_selection_delta() -- Called by
+// Plot_Window::color_array_from_selection after every gather.  If the
+// running sums are valid and the gather recorded which points changed,
+// move those points between brushes.  Otherwise leave it to the next
+// background job.  In either case the order statistics are now stale.
+void Brush_Statistics::update_from_selection_delta()
+{
+  if( window_ == NULL || !window_->shown()) {
+    moments_valid_ = 0;
+    return;
+  }
+
+  if( moments_valid_ && Plot_Window::selection_delta_valid) {
+    int nchanged = Plot_Window::changed_points.size();
+    for( int j=0; j<nchanged; j++) {
+      int i = Plot_Window::changed_points[j];
+      apply_point( i, Plot_Window::changed_from[j], -1.0);
+      apply_point( i, Plot_Window::gathered_selection(i), 1.0);
+    }
+  }
+  else moments_valid_ = 0;
+
+  job_pending_ = 1;
+  display_dirty_ = 1;
+}
+
+//***************************************************************************
+// Brush_Statistics::data_changed() -- The data or columns have changed, so
+// stop any background job before it reads them and discard all results.
+void Brush_Statistics::data_changed()
+{
+  cancel_job();
+  moments_valid_ = 0;
+  quantiles_valid_ = 0;
+  columns_.clear();
+  pair_x_.clear();
+  pair_y_.clear();
+  job_pending_ = 1;
+  display_dirty_ = 1;
+}
+
+//***************************************************************************
+// Brush_Statistics::submit_job() -- Snapshot the selection and the tracked
+// columns and start a background recomputation of the running sums and
+// order statistics.
+void Brush_Statistics::submit_job()
+{
+  if( job_ != NULL || worker_pool == NULL) return;
+
+  Job *job = new Job;
+  job->owner = this;
+  find_tracked_columns( job->columns, job->pair_x, job->pair_y);
+  job->generation = Plot_Window::selection_generation;
+  for( unsigned int k=0; k<job->columns.size(); k++)
+    job->ranked.push_back(
+      Data_File_Manager::column_info[ job->columns[k]].isRanked ? 1 : 0);
+
+  // Take the snapshot from the last gather if possible, since that is the
+  // state the running sums will be reconciled against
+  job->snapshot.resize( npoints);
+  if( Plot_Window::gathered_selection.rows() == npoints) {
+    for( int i=0; i<npoints; i++)
+      job->snapshot[i] = (unsigned char) Plot_Window::gathered_selection(i);
+  }
+  else {
+    for( int i=0; i<npoints; i++)
+      job->snapshot[i] = (unsigned char) selected(i);
+  }
+
+  job_ = job;
+  job_done_ = 0;
+  cancel_ = 0;
+  job_pending_ = 0;
+  worker_pool->submit( run_job, (void*) job);
+}
+
+//***************************************************************************
+// Brush_Statistics::run_job( *data) -- STATIC body of the background job.
+// Runs on a worker thread, so it must only touch the job and read the
+// column data.  Column data are read through raw pointers because the
+// reference counts of blitz arrays are not thread safe.
+void Brush_Statistics::run_job( void *data)
+{
+  Job *job = (Job *) data;
+  Brush_Statistics *owner = job->owner;
+  int ncolumns = job->columns.size(), npairs = job->pair_x.size();
+  const unsigned char *snapshot = &(job->snapshot[0]);
+
+  for( int b=0; b<NBRUSHES; b++) job->count[b] = 0.0;
+  for( int i=0; i<npoints; i++) job->count[ snapshot[i]] += 1.0;
+
+  job->shift.assign( ncolumns, 0.0);
+  job->sum.assign( NBRUSHES*ncolumns, 0.0);
+  job->sum2.assign( NBRUSHES*ncolumns, 0.0);
+  job->sumxy.assign( NBRUSHES*npairs, 0.0);
+  job->min.assign( NBRUSHES*ncolumns, 0.0);
+  job->max.assign( NBRUSHES*ncolumns, 0.0);
+  job->median.assign( NBRUSHES*ncolumns, 0.0);
+
+  // Loop: Accumulate sums and order statistics for each column.  Use the
+  // median of the column as the shift if it is ranked.
+  for( int k=0; k<ncolumns && !owner->cancel_; k++) {
+    Column_Info &info = Data_File_Manager::column_info[ job->columns[k]];
+    const float *points = info.points.data();
+    const int *ranks = info.ranked_points.data();
+    if( job->ranked[k]) job->shift[k] = points[ ranks[ npoints/2]];
+    else job->shift[k] = points[ 0];
+    double shift = job->shift[k];
+
+    for( int i=0; i<npoints; i++) {
+      double x = points[i] - shift;
+      int b = snapshot[i];
+      job->sum[ b*ncolumns+k] += x;
+      job->sum2[ b*ncolumns+k] += x*x;
+    }
+
+    // Walk the points in rank order.  The first and last points seen for a
+    // brush are its minimum and maximum, and the point at which half of it
+    // has been seen is its (lower) median.
+    if( job->ranked[k]) {
+      int nseen[ NBRUSHES];
+      for( int b=0; b<NBRUSHES; b++) nseen[b] = 0;
+      for( int r=0; r<npoints; r++) {
+        int i = ranks[r];
+        int b = snapshot[i];
+        float x = points[i];
+        nseen[b]++;
+        if( nseen[b] == 1) job->min[ b*ncolumns+k] = x;
+        if( nseen[b] == ((int) job->count[b] + 1)/2)
+          job->median[ b*ncolumns+k] = x;
+        job->max[ b*ncolumns+k] = x;
+      }
+    }
+  }
+
+  // Accumulate cross products for each pair
+  for( int p=0; p<npairs && !owner->cancel_; p++) {
+    int kx = job->pair_x[p], ky = job->pair_y[p];
+    const float *xpoints =
+      Data_File_Manager::column_info[ job->columns[kx]].points.data();
+    const float *ypoints =
+      Data_File_Manager::column_info[ job->columns[ky]].points.data();
+    double xshift = job->shift[kx], yshift = job->shift[ky];
+    for( int i=0; i<npoints; i++)
+      job->sumxy[ snapshot[i]*npairs+p] +=
+        (xpoints[i] - xshift) * (ypoints[i] - yshift);
+  }
+
+  // Tell the main thread we're done
+  pthread_mutex_lock( &owner->mutex_);
+  owner->job_done_ = 1;
+  pthread_cond_broadcast( &owner->cond_);
+  pthread_mutex_unlock( &owner->mutex_);
+}
+
+//***************************************************************************
+// Brush_Statistics::cancel_job() -- Ask the background job to stop, wait
+// for it, and discard its results.
+void Brush_Statistics::cancel_job()
+{
+  if( job_ == NULL) return;
+  cancel_ = 1;
+  pthread_mutex_lock( &mutex_);
+  while( !job_done_) pthread_cond_wait( &cond_, &mutex_);
+  pthread_mutex_unlock( &mutex_);
+  delete job_;
+  job_ = NULL;
+  cancel_ = 0;
+}
+
+//***************************************************************************
+// Brush_Statistics::finish_job() -- Install the results of the background
+// job.  The running sums describe the snapshot, so move any points whose
+// brush has changed since then.  If the plotted columns changed while the
+// job ran, discard the results and try again.
+void Brush_Statistics::finish_job()
+{
+  Job *job = job_;
+  job_ = NULL;
+
+  std::vector<int> columns, pair_x, pair_y;
+  find_tracked_columns( columns, pair_x, pair_y);
+  if( columns != job->columns || pair_x != job->pair_x ||
+      pair_y != job->pair_y || (int) job->snapshot.size() != npoints) {
+    delete job;
+    columns_ = columns;
+    pair_x_ = pair_x;
+    pair_y_ = pair_y;
+    moments_valid_ = 0;
+    quantiles_valid_ = 0;
+    job_pending_ = 1;
+    return;
+  }
+
+  columns_ = job->columns;
+  pair_x_ = job->pair_x;
+  pair_y_ = job->pair_y;
+  shift_.swap( job->shift);
+  for( int b=0; b<NBRUSHES; b++) count_[b] = job->count[b];
+  sum_.swap( job->sum);
+  sum2_.swap( job->sum2);
+  sumxy_.swap( job->sumxy);
+  min_.swap( job->min);
+  max_.swap( job->max);
+  median_.swap( job->median);
+  ranked_.swap( job->ranked);
+  quantiles_generation_ = job->generation;
+  quantiles_valid_ = 0;
+  for( unsigned int k=0; k<ranked_.size(); k++)
+    if( ranked_[k]) quantiles_valid_ = 1;
+
+  if( Plot_Window::gathered_selection.rows() == npoints) {
+    for( int i=0; i<npoints; i++) {
+      int b = Plot_Window::gathered_selection(i);
+      if( b != job->snapshot[i]) {
+        apply_point( i, job->snapshot[i], -1.0);
+        apply_point( i, b, 1.0);
+      }
+    }
+  }
+  moments_valid_ = 1;
+  if( quantiles_generation_ != Plot_Window::selection_generation)
+    job_pending_ = 1;
+  display_dirty_ = 1;
+  delete job;
+}
+
+//***************************************************************************
+// Brush_Statistics::poll() -- Collect the results of a finished job, start
+// a new one if the selection or the plotted columns have changed, and
+// refresh the window if anything is new.
+void Brush_Statistics::poll()
+{
+  if( job_ != NULL) {
+    pthread_mutex_lock( &mutex_);
+    int bDone = job_done_;
+    pthread_mutex_unlock( &mutex_);
+    if( bDone) finish_job();
+  }
+
+  std::vector<int> columns, pair_x, pair_y;
+  if( find_tracked_columns( columns, pair_x, pair_y)) {
+    moments_valid_ = 0;
+    job_pending_ = 1;
+  }
+  if( job_ == NULL && job_pending_) submit_job();
+
+  if( display_dirty_) refresh_window();
+}
+
+//***************************************************************************
+// Brush_Statistics::refresh_window() -- Regenerate the text in the window.
+void Brush_Statistics::refresh_window()
+{
+  if( output_ == NULL) return;
+  display_dirty_ = 0;
+
+  ostringstream oss;
+  char cLine[ 256];
+  int ncolumns = columns_.size(), npairs = pair_x_.size();
+  int quantiles_current =
+    quantiles_valid_ && quantiles_generation_ == Plot_Window::selection_generation;
+
+  if( !moments_valid_) {
+    oss << "Computing statistics..." << endl;
+    output_->value( oss.str().c_str());
+    return;
+  }
+
+  for( int b=0; b<NBRUSHES; b++) {
+    int n = (int) (count_[b] + 0.5);
+    if( b == 0) sprintf( cLine, "Unselected : %10i points\n", n);
+    else sprintf( cLine, "Brush %i    : %10i points\n", b, n);
+    oss << cLine;
+    if( n <= 0) { oss << endl; continue;}
+
+    sprintf(
+      cLine, "  %-16s %12s %12s %12s %12s %12s\n",
+      "column", "mean", "std dev", "min",
+      quantiles_current || !quantiles_valid_ ? "median" : "median*", "max");
+    oss << cLine;
+    for( int k=0; k<ncolumns; k++) {
+      double s = sum_[ b*ncolumns+k], s2 = sum2_[ b*ncolumns+k];
+      double mean = s/n + shift_[k];
+      double var = n>1 ? (s2 - s*s/n)/(n-1) : 0.0;
+      if( var < 0) var = 0;
+      string sLabel = Data_File_Manager::column_info[ columns_[k]].label;
+      if( quantiles_valid_ && ranked_[k])
+        sprintf(
+          cLine, "  %-16.16s %12.5g %12.5g %12.5g %12.5g %12.5g\n",
+          sLabel.c_str(), mean, sqrt( var), min_[ b*ncolumns+k],
+          median_[ b*ncolumns+k], max_[ b*ncolumns+k]);
+      else
+        sprintf(
+          cLine, "  %-16.16s %12.5g %12.5g %12s %12s %12s\n",
+          sLabel.c_str(), mean, sqrt( var), "-", "-", "-");
+      oss << cLine;
+    }
+
+    // Correlation of each plotted pair
+    for( int p=0; p<npairs; p++) {
+      int kx = pair_x_[p], ky = pair_y_[p];
+      double sx = sum_[ b*ncolumns+kx], sy = sum_[ b*ncolumns+ky];
+      double sxx = sum2_[ b*ncolumns+kx], syy = sum2_[ b*ncolumns+ky];
+      double sxy = sumxy_[ b*npairs+p];
+      double denom = (n*sxx - sx*sx) * (n*syy - sy*sy);
+      string sPair =
+        Data_File_Manager::column_info[ columns_[kx]].label + " vs " +
+        Data_File_Manager::column_info[ columns_[ky]].label;
+      if( denom > 0)
+        sprintf(
+          cLine, "  corr( %.100s) = %.4f\n",
+          sPair.c_str(), (n*sxy - sx*sy) / sqrt( denom));
+      else sprintf( cLine, "  corr( %.100s) = -\n", sPair.c_str());
+      oss << cLine;
+    }
+    oss << endl;
+  }
+  if( quantiles_valid_ && !quantiles_current) oss << "* updating" << endl;
+  output_->value( oss.str().c_str());
+}
+
+//***************************************************************************
+// Brush_Statistics::timeout_cb( *data) -- STATIC callback to poll while
+// the window is open.
+void Brush_Statistics::timeout_cb( void *data)
+{
+  Brush_Statistics *stats = (Brush_Statistics *) data;
+  if( stats->window_ == NULL || !stats->window_->shown()) return;
+  stats->poll();
+  Fl::repeat_timeout( poll_interval, timeout_cb, data);
+}
+
+//***************************************************************************
+// Brush_Statistics::close_cb( *o, *data) -- STATIC callback to close the
+// window.  Stop tracking until it is opened again.
+void Brush_Statistics::close_cb( Fl_Widget *o, void *data)
+{
+  Brush_Statistics *stats = (Brush_Statistics *) data;
+  stats->window_->hide();
+  Fl::remove_timeout( timeout_cb, data);
+  stats->cancel_job();
+  stats->moments_valid_ = 0;
+}
+
+//***************************************************************************
+// Brush_Statistics::make_window() -- Create the non-modal statistics
+// window, if necessary, show it, and start polling.
+void Brush_Statistics::make_window()
+{
+  if( window_ == NULL) {
+    Fl::scheme( "plastic");  // optional
+    window_ = new Fl_Window( 640, 480, "Live Brush Statistics");
+    window_->begin();
+    window_->selection_color( FL_BLUE);
+    window_->labelsize( 10);
+
+    output_ = new Fl_Multiline_Output( 5, 5, 630, 440);
+    output_->textfont( FL_COURIER);
+    output_->textsize( 12);
+
+    Fl_Button* close_button = new Fl_Button( 290, 450, 60, 25, "&Close");
+    close_button->callback( (Fl_Callback*) close_cb, (void*) this);
+
+    window_->resizable( output_);
+    window_->callback( (Fl_Callback*) close_cb, (void*) this);
+    window_->end();
+  }
+  window_->show();
+
+  moments_valid_ = 0;
+  job_pending_ = 1;
+  display_dirty_ = 1;
+  Fl::remove_timeout( timeout_cb, (void*) this);
+  Fl::add_timeout( poll_interval, timeout_cb, (void*) this);
+  poll();
+}
+
+//***************************************************************************
+// Brush_Statistics::static_make_window( *o, *data) -- STATIC menu callback
+// to show the window for the global Brush_Statistics object.
+void Brush_Statistics::static_make_window( Fl_Widget *o, void *data)
+{
+  if( brush_statistics != NULL) brush_statistics->make_window();
+}
@@ -0,0 +1,162 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: brush_statistics.h
+//
+// Class definitions:
+//   Brush_Statistics -- Live per-brush descriptive statistics
+//
+// Classes referenced:
+//   Plot_Window -- Source of selection deltas
+//   Control_Panel_Window -- Source of the plotted columns
+//   Worker_Pool -- Runs background recomputations
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Maintain and display count, mean, standard deviation, minimum,
+//   median, maximum, and correlation for each brush and every plotted
+//   column while the user brushes.
+//
+// General design philosophy:
+//   1) Moments are kept as running sums that are updated on the main thread
+//      from the list of points whose brush changed during the last gather,
+//      so they are always current and cost is proportional to the change.
+//   2) Order statistics come from the rank arrays.  They, and an exact
+//      rebuild of the running sums, are computed by a background job on a
+//      snapshot of the selection.  Only one job is in flight at a time, and
+//      a new one is started when it finishes if the selection has moved on.
+//   3) Nothing is tracked while the window is closed.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef BRUSH_STATISTICS_H
+#define BRUSH_STATISTICS_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Brush_Statistics
+//
+// Class definitions:
+//   Brush_Statistics -- Live per-brush descriptive statistics
+//
+// Classes referenced:
+//   Plot_Window, Control_Panel_Window, Worker_Pool
+//
+// Purpose: Maintain per-brush statistics for the plotted columns and show
+//   them in a non-modal window.
+//
+// Functions:
+//   Brush_Statistics() -- Constructor
+//   ~Brush_Statistics() -- Destructor
+//
+//   update_from_selection_delta() -- Apply changes from the last gather
+//   data_changed() -- Discard everything because the data have changed
+//   make_window() -- Create and show the statistics window
+//
+//   find_tracked_columns( columns, pair_x, pair_y) -- Find plotted columns
+//   apply_point( i, brush, sign) -- Add or remove one point from the sums
+//   submit_job() -- Start a background recomputation
+//   finish_job() -- Install the results of a background recomputation
+//   cancel_job() -- Stop a background recomputation and wait for it
+//   poll() -- Check on the background job and refresh the window
+//   refresh_window() -- Regenerate text in the statistics window
+//
+// Static functions:
+//   run_job( *data) -- Body of the background recomputation
+//   timeout_cb( *data) -- Periodic callback while the window is open
+//   close_cb( *o, *data) -- Callback to close the window
+//   static_make_window( *o, *data) -- Menu callback
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Brush_Statistics
+{
+  protected:
+    // Columns being tracked, and pairs of indices into columns_ for which
+    // correlations are maintained (one pair per distinct plot)
+    std::vector<int> columns_;
+    std::vector<int> pair_x_, pair_y_;
+
+    // Running sums for each brush.  Values are shifted by a typical value
+    // of each column to limit cancellation.  sum_ and sum2_ are indexed
+    // [brush*ncolumns+k] and sumxy_ is indexed [brush*npairs+p].
+    int moments_valid_;
+    std::vector<double> shift_;
+    double count_[ NBRUSHES];
+    std::vector<double> sum_, sum2_, sumxy_;
+    std::vector<double> scratch_;
+
+    // Order statistics for each brush from the most recent background job,
+    // indexed [brush*ncolumns+k], and the selection generation they describe.
+    // They are only known for columns that were ranked, flagged in ranked_,
+    // and quantiles_valid_ is only set if there was at least one.
+    int quantiles_valid_;
+    int quantiles_generation_;
+    std::vector<unsigned char> ranked_;
+    std::vector<float> min_, max_, median_;
+
+    // Background job.  The snapshot and results belong to the job until
+    // job_done is set.
+    struct Job {
+      Brush_Statistics *owner;
+      std::vector<int> columns, pair_x, pair_y;
+      std::vector<unsigned char> snapshot;
+      int generation;
+      std::vector<unsigned char> ranked;
+      std::vector<double> shift;
+      double count[ NBRUSHES];
+      std::vector<double> sum, sum2, sumxy;
+      std::vector<float> min, max, median;
+    };
+    Job *job_;
+    int job_done_;
+    volatile int cancel_;
+    int job_pending_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+
+    // Window and display state
+    Fl_Window *window_;
+    Fl_Multiline_Output *output_;
+    int display_dirty_;
+
+    int find_tracked_columns(
+      std::vector<int> &columns,
+      std::vector<int> &pair_x, std::vector<int> &pair_y);
+    void apply_point( int i, int brush, double sign);
+    void submit_job();
+    void finish_job();
+    void cancel_job();
+    void poll();
+    void refresh_window();
+
+    static void run_job( void *data);
+    static void timeout_cb( void *data);
+    static void close_cb( Fl_Widget *o, void *data);
+
+  public:
+    Brush_Statistics();
+    ~Brush_Statistics();
+
+    void update_from_selection_delta();
+    void data_changed();
+    void make_window();
+    static void static_make_window( Fl_Widget *o, void *data);
+
+    // Interval between checks on the background job, in seconds
+    static const double poll_interval;
+};
+
+#endif   // BRUSH_STATISTICS_H
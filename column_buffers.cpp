@@ -0,0 +1,678 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: column_buffers.cpp
+//
+// Class definitions:
+//   Column_Buffers -- GPU buffers of plotted columns, shared between plots
+//
+// Classes referenced:
+//   Plot_Window -- Supplies the columns and selection, and draws from
+//     the buffers
+//
+// Required packages
+//    OGLEXP 1.2.2 -- Access to OpenGL extension under Windows
+//    Blitz++ 0.9 -- Various math routines
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <column_buffers.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "column_buffers.h"
+#include "plot_window.h"
+#include "symbol_atlas.h"
+
+// Set static data members for class Column_Buffers::
+std::vector<Column_Buffers::Entry> Column_Buffers::entries_;
+std::vector<GLuint> Column_Buffers::free_names_;
+std::vector<GLuint> Column_Buffers::pending_deletes_;
+int Column_Buffers::data_generation_ = 0;
+int Column_Buffers::private_generation_ = 0;
+int Column_Buffers::epoch_ = 0;
+GLuint Column_Buffers::program_ = 0;
+int Column_Buffers::program_failed_ = 0;
+GLint Column_Buffers::function_location_ = -1;
+GLint Column_Buffers::mix_location_ = -1;
+GLint Column_Buffers::use_brushes_location_ = -1;
+GLint Column_Buffers::brush_depth_location_ = -1;
+GLint Column_Buffers::brush_color_location_ = -1;
+GLint Column_Buffers::brush_size_location_ = -1;
+GLint Column_Buffers::symbol_location_ = -1;
+GLint Column_Buffers::brush_symbol_location_ = -1;
+GLint Column_Buffers::atlas_location_ = -1;
+int Column_Buffers::bound_ = 0;
+Column_Buffers::Ring Column_Buffers::brush_ring_;
+int Column_Buffers::brush_npoints_ = -1;
+int Column_Buffers::brush_generation_ = -1;
+Column_Buffers::Upload_Counts Column_Buffers::uploads_total_;
+Column_Buffers::Upload_Counts Column_Buffers::uploads_frame_;
+
+// Buffer names 1 to MAXPLOTS hold plots' own interleaved vertices
+GLuint Column_Buffers::next_name_ = MAXPLOTS + 1;
+
+// Vertex shader to assemble a vertex from the x, y, and z streams, apply
+// each axis's function, and optionally rotate x and y to sum-vs-difference.
+// These match Plot_Window::normalize() and Plot_Window::transform_2d().
+// When drawing all brushes at once, each point's brush chooses its color,
+// size, and symbol, brushes with no size are clipped away, and the depth
+// can be set by brush so a depth test orders the brushes.  Otherwise the
+// symbol is vp_symbol.  Symbols drawn as sprites pass the atlas cell to the
+// fragment shader.  VP_NBRUSHES and VP_ATLAS_COLUMNS are defined when the
+// shader is compiled.
+static const char *vertex_shader_source =
+  "attribute float vp_x;\n"
+  "attribute float vp_y;\n"
+  "attribute float vp_z;\n"
+  "attribute float vp_brush;\n"
+  "uniform ivec3 vp_function;\n"
+  "uniform int vp_sum_vs_difference;\n"
+  "uniform int vp_use_brushes;\n"
+  "uniform int vp_brush_depth;\n"
+  "uniform int vp_symbol;\n"
+  "uniform vec4 vp_brush_color[ VP_NBRUSHES];\n"
+  "uniform float vp_brush_size[ VP_NBRUSHES];\n"
+  "uniform int vp_brush_symbol[ VP_NBRUSHES];\n"
+  "varying vec3 vp_sprite;\n"
+  "float vp_apply( float a, int f)\n"
+  "{\n"
+  "  if( f == 1) return a > 0.0 ? 0.4342944819 * log( a) : 0.0;\n"
+  "  if( f == 2) return a / ( 1.0 + abs( a));\n"
+  "  return a;\n"
+  "}\n"
+  "void main()\n"
+  "{\n"
+  "  vec3 p = vec3( vp_apply( vp_x, vp_function.x),\n"
+  "                 vp_apply( vp_y, vp_function.y),\n"
+  "                 vp_apply( vp_z, vp_function.z));\n"
+  "  if( vp_sum_vs_difference != 0)\n"
+  "    p.xy = 0.7071067812 * vec2( p.x + p.y, p.y - p.x);\n"
+  "  gl_Position = gl_ModelViewProjectionMatrix * vec4( p, 1.0);\n"
+  "  gl_FrontColor = gl_Color;\n"
+  "  int symbol = vp_symbol;\n"
+  "  if( vp_use_brushes != 0) {\n"
+  "    int b = int( vp_brush + 0.5);\n"
+  "    gl_FrontColor = vp_brush_color[ b];\n"
+  "    gl_PointSize = vp_brush_size[ b];\n"
+  "    symbol = vp_brush_symbol[ b];\n"
+  "    if( vp_brush_size[ b] <= 0.0)\n"
+  "      gl_Position = vec4( 2.0, 2.0, 2.0, 1.0);\n"
+  "    else if( vp_brush_depth != 0)\n"
+  "      gl_Position.z =\n"
+  "        gl_Position.w * ( 2.0 * ( float( b) + 0.5) / float( VP_NBRUSHES) - 1.0);\n"
+  "  }\n"
+  "  vp_sprite = vec3( 0.0, 0.0, -1.0);\n"
+  "  if( symbol >= 2) {\n"
+  "    float s = float( symbol);\n"
+  "    vp_sprite = vec3(\n"
+  "      mod( s, VP_ATLAS_COLUMNS), floor( s / VP_ATLAS_COLUMNS), 1.0);\n"
+  "  }\n"
+  "}\n";
+
+// Fragment shader to color points, lines, and symbols.  A symbol is read
+// from its cell of the atlas at the coordinates point sprites give texture
+// unit 0, inset by half a texel so that neighbors don't bleed in.
+// Hard-edged symbols are cut from the distance field, with an edge one
+// screen pixel wide at any size; others are shaded by luminance, like the
+// sprite textures they replace.  With VP_ALPHA_TEXTURE the
+// luminance is also the alpha, as GL_INTENSITY textures were.
+// VP_ATLAS_COLUMNS and VP_ATLAS_INSET are defined when the shader is
+// compiled.
+static const char *fragment_shader_source =
+  "uniform sampler2D vp_atlas;\n"
+  "varying vec3 vp_sprite;\n"
+  "void main()\n"
+  "{\n"
+  "  gl_FragColor = gl_Color;\n"
+  "  if( vp_sprite.z > 0.0) {\n"
+  "    vec2 t = clamp( gl_TexCoord[0].st, VP_ATLAS_INSET, 1.0 - VP_ATLAS_INSET);\n"
+  "    vec4 texel = texture2D( vp_atlas, ( vp_sprite.xy + t) / VP_ATLAS_COLUMNS);\n"
+  "    float l = texel.r;\n"
+  "    if( texel.g > 0.5) {\n"
+  "      float w = max( 0.5 * fwidth( texel.a), 0.001);\n"
+  "      l = smoothstep( 0.5 - w, 0.5 + w, texel.a);\n"
+  "    }\n"
+  "    gl_FragColor.rgb *= l;\n"
+  "#ifdef VP_ALPHA_TEXTURE\n"
+  "    gl_FragColor.a *= l;\n"
+  "#endif\n"
+  "  }\n"
+  "}\n";
+
+//***************************************************************************
+// Column_Buffers::shared_key( column, style, offset) -- STATIC method to get
+// the key of a column as normalized with style and shifted by offset,
+// which any plot can use.
+Column_Buffers::Key Column_Buffers::shared_key(
+  int column, int style, int offset)
+{
+  Key key;
+  key.column = column;
+  key.style = style;
+  key.offset = offset;
+  key.owner = -1;
+  key.generation = data_generation_;
+  return key;
+}
+
+//***************************************************************************
+// Column_Buffers::private_key( owner, axis) -- STATIC method to get a key
+// for an axis that only plot owner can use.  Each call gives a new key,
+// since the plot's axis has new contents.
+Column_Buffers::Key Column_Buffers::private_key( int owner, int axis)
+{
+  Key key;
+  key.column = axis;
+  key.style = 0;
+  key.offset = 0;
+  key.owner = owner;
+  key.generation = ++private_generation_;
+  return key;
+}
+
+//***************************************************************************
+// Column_Buffers::same_key( a, b) -- STATIC method to compare keys.
+int Column_Buffers::same_key( const Key &a, const Key &b)
+{
+  return a.column == b.column && a.style == b.style &&
+         a.offset == b.offset && a.owner == b.owner &&
+         a.generation == b.generation;
+}
+
+//***************************************************************************
+// Column_Buffers::find( key, n) -- STATIC method to use the buffer of n
+// points for key, if one has been uploaded.  Returns 0 if not.
+GLuint Column_Buffers::find( const Key &key, int n)
+{
+  for( unsigned int i=0; i<entries_.size(); i++) {
+    if( same_key( entries_[i].key, key) && entries_[i].npoints == n) {
+      entries_[i].refs++;
+      return entries_[i].name;
+    }
+  }
+  return 0;
+}
+
+//***************************************************************************
+// Column_Buffers::acquire( key, data, stride, n) -- STATIC method to get
+// the buffer for key, uploading n floats from data[0], data[stride], ...
+// if no plot has one yet.  Must be called with a GL context current.
+GLuint Column_Buffers::acquire(
+  const Key &key, const float *data, int stride, int n)
+{
+  flush_deletes();
+  GLuint name = find( key, n);
+  if( name != 0) return name;
+  name = new_name();
+
+  // Gather the strided column in blocks and upload them.  A column of
+  // -1 is all zeros.
+  glBindBuffer( GL_ARRAY_BUFFER, name);
+  glBufferData(
+    GL_ARRAY_BUFFER, (GLsizeiptr) n*sizeof(GLfloat), (void *) NULL,
+    GL_STATIC_DRAW);
+  std::vector<GLfloat> block( min( n, (int) upload_block), 0.0f);
+  for( int begin=0; begin<n; begin+=upload_block) {
+    int m = min( n-begin, (int) upload_block);
+    if( key.column >= 0 || key.owner >= 0)
+      for( int j=0; j<m; j++) block[j] = data[ (long) (begin+j)*stride];
+    upload(
+      GL_ARRAY_BUFFER, (GLintptr) begin*sizeof(GLfloat),
+      (GLsizeiptr) m*sizeof(GLfloat), &(block[0]));
+  }
+  glBindBuffer( GL_ARRAY_BUFFER, 0);
+  GLenum error = glGetError();
+  if( error != GL_NO_ERROR)
+    cerr << "Column_Buffers::acquire: " << gluErrorString( error)
+         << " uploading column " << key.column << endl;
+
+  Entry entry;
+  entry.key = key;
+  entry.npoints = n;
+  entry.name = name;
+  entry.refs = 1;
+  entries_.push_back( entry);
+  return name;
+}
+
+//***************************************************************************
+// Column_Buffers::new_name() -- STATIC method to choose a name for a new
+// buffer, reusing the names of deleted ones.
+GLuint Column_Buffers::new_name()
+{
+  if( free_names_.empty()) return next_name_++;
+  GLuint name = free_names_.back();
+  free_names_.pop_back();
+  return name;
+}
+
+//***************************************************************************
+// Column_Buffers::release( buffer, epoch) -- STATIC method to stop using a
+// buffer acquired in epoch.  Buffers nobody uses are deleted the next time
+// a context is current.  Buffers from an earlier epoch died with their
+// contexts.
+void Column_Buffers::release( GLuint buffer, int epoch)
+{
+  if( buffer == 0 || epoch != epoch_) return;
+  for( unsigned int i=0; i<entries_.size(); i++) {
+    if( entries_[i].name != buffer) continue;
+    if( --entries_[i].refs <= 0) {
+      pending_deletes_.push_back( buffer);
+      entries_.erase( entries_.begin() + i);
+    }
+    return;
+  }
+}
+
+//***************************************************************************
+// Column_Buffers::flush_deletes() -- STATIC method to delete buffers that
+// are no longer used and recycle their names.
+void Column_Buffers::flush_deletes()
+{
+  if( pending_deletes_.empty()) return;
+  glDeleteBuffers( pending_deletes_.size(), &(pending_deletes_[0]));
+  free_names_.insert(
+    free_names_.end(), pending_deletes_.begin(), pending_deletes_.end());
+  pending_deletes_.clear();
+}
+
+//***************************************************************************
+// Column_Buffers::data_changed() -- STATIC method to note that the columns
+// have changed, so buffers acquired later don't match older ones.
+void Column_Buffers::data_changed()
+{
+  data_generation_++;
+}
+
+//***************************************************************************
+// Column_Buffers::reset() -- STATIC method to forget every buffer and the
+// shader, because every plot window, and so every context, was destroyed.
+void Column_Buffers::reset()
+{
+  entries_.clear();
+  free_names_.clear();
+  pending_deletes_.clear();
+  next_name_ = MAXPLOTS + 1;
+  brush_npoints_ = -1;
+  brush_generation_ = -1;
+  program_ = 0;
+  program_failed_ = 0;
+  bound_ = 0;
+  data_generation_++;
+  epoch_++;
+  reset_ring( brush_ring_);
+}
+
+//***************************************************************************
+// Column_Buffers::compile( type, source) -- STATIC method to compile one
+// shader.  Returns 0 and reports the log if it fails.
+GLuint Column_Buffers::compile( GLenum type, const char *source)
+{
+  GLuint shader = glCreateShader( type);
+  glShaderSource( shader, 1, &source, NULL);
+  glCompileShader( shader);
+  GLint ok = 0;
+  glGetShaderiv( shader, GL_COMPILE_STATUS, &ok);
+  if( !ok) {
+    char log[ 1024];
+    glGetShaderInfoLog( shader, sizeof( log), NULL, log);
+    cerr << "Column_Buffers::compile: " << log << endl;
+    glDeleteShader( shader);
+    return 0;
+  }
+  return shader;
+}
+
+//***************************************************************************
+// Column_Buffers::available() -- STATIC method to make the shader the first
+// time it is needed.  Returns 0 if it can't be made, in which case plots
+// draw from their own interleaved VBOs.
+int Column_Buffers::available()
+{
+  if( program_ != 0) return 1;
+  if( program_failed_) return 0;
+  program_failed_ = 1;
+
+  // Shaders need OpenGL 2.0
+  const char *version = (const char *) glGetString( GL_VERSION);
+  if( version == NULL || atof( version) < 2.0) return 0;
+
+  // Both shaders see the same definitions
+  ostringstream defines;
+  defines << "#define VP_NBRUSHES " << NBRUSHES << "\n"
+          << "#define VP_ATLAS_COLUMNS " << Symbol_Atlas::columns << ".0\n"
+          << "#define VP_ATLAS_INSET " << 0.5/Symbol_Atlas::cell << "\n";
+#ifdef ALPHA_TEXTURE
+  defines << "#define VP_ALPHA_TEXTURE 1\n";
+#endif // ALPHA_TEXTURE
+  GLuint vertex_shader =
+    compile( GL_VERTEX_SHADER, ( defines.str() + vertex_shader_source).c_str());
+  if( vertex_shader == 0) return 0;
+  GLuint fragment_shader =
+    compile(
+      GL_FRAGMENT_SHADER, ( defines.str() + fragment_shader_source).c_str());
+  if( fragment_shader == 0) {
+    glDeleteShader( vertex_shader);
+    return 0;
+  }
+  GLuint program = glCreateProgram();
+  glAttachShader( program, vertex_shader);
+  glAttachShader( program, fragment_shader);
+  glBindAttribLocation( program, 0, "vp_x");
+  glBindAttribLocation( program, 1, "vp_y");
+  glBindAttribLocation( program, 2, "vp_z");
+  glBindAttribLocation( program, 3, "vp_brush");
+  glLinkProgram( program);
+  glDeleteShader( vertex_shader);
+  glDeleteShader( fragment_shader);
+  GLint ok = 0;
+  glGetProgramiv( program, GL_LINK_STATUS, &ok);
+  if( !ok) {
+    char log[ 1024];
+    glGetProgramInfoLog( program, sizeof( log), NULL, log);
+    cerr << "Column_Buffers::available: " << log << endl;
+    glDeleteProgram( program);
+    return 0;
+  }
+  program_ = program;
+  program_failed_ = 0;
+  function_location_ = glGetUniformLocation( program, "vp_function");
+  mix_location_ = glGetUniformLocation( program, "vp_sum_vs_difference");
+  use_brushes_location_ = glGetUniformLocation( program, "vp_use_brushes");
+  brush_depth_location_ = glGetUniformLocation( program, "vp_brush_depth");
+  brush_color_location_ = glGetUniformLocation( program, "vp_brush_color");
+  brush_size_location_ = glGetUniformLocation( program, "vp_brush_size");
+  symbol_location_ = glGetUniformLocation( program, "vp_symbol");
+  brush_symbol_location_ = glGetUniformLocation( program, "vp_brush_symbol");
+  atlas_location_ = glGetUniformLocation( program, "vp_atlas");
+  return 1;
+}
+
+//***************************************************************************
+// Column_Buffers::bind( buffers, functions, mix) -- STATIC method to draw
+// vertices from the x, y, and z buffers, with functions applied to each
+// axis and x and y mixed to sum-vs-difference if mix is set, until unbind()
+// is called.  The conventional vertex array is disabled, since some
+// drivers alias it with attribute 0.  Returns 0 if buffers can't be drawn.
+int Column_Buffers::bind(
+  const GLuint buffers[3], const int functions[3], int mix)
+{
+  if( !available()) return 0;
+  for( int axis=0; axis<3; axis++) if( buffers[axis] == 0) return 0;
+  glUseProgram( program_);
+  glUniform3i( function_location_, functions[0], functions[1], functions[2]);
+  glUniform1i( mix_location_, mix);
+  glUniform1i( use_brushes_location_, 0);
+  glUniform1i( symbol_location_, 0);
+  glUniform1i( atlas_location_, 0);
+  glDisableClientState( GL_VERTEX_ARRAY);
+  for( int axis=0; axis<3; axis++) {
+    glBindBuffer( GL_ARRAY_BUFFER, buffers[axis]);
+    glEnableVertexAttribArray( axis);
+    glVertexAttribPointer( axis, 1, GL_FLOAT, GL_FALSE, 0, (GLvoid *) NULL);
+  }
+  glBindBuffer( GL_ARRAY_BUFFER, 0);
+  bound_ = 1;
+  return 1;
+}
+
+//***************************************************************************
+// Column_Buffers::update_brush_ids() -- STATIC method to bring the buffers
+// of each point's brush up to date with the last gather, and bind the one
+// to draw from.  If the previous gather is already there, only the span of
+// points that changed brush is marked, otherwise all of them are.
+void Column_Buffers::update_brush_ids()
+{
+  const blitz::Array<int,1> &selection = Plot_Window::gathered_selection;
+  int n = selection.rows();
+  int generation = Plot_Window::selection_generation;
+  if( brush_npoints_ == n && brush_generation_ == generation) {
+    glBindBuffer( GL_ARRAY_BUFFER, ring_buffer( brush_ring_));
+    return;
+  }
+
+  if( brush_npoints_ == n && brush_generation_ == generation-1 &&
+      Plot_Window::selection_delta_valid) {
+    if( !Plot_Window::changed_points.empty())
+      mark_ring(
+        brush_ring_, Plot_Window::changed_points.front(),
+        Plot_Window::changed_points.back() + 1);
+  }
+  else mark_ring( brush_ring_, 0, n);
+
+  int begin, end;
+  advance_ring( brush_ring_, GL_ARRAY_BUFFER, n, sizeof(GLubyte), begin, end);
+  std::vector<GLubyte> block( min( max( end-begin, 1), (int) upload_block));
+  for( int first=begin; first<end; first+=upload_block) {
+    int m = min( end-first, (int) upload_block);
+    for( int j=0; j<m; j++) block[j] = (GLubyte) selection( first+j);
+    upload(
+      GL_ARRAY_BUFFER, (GLintptr) first*sizeof(GLubyte),
+      (GLsizeiptr) m*sizeof(GLubyte), &(block[0]));
+  }
+  brush_npoints_ = n;
+  brush_generation_ = generation;
+}
+
+//***************************************************************************
+// Column_Buffers::use_brushes( colors, sizes, symbols, depth) -- STATIC
+// method to color, size, and choose the symbol of the points drawn from the
+// buffers bound by bind() by their brush, from tables of NBRUSHES entries.
+// Brushes of size 0 are not drawn.  If depth is set, each brush is drawn at
+// its own depth, higher brushes nearer.  Returns 0 if there is no gathered
+// selection for these points.
+int Column_Buffers::use_brushes(
+  const GLfloat colors[][4], const GLfloat sizes[], const GLint symbols[],
+  int depth)
+{
+  if( program_ == 0 || Plot_Window::gathered_selection.rows() <= 0) return 0;
+  update_brush_ids();
+  glEnableVertexAttribArray( 3);
+  glVertexAttribPointer(
+    3, 1, GL_UNSIGNED_BYTE, GL_FALSE, 0, (GLvoid *) NULL);
+  glBindBuffer( GL_ARRAY_BUFFER, 0);
+  glUniform4fv( brush_color_location_, NBRUSHES, &(colors[0][0]));
+  glUniform1fv( brush_size_location_, NBRUSHES, sizes);
+  glUniform1iv( brush_symbol_location_, NBRUSHES, symbols);
+  glUniform1i( brush_depth_location_, depth);
+  glUniform1i( use_brushes_location_, 1);
+  glEnable( GL_VERTEX_PROGRAM_POINT_SIZE);
+  return 1;
+}
+
+//***************************************************************************
+// Column_Buffers::use_symbol( symbol) -- STATIC method to draw points with
+// a symbol from the atlas, which the caller binds to texture unit 0.
+// Returns 0 if the buffers aren't bound, so the shader isn't drawing.
+int Column_Buffers::use_symbol( int symbol)
+{
+  if( !bound_) return 0;
+  glUniform1i( symbol_location_, symbol);
+  return 1;
+}
+
+//***************************************************************************
+// Column_Buffers::unbind() -- STATIC method to go back to fixed function
+// drawing from the conventional vertex array.
+void Column_Buffers::unbind()
+{
+  for( int i=0; i<4; i++) glDisableVertexAttribArray( i);
+  glDisable( GL_VERTEX_PROGRAM_POINT_SIZE);
+  glUseProgram( 0);
+  bound_ = 0;
+  glEnableClientState( GL_VERTEX_ARRAY);
+}
+
+//***************************************************************************
+// Column_Buffers::reset_ring( ring) -- STATIC method to mark every buffer of
+// a ring out of date, so each is filled from scratch.  A ring left from an
+// earlier set of contexts forgets its buffers, which went with them.
+void Column_Buffers::reset_ring( Ring &ring)
+{
+  for( int k=0; k<stream_ring; k++) {
+    if( ring.epoch != epoch_) {
+      ring.names[k] = 0;
+      ring.fences[k] = 0;
+    }
+    ring.sizes[k] = 0;
+    ring.begin[k] = ring.end[k] = 0;
+  }
+  ring.current = 0;
+  ring.epoch = epoch_;
+}
+
+//***************************************************************************
+// Column_Buffers::mark_ring( ring, begin, end) -- STATIC method to note
+// that elements [begin,end) changed, so every buffer of the ring must copy
+// them the next time it is filled.
+void Column_Buffers::mark_ring( Ring &ring, int begin, int end)
+{
+  if( begin >= end) return;
+  for( int k=0; k<stream_ring; k++) {
+    if( ring.begin[k] >= ring.end[k]) {
+      ring.begin[k] = begin;
+      ring.end[k] = end;
+    }
+    else {
+      ring.begin[k] = min( ring.begin[k], begin);
+      ring.end[k] = max( ring.end[k], end);
+    }
+  }
+}
+
+//***************************************************************************
+// Column_Buffers::advance_ring( ring, target, n, element_size, begin, end)
+// -- STATIC method to bind the buffer of a ring of n elements that should
+// be drawn from next, and set [begin,end) to the elements the caller must
+// upload into it.  If nothing changed, the current buffer is kept.
+// Otherwise the next one is filled.  If its fence shows the GPU is still
+// drawing from it, or it is the wrong size, it is orphaned and all of it
+// must be uploaded.  Returns the buffer's name.
+GLuint Column_Buffers::advance_ring(
+  Ring &ring, GLenum target, int n, int element_size, int &begin, int &end)
+{
+  if( ring.epoch != epoch_) reset_ring( ring);
+  int k = ring.current;
+  if( ring.names[k] != 0 && ring.sizes[k] == n &&
+      ring.begin[k] >= ring.end[k]) {
+    glBindBuffer( target, ring.names[k]);
+    begin = end = 0;
+    return ring.names[k];
+  }
+
+  if( ring.names[k] != 0) k = ( k+1) % stream_ring;
+  if( ring.names[k] == 0) ring.names[k] = new_name();
+  glBindBuffer( target, ring.names[k]);
+
+  int busy = 0;
+  if( ring.fences[k] != 0) {
+    GLenum status = glClientWaitSync( ring.fences[k], 0, 0);
+    busy = status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED;
+    glDeleteSync( ring.fences[k]);
+    ring.fences[k] = 0;
+  }
+  if( busy || ring.sizes[k] != n) {
+    glBufferData(
+      target, (GLsizeiptr) n*element_size, (void *) NULL, GL_STREAM_DRAW);
+    if( busy && ring.sizes[k] == n) {
+      uploads_total_.orphans++;
+      uploads_frame_.orphans++;
+    }
+    ring.sizes[k] = n;
+    ring.begin[k] = 0;
+    ring.end[k] = n;
+  }
+  begin = ring.begin[k];
+  end = min( ring.end[k], n);
+  ring.begin[k] = ring.end[k] = 0;
+  ring.current = k;
+  return ring.names[k];
+}
+
+//***************************************************************************
+// Column_Buffers::ring_buffer( ring) -- STATIC method to get the buffer of
+// a ring that was filled last, or 0 if none was.
+GLuint Column_Buffers::ring_buffer( const Ring &ring)
+{
+  if( ring.epoch != epoch_) return 0;
+  return ring.names[ ring.current];
+}
+
+//***************************************************************************
+// Column_Buffers::fence_ring( ring) -- STATIC method to set a fence after
+// the commands that drew from the current buffer of a ring, replacing the
+// fence of any earlier draw.
+void Column_Buffers::fence_ring( Ring &ring)
+{
+  if( ring.epoch != epoch_) return;
+  int k = ring.current;
+  if( ring.names[k] == 0) return;
+  if( ring.fences[k] != 0) glDeleteSync( ring.fences[k]);
+  ring.fences[k] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+//***************************************************************************
+// Column_Buffers::fence_brush_ids() -- STATIC method to fence the buffer of
+// each point's brush after the commands that drew from it.
+void Column_Buffers::fence_brush_ids()
+{
+  fence_ring( brush_ring_);
+}
+
+//***************************************************************************
+// Column_Buffers::upload( target, offset, size, data) -- STATIC method to
+// copy size bytes of data into the buffer bound to target, starting at
+// offset, and count the bytes and the time the copy takes.  Buffers
+// streamed through a ring aren't waited for, so the time is that of the
+// copy itself, unless a buffer outside a ring is still being drawn from.
+void Column_Buffers::upload(
+  GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data)
+{
+  double start = Point_Sampler::now();
+  glBufferSubData( target, offset, size, data);
+  double seconds = Point_Sampler::now() - start;
+  uploads_total_.seconds += seconds;
+  uploads_total_.bytes += size;
+  uploads_total_.calls++;
+  uploads_frame_.seconds += seconds;
+  uploads_frame_.bytes += size;
+  uploads_frame_.calls++;
+}
+
+//***************************************************************************
+// Column_Buffers::upload_counts( frame) -- STATIC method to get the uploads
+// since the program started, or if frame is set, since the last report.
+const Column_Buffers::Upload_Counts &Column_Buffers::upload_counts( int frame)
+{
+  if( frame) return uploads_frame_;
+  return uploads_total_;
+}
+
+//***************************************************************************
+// Column_Buffers::report_uploads() -- STATIC method to report the uploads
+// since the last report, if verbose, and reset the counts for the frame.
+// The totals are kept.
+void Column_Buffers::report_uploads()
+{
+  if( uploads_frame_.calls == 0 && uploads_frame_.orphans == 0) return;
+  if( be_verbose)
+    cout << "Column_Buffers: uploaded " << uploads_frame_.bytes/1024.0
+         << " KB in " << uploads_frame_.calls << " copies, "
+         << 1000.0*uploads_frame_.seconds << " ms, "
+         << uploads_frame_.orphans << " busy buffers orphaned ("
+         << uploads_total_.bytes/(1024.0*1024.0) << " MB in all)" << endl;
+  uploads_frame_.bytes = 0;
+  uploads_frame_.seconds = 0;
+  uploads_frame_.calls = 0;
+  uploads_frame_.orphans = 0;
+}
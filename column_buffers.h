@@ -0,0 +1,231 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: column_buffers.h
+//
+// Class definitions:
+//   Column_Buffers -- GPU buffers of plotted columns, shared between plots
+//
+// Classes referenced:
+//   Plot_Window -- Supplies the columns and draws from the buffers
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//   Requires OpenGL 2.0 for vertex shaders, else plots fall back to
+//   their own interleaved VBOs
+//
+// Purpose: Keep one copy on the GPU of each column as it is plotted, so
+//   that GPU memory grows with the number of distinct columns shown rather
+//   than with the number of plots.  Plots drawn this way keep no vertices
+//   on the host either: selection, histograms, and the other work done on
+//   the CPU read the same columns through a Vertex_Source.
+//
+// General design philosophy:
+//   1) Each axis of a plot is a separate buffer of one float per point.
+//      A buffer is identified by the column, its normalization, and its
+//      offset, so every plot that shows the same column the same way
+//      binds the same buffer.  Axes that only make sense for one plot,
+//      such as transformed or shuffled ones, get a buffer of their own.
+//   2) Buffers are reference counted and deleted when no plot uses them.
+//      FLTK shares objects between the contexts of all GL windows, so
+//      a buffer made while drawing one plot can be used by the others.
+//   3) A small vertex shader assembles each vertex from the three
+//      streams.  A fragment shader draws point symbols from the
+//      Symbol_Atlas.  Blending and the stencil are still fixed function.
+//   4) Normalizations that are functions of one value, log10 and squash,
+//      and the sum-vs-difference transform are applied by the shader to
+//      the raw column, so changing them uploads nothing.  Normalizations
+//      that depend on the whole column, such as rank, are computed once
+//      on the CPU and shared like any other column.
+//   5) One more shared buffer holds the brush of each point as a byte.
+//      It is updated from the selection delta, and lets the shader pick
+//      each point's color, size, and symbol from a table, so a plot can
+//      draw all of its brushes in one call.
+//   6) Buffers that change as the user brushes, the brush of each point
+//      and the indices of each brush, are streamed through a Ring of
+//      stream_ring buffers.  Each update goes into the next buffer, which
+//      the GPU has usually finished drawing from.  A fence set after each
+//      plot draws from it tells for sure, since the GPU runs the commands
+//      of the plots' contexts in the order they were given.  If the GPU is done with it, only
+//      the span that changed since it was last filled is copied.  If not,
+//      it is orphaned and filled again rather than waited for.
+//   7) Every copy into a buffer goes through upload(), which counts the
+//      bytes, the copies, and the time spent in them, and each orphaned
+//      busy buffer.  The counts are kept per frame and in total, and can
+//      be read with upload_counts().  With the verbose flag set, each
+//      frame's counts are reported.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef COLUMN_BUFFERS_H
+#define COLUMN_BUFFERS_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Column_Buffers
+//
+// Class definitions:
+//   Column_Buffers -- GPU buffers of plotted columns, shared between plots
+//
+// Classes referenced:
+//   Plot_Window -- Supplies the gathered selection
+//
+// Purpose: Static cache of reference counted buffers, and the shader that
+//   draws from them.
+//
+// Functions:
+//   shared_key( column, style, offset) -- Key of a column anyone can use
+//   private_key( owner, axis) -- Key of an axis only one plot can use
+//   find( key, n) -- Use a buffer if one has been uploaded
+//   acquire( key, *data, stride, n) -- Find or upload a buffer
+//   release( buffer, epoch) -- Stop using a buffer
+//   epoch() -- Current set of GL contexts
+//   data_changed() -- Columns have changed, so no buffer matches them
+//   reset() -- Forget every buffer because all GL contexts were destroyed
+//   available() -- Can buffers be drawn in the current context?
+//   bind( buffers, functions, mix) -- Draw from three buffers
+//   use_brushes( colors, sizes, symbols, depth) -- Color, size, and choose
+//     symbols of points by brush
+//   use_symbol( symbol) -- Draw points with one symbol from the atlas
+//   update_brush_ids() -- Bring the buffer of brushes up to date
+//   reset_ring( ring) -- Mark every buffer of a ring out of date
+//   mark_ring( ring, begin, end) -- Elements of a ring that changed
+//   advance_ring( ring, target, n, element_size, begin, end) -- Bind the
+//     buffer of a ring to fill next, and the span of it to upload
+//   ring_buffer( ring) -- Buffer of a ring to draw from
+//   fence_ring( ring) -- Fence the buffer of a ring just drawn from
+//   fence_brush_ids() -- Fence the buffer of brushes just drawn from
+//   upload( target, offset, size, *data) -- Copy into a buffer, counting it
+//   upload_counts( frame) -- Uploads so far, or in this frame
+//   report_uploads() -- Report and reset this frame's upload counts
+//   unbind() -- Go back to fixed function vertex arrays
+//
+//   same_key( a, b) -- Do two keys describe the same buffer?
+//   new_name() -- Choose a name for a new buffer
+//   flush_deletes() -- Delete buffers nobody uses
+//   compile( type, *source) -- Compile one shader
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Column_Buffers
+{
+  public:
+    // What a buffer holds.  Shared columns have owner -1; a column of
+    // -1 is all zeros, for plots without a z-axis.
+    struct Key {
+      int column, style, offset;
+      int owner;
+      int generation;
+    };
+
+    // Points copied per upload call
+    static const int upload_block = 1 << 16;
+
+    // Functions the shader applies to each axis
+    enum Function {
+      FUNCTION_NONE = 0,
+      FUNCTION_LOG10,
+      FUNCTION_SQUASH
+    };
+
+    // A ring of buffers streamed into, the one drawn from, and for each
+    // buffer its size in elements, the span of elements that changed since
+    // it was filled, and the fence set when it was last drawn from.
+    // A ring of zeros is empty.
+    static const int stream_ring = 3;
+    struct Ring {
+      GLuint names[ stream_ring];
+      GLsync fences[ stream_ring];
+      int sizes[ stream_ring];
+      int begin[ stream_ring], end[ stream_ring];
+      int current;
+      int epoch;
+    };
+
+    // Bytes, copies, and seconds spent copying into buffers, and busy
+    // buffers that were orphaned rather than waited for
+    struct Upload_Counts {
+      double bytes, seconds;
+      int calls, orphans;
+    };
+
+  protected:
+    struct Entry {
+      Key key;
+      int npoints;
+      GLuint name;
+      int refs;
+    };
+    static std::vector<Entry> entries_;
+    static std::vector<GLuint> free_names_, pending_deletes_;
+    static GLuint next_name_;
+    static int data_generation_;
+    static int private_generation_;
+    static int epoch_;
+
+    // Buffers of each point's brush, and the gather they reflect
+    static Ring brush_ring_;
+    static int brush_npoints_, brush_generation_;
+
+    // Uploads since the program started, and since the last report
+    static Upload_Counts uploads_total_, uploads_frame_;
+
+    // Shader program, or 0 if it hasn't been made, whether making it
+    // failed, and the locations of its uniforms
+    static GLuint program_;
+    static int program_failed_;
+    static GLint function_location_, mix_location_;
+    static GLint use_brushes_location_, brush_depth_location_;
+    static GLint brush_color_location_, brush_size_location_;
+    static GLint symbol_location_, brush_symbol_location_, atlas_location_;
+
+    // Is the shader drawing from bound buffers?
+    static int bound_;
+
+    static int same_key( const Key &a, const Key &b);
+    static GLuint new_name();
+    static void flush_deletes();
+    static GLuint compile( GLenum type, const char *source);
+
+  public:
+    static Key shared_key( int column, int style, int offset);
+    static Key private_key( int owner, int axis);
+    static GLuint find( const Key &key, int n);
+    static GLuint acquire( const Key &key, const float *data, int stride, int n);
+    static void release( GLuint buffer, int epoch);
+    static int epoch() { return epoch_;}
+    static void data_changed();
+    static void reset();
+    static int available();
+    static int bind(
+      const GLuint buffers[3], const int functions[3], int mix);
+    static int use_brushes(
+      const GLfloat colors[][4], const GLfloat sizes[], const GLint symbols[],
+      int depth);
+    static int use_symbol( int symbol);
+    static void update_brush_ids();
+    static void unbind();
+    static void reset_ring( Ring &ring);
+    static void mark_ring( Ring &ring, int begin, int end);
+    static GLuint advance_ring(
+      Ring &ring, GLenum target, int n, int element_size,
+      int &begin, int &end);
+    static GLuint ring_buffer( const Ring &ring);
+    static void fence_ring( Ring &ring);
+    static void fence_brush_ids();
+    static void upload(
+      GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data);
+    static const Upload_Counts &upload_counts( int frame = 0);
+    static void report_uploads();
+};
+
+#endif   // COLUMN_BUFFERS_H
@@ -39,6 +39,7 @@ Column_Info::Column_Info() : jvar_( 0), label( ""), hasASCII( 0),
   isVector( 0), vectorLabel( ""), vectorIndex( 0), isRanked( 0)
 {
   ascii_values_.erase( ascii_values_.begin(), ascii_values_.end());
+  invalidate_ascii_lookup();
 }
 
 //***************************************************************************
@@ -49,6 +50,7 @@ Column_Info::Column_Info( string sColumnInfo) :
   jvar_( 0), label( ""), hasASCII( 0)
 {
   ascii_values_.erase( ascii_values_.begin(), ascii_values_.end());
+  invalidate_ascii_lookup();
   // Code to parse string has yet to be written
 }
 
@@ -74,6 +76,7 @@ void Column_Info::free()
   label = "";
   hasASCII = 0;
   ascii_values_.erase( ascii_values_.begin(), ascii_values_.end());
+  invalidate_ascii_lookup();
   
   isVector = 0;
   vectorLabel = "";
@@ -94,6 +97,7 @@ void Column_Info::copy( const Column_Info &inputInfo)
   if( ascii_values_.size() <= 0)
     ascii_values_.erase( ascii_values_.begin(), ascii_values_.end());
   ascii_values_ = inputInfo.ascii_values_;
+  invalidate_ascii_lookup();
   
   isVector = inputInfo.isVector;
   vectorLabel = inputInfo.vectorLabel;
@@ -132,6 +136,7 @@ int Column_Info::add_value( string sToken)
     return iter->second;
   }
   else {
+    invalidate_ascii_lookup();
     int nValues = ascii_values_.size();
     //ascii_values_.insert(
     //  ascii_values_.end(), 
@@ -149,6 +154,7 @@ int Column_Info::update_ascii_values_and_data()
 {
   // Make sure we have the right index and look-up table
   if( hasASCII == 0) return -1;
+  invalidate_ascii_lookup();
 
   // Loop: Create and load a map to do the conversion
   map<int,int> conversion;
@@ -183,6 +189,8 @@ Column_Info& Column_Info::add_info_and_update_data( Column_Info &old_info)
 {
   // If this is not an ASCII column then quit
   if( hasASCII == 0 || old_info.hasASCII == 0) return old_info;
+  invalidate_ascii_lookup();
+  old_info.invalidate_ascii_lookup();
   
   // Define a map to convert values
   map<int,int> conversion_table;
@@ -238,14 +246,193 @@ Column_Info& Column_Info::add_info_and_update_data( Column_Info &old_info)
 
 //***************************************************************************
 // Column_Info::ascii_value( iValue) -- Protect against bad indices, then
-// loop through map of ASCII values to get value for this index.  
+// use the lookup table to get the value for this index.  The lookup table
+// is rebuilt if ascii_values_ has been changed since it was last built.
 string Column_Info::ascii_value( int iValue)
 {
   if( 0>iValue || iValue >= ascii_values_.size()) return string( "BAD_INDEX_VP");
-  map<string,int>::iterator iter = ascii_values_.begin();
-  for( int i=0; i<iValue; i++) {
-    iter++;
-    if( iter == ascii_values_.end()) break;
+  if( !ascii_lookup_valid_ || ascii_lookup_.size() != ascii_values_.size())
+    build_ascii_lookup();
+  return ascii_lookup_[ iValue];
+}
+
+//***************************************************************************
+// Column_Info::invalidate_ascii_lookup() -- Discard the lookup table, the
+// trigram index, and the results of the last search.  Must be called 
+// whenever ascii_values_ changes.
+void Column_Info::invalidate_ascii_lookup()
+{
+  ascii_lookup_valid_ = 0;
+  ascii_lookup_.clear();
+  trigram_index_.clear();
+  last_query_ = "";
+  last_match_mode_ = -1;
+  last_matches_.clear();
+}
+
+//***************************************************************************
+// pack_trigram( s) -- Pack three characters into an unsigned int for use as
+// a key in the trigram index.
+static unsigned int pack_trigram( const char *s)
+{
+  return ( ((unsigned int) (unsigned char) s[0]) << 16) |
+         ( ((unsigned int) (unsigned char) s[1]) << 8) |
+         ( (unsigned int) (unsigned char) s[2]);
+}
+
+//***************************************************************************
+// Column_Info::build_ascii_lookup() -- Load a vector with the ASCII values 
+// in map (i.e., alphabetical) order, so ascii_value() is a simple lookup 
+// and prefix and exact searches can use binary search.  For columns with 
+// many distinct values, also build a trigram index that maps each three-
+// character sequence to a sorted list of the values that contain it.
+void Column_Info::build_ascii_lookup()
+{
+  invalidate_ascii_lookup();
+  ascii_lookup_.reserve( ascii_values_.size());
+  for(
+    map<string,int>::iterator iter = ascii_values_.begin();
+    iter != ascii_values_.end(); iter++)
+    ascii_lookup_.push_back( iter->first);
+
+  // Loop: Build posting lists.  Values are visited in increasing order, so
+  // each list is sorted and only its last entry need be checked for 
+  // duplicates.
+  int nValues = ascii_lookup_.size();
+  if( nValues >= trigram_threshold) {
+    for( int k=0; k<nValues; k++) {
+      const string &sValue = ascii_lookup_[k];
+      for( unsigned int i=0; i+3<=sValue.size(); i++) {
+        vector<int> &posting = trigram_index_[ pack_trigram( sValue.c_str()+i)];
+        if( posting.empty() || posting.back() != k) posting.push_back( k);
+      }
+    }
+  }
+  ascii_lookup_valid_ = 1;
+}
+
+//***************************************************************************
+// Column_Info::trigram_candidates( str, candidates) -- Use the trigram 
+// index to generate a sorted list of values that contain every trigram in 
+// str.  Every value containing str is a candidate, but not every candidate 
+// contains str.  Returns 0 if the index can't help (no index or str is too
+// short), in which case candidates is left empty and all values must be
+// examined.
+int Column_Info::trigram_candidates( const char *str, vector<int> &candidates)
+{
+  candidates.clear();
+  int nChars = strlen( str);
+  if( trigram_index_.empty() || nChars < 3) return 0;
+
+  // Loop: Gather the posting list for each trigram.  If any trigram is 
+  // missing, nothing can match.
+  vector<const vector<int>*> postings;
+  for( int i=0; i+3<=nChars; i++) {
+    map<unsigned int, vector<int> >::iterator iter = 
+      trigram_index_.find( pack_trigram( str+i));
+    if( iter == trigram_index_.end()) return 1;
+    postings.push_back( &(iter->second));
   }
-  return iter->first;
+
+  // Intersect the lists, starting with the shortest to keep the working 
+  // set small
+  int iShortest = 0;
+  for( unsigned int j=1; j<postings.size(); j++)
+    if( postings[j]->size() < postings[iShortest]->size()) iShortest = j;
+  candidates = *postings[iShortest];
+  vector<int> scratch;
+  for( unsigned int j=0; j<postings.size() && !candidates.empty(); j++) {
+    if( (int) j == iShortest) continue;
+    scratch.clear();
+    set_intersection(
+      candidates.begin(), candidates.end(),
+      postings[j]->begin(), postings[j]->end(),
+      back_inserter( scratch));
+    candidates.swap( scratch);
+  }
+  return 1;
+}
+
+//***************************************************************************
+// Column_Info::match_ascii_values( str, match_mode, matches) -- Flag the 
+// ASCII values that match str using the given match mode.  On return 
+// matches has one entry per value, indexed in the same way as 
+// ascii_value(), so callers can classify every point with a single table
+// lookup.  Returns the number of matching values, or -1 if str is not a 
+// valid regular expression.
+int Column_Info::match_ascii_values( 
+  const char *str, int match_mode, vector<char> &matches)
+{
+  if( !ascii_lookup_valid_ || ascii_lookup_.size() != ascii_values_.size())
+    build_ascii_lookup();
+  int nValues = ascii_lookup_.size();
+  matches.assign( nValues, 0);
+  if( str == NULL) return 0;
+  string sQuery( str);
+  vector<int> hits;
+
+  #ifdef __WIN32__
+    // No POSIX regular expressions here, so do a substring search instead
+    if( match_mode == MATCH_REGEX) match_mode = MATCH_SUBSTRING;
+  #endif // __WIN32__
+
+  // Prefix and exact matches: the lookup table is sorted, so use binary 
+  // search to find the first value that could match
+  if( match_mode == MATCH_PREFIX || match_mode == MATCH_EXACT) {
+    vector<string>::iterator iter = 
+      lower_bound( ascii_lookup_.begin(), ascii_lookup_.end(), sQuery);
+    if( match_mode == MATCH_EXACT) {
+      if( iter != ascii_lookup_.end() && *iter == sQuery)
+        hits.push_back( iter - ascii_lookup_.begin());
+    }
+    else {
+      for( ; iter != ascii_lookup_.end() && 
+             iter->compare( 0, sQuery.size(), sQuery) == 0; iter++)
+        hits.push_back( iter - ascii_lookup_.begin());
+    }
+  }
+
+  // Regular expressions: compile once and test each distinct value
+  #ifndef __WIN32__
+  else if( match_mode == MATCH_REGEX) {
+    regex_t re;
+    if( regcomp( &re, str, REG_EXTENDED | REG_NOSUB) != 0) return -1;
+    for( int k=0; k<nValues; k++)
+      if( regexec( &re, ascii_lookup_[k].c_str(), 0, NULL, 0) == 0)
+        hits.push_back( k);
+    regfree( &re);
+  }
+  #endif // __WIN32__
+
+  // Substrings: if this query extends the previous one, only values that 
+  // matched last time can match now.  Otherwise use the trigram index, if
+  // available, to prune candidates.  Candidates must still be verified.
+  else {
+    vector<int> candidates;
+    int bHaveCandidates = 0;
+    if( last_match_mode_ == MATCH_SUBSTRING && !last_query_.empty() &&
+        sQuery.find( last_query_) != string::npos) {
+      candidates = last_matches_;
+      bHaveCandidates = 1;
+    }
+    else bHaveCandidates = trigram_candidates( str, candidates);
+
+    if( bHaveCandidates) {
+      for( unsigned int j=0; j<candidates.size(); j++)
+        if( ascii_lookup_[ candidates[j]].find( sQuery) != string::npos)
+          hits.push_back( candidates[j]);
+    }
+    else {
+      for( int k=0; k<nValues; k++)
+        if( ascii_lookup_[k].find( sQuery) != string::npos) hits.push_back( k);
+    }
+    match_mode = MATCH_SUBSTRING;
+  }
+
+  // Flag matches and save this search for next time
+  for( unsigned int j=0; j<hits.size(); j++) matches[ hits[j]] = 1;
+  last_query_ = sQuery;
+  last_match_mode_ = match_mode;
+  last_matches_.swap( hits);
+  return last_matches_.size();
 }
@@ -67,6 +67,11 @@
 //   index() -- Get column index for this column
 //   index( j) -- Set column index for this column
 //   ascii_value( j) -- Get ASCII value for point j
+//   match_ascii_values( str, match_mode, matches) -- Flag matching values
+//
+//   invalidate_ascii_lookup() -- Discard lookup table and trigram index
+//   build_ascii_lookup() -- Build lookup table and trigram index
+//   trigram_candidates( str, candidates) -- Candidates from trigram index
 //
 // Author: Creon Levit    2005-2006
 // Modified: P. R. Gazis  27-SEP-2008
@@ -76,6 +81,24 @@ class Column_Info
   protected:
     int jvar_;
 
+    // Lookup table to convert ASCII value indices to strings in constant
+    // time, and a trigram index over the same strings to prune candidates
+    // when searching columns with many distinct values.  Both are built on 
+    // demand and discarded whenever ascii_values_ changes.
+    int ascii_lookup_valid_;
+    std::vector<std::string> ascii_lookup_;
+    std::map<unsigned int, std::vector<int> > trigram_index_;
+    void invalidate_ascii_lookup();
+    void build_ascii_lookup();
+    int trigram_candidates( const char *str, std::vector<int> &candidates);
+
+    // Results of the most recent search, so a query that extends the 
+    // previous one (as happens when the user types) only has to re-examine 
+    // values that matched last time.
+    std::string last_query_;
+    int last_match_mode_;
+    std::vector<int> last_matches_;
+
   public:
     Column_Info();
     Column_Info( string sColumnInfo);
@@ -97,6 +120,19 @@ class Column_Info
     void index( int j) { jvar_ = j;}
     string ascii_value( int j);
 
+    // Match modes for string searches on ASCII columns
+    enum match_modes {
+      MATCH_SUBSTRING = 0,
+      MATCH_PREFIX,
+      MATCH_EXACT,
+      MATCH_REGEX
+    };
+    int match_ascii_values( 
+      const char *str, int match_mode, std::vector<char> &matches);
+
+    // Minimum number of distinct values for which a trigram index is built
+    static const int trigram_threshold = 4096;
+
     // Define buffers to hold label and ASCII values    
     string label;
     int hasASCII;
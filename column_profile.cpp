@@ -0,0 +1,478 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: column_profile.cpp
+//
+// Class definitions:
+//   Column_Profile -- Live marginal and per-brush histograms of all columns
+//   Column_Profile_View -- Widget to draw the histograms as small multiples
+//
+// Classes referenced:
+//   Plot_Window -- Source of selection deltas
+//   Worker_Pool -- Runs the binning passes
+//   Brush -- Colors for per-brush histograms
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    Blitz++ 0.9 -- Various math routines
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <column_profile.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "column_profile.h"
+#include "data_file_manager.h"
+#include "plot_window.h"
+#include "column_info.h"
+#include "brush.h"
+#include "worker_pool.h"
+
+// Seconds between redraws of the window
+const double Column_Profile::poll_interval = 0.05;
+
+//***************************************************************************
+// Column_Profile_View::Column_Profile_View( x, y, w, h, *profile) --
+// Constructor
+Column_Profile_View::Column_Profile_View(
+  int x, int y, int w, int h, Column_Profile *profile) :
+  Fl_Widget( x, y, w, h), profile_( profile)
+{}
+
+//***************************************************************************
+// Column_Profile_View::draw() -- Draw a grid of cells, one per column,
+// shaped to fill the widget.
+void Column_Profile_View::draw()
+{
+  fl_push_clip( x(), y(), w(), h());
+  fl_color( FL_BLACK);
+  fl_rectf( x(), y(), w(), h());
+  fl_font( FL_HELVETICA, 10);
+
+  int ncolumns = profile_->ncolumns();
+  if( !profile_->has_counts()) {
+    fl_color( FL_WHITE);
+    fl_draw( "Computing profiles...", x()+10, y()+20);
+    fl_pop_clip();
+    return;
+  }
+
+  // Choose a grid with roughly square cells
+  int ngrid_x = (int) ceil( sqrt( (double) ncolumns * w() / h()));
+  if( ngrid_x < 1) ngrid_x = 1;
+  if( ngrid_x > ncolumns) ngrid_x = ncolumns;
+  int ngrid_y = ( ncolumns + ngrid_x - 1) / ngrid_x;
+  int cell_w = w() / ngrid_x, cell_h = h() / ngrid_y;
+  int nbins = Column_Profile::nbins;
+  std::vector<double> heights( nbins);
+
+  for( int k=0; k<ncolumns; k++) {
+    int cx = x() + (k % ngrid_x) * cell_w + 4;
+    int cy = y() + (k / ngrid_x) * cell_h + 2;
+    int cw = cell_w - 8, ch = cell_h - 16;
+    if( cw < 4 || ch < 4) continue;
+    fl_color( FL_WHITE);
+    fl_draw(
+      Data_File_Manager::column_info[k].label.c_str(), cx, cy, cw, 12,
+      FL_ALIGN_LEFT | FL_ALIGN_CLIP);
+    int base = cy + 12 + ch;
+    float bin_w = (float) cw / nbins;
+
+    // Marginal, as gray bars
+    double peak = 0.0;
+    for( int bin=0; bin<nbins; bin++) {
+      heights[bin] = 0.0;
+      for( int b=0; b<NBRUSHES; b++) heights[bin] += profile_->count( b, k, bin);
+      if( heights[bin] > peak) peak = heights[bin];
+    }
+    if( peak <= 0.0) continue;
+    fl_color( fl_rgb_color( 96, 96, 96));
+    for( int bin=0; bin<nbins; bin++) {
+      int bar = (int) ( ch * heights[bin] / peak + 0.5);
+      int x0 = cx + (int) ( bin*bin_w), x1 = cx + (int) ( (bin+1)*bin_w);
+      if( bar > 0) fl_rectf( x0, base-bar, x1-x0 > 1 ? x1-x0 : 1, bar);
+    }
+
+    // Each brush with points, as a line in its color
+    for( int b=1; b<NBRUSHES; b++) {
+      if( brushes[b] == NULL || brushes[b]->count == 0) continue;
+      double brush_peak = 0.0;
+      for( int bin=0; bin<nbins; bin++)
+        if( profile_->count( b, k, bin) > brush_peak)
+          brush_peak = profile_->count( b, k, bin);
+      if( brush_peak <= 0.0) continue;
+      fl_color( fl_rgb_color(
+        (uchar) ( 255 * brushes[b]->color_chooser->r()),
+        (uchar) ( 255 * brushes[b]->color_chooser->g()),
+        (uchar) ( 255 * brushes[b]->color_chooser->b())));
+      fl_begin_line();
+      for( int bin=0; bin<nbins; bin++) {
+        float top = base - ch * profile_->count( b, k, bin) / brush_peak;
+        fl_vertex( cx + bin*bin_w, top);
+        fl_vertex( cx + (bin+1)*bin_w, top);
+      }
+      fl_end_line();
+    }
+  }
+  fl_pop_clip();
+}
+
+//***************************************************************************
+// Column_Profile::Column_Profile() -- Constructor
+Column_Profile::Column_Profile() :
+  ncolumns_( 0), ranges_valid_( 0), counts_valid_( 0),
+  job_( NULL), job_done_( 0), cancel_( 0), job_pending_( 0),
+  window_( NULL), view_( NULL), display_dirty_( 0)
+{
+  pthread_mutex_init( &mutex_, NULL);
+  pthread_cond_init( &cond_, NULL);
+}
+
+//***************************************************************************
+// Column_Profile::~Column_Profile() -- Destructor
+Column_Profile::~Column_Profile()
+{
+  cancel_job();
+  Fl::remove_timeout( timeout_cb, (void*) this);
+  pthread_cond_destroy( &cond_);
+  pthread_mutex_destroy( &mutex_);
+}
+
+//***************************************************************************
+// Column_Profile::apply_point( i, brush, sign) -- Add (sign=1) or remove
+// (sign=-1) point i from the counts of a brush in every column.
+void Column_Profile::apply_point( int i, int brush, double sign)
+{
+  if( brush < 0 || brush >= NBRUSHES) return;
+  double *counts = &(counts_[ brush*ncolumns_*nbins]);
+  for( int k=0; k<ncolumns_; k++)
+    counts[ k*nbins + bin_of( k, Data_File_Manager::column_info[k].points(i))]
+      += sign;
+}
+
+//***************************************************************************
+// Column_Profile::update_from_selection_delta() -- Called by
+// Plot_Window::color_array_from_selection after every gather.  If the
+// counts are valid, the gather recorded which points changed, and moving
+// them fits the budget, do so.  Otherwise leave it to the background job.
+void Column_Profile::update_from_selection_delta()
+{
+  if( window_ == NULL || !window_->shown()) {
+    counts_valid_ = 0;
+    return;
+  }
+
+  int nchanged = Plot_Window::changed_points.size();
+  if( counts_valid_ && Plot_Window::selection_delta_valid &&
+      (long) nchanged * ncolumns_ <= delta_budget) {
+    for( int j=0; j<nchanged; j++) {
+      int i = Plot_Window::changed_points[j];
+      apply_point( i, Plot_Window::changed_from[j], -1.0);
+      apply_point( i, Plot_Window::gathered_selection(i), 1.0);
+    }
+  }
+  else {
+    // A running job will catch up with the selection when it finishes
+    counts_valid_ = 0;
+    if( job_ == NULL) job_pending_ = 1;
+  }
+  display_dirty_ = 1;
+}
+
+//***************************************************************************
+// Column_Profile::data_changed() -- The data or columns have changed, so
+// stop any background job before it reads them and discard all results.
+void Column_Profile::data_changed()
+{
+  cancel_job();
+  counts_valid_ = 0;
+  ranges_valid_ = 0;
+  ncolumns_ = 0;
+  counts_.clear();
+  job_pending_ = 1;
+  display_dirty_ = 1;
+}
+
+//***************************************************************************
+// Column_Profile::submit_job() -- Snapshot the selection and start a
+// background rebuild of the counts, and of the column ranges if needed.
+void Column_Profile::submit_job()
+{
+  if( job_ != NULL || worker_pool == NULL || nvars <= 0 || npoints <= 0)
+    return;
+
+  Job *job = new Job;
+  job->owner = this;
+  job->ncolumns = nvars;
+  job->generation = Plot_Window::selection_generation;
+  job->need_ranges = !ranges_valid_ || ncolumns_ != nvars;
+  if( !job->need_ranges) {
+    job->min = min_;
+    job->max = max_;
+    job->scale = scale_;
+  }
+
+  // Column data are handed to the job as raw pointers because the
+  // reference counts of blitz arrays are not thread safe
+  for( int k=0; k<nvars; k++)
+    job->points.push_back( Data_File_Manager::column_info[k].points.data());
+
+  // Ranges of ranked columns are read from their ranks here, since the
+  // main thread may rank columns again while the job runs
+  if( job->need_ranges) {
+    job->min.assign( nvars, 0.0);
+    job->max.assign( nvars, 0.0);
+    job->ranked.assign( nvars, 0);
+    for( int k=0; k<nvars; k++) {
+      Column_Info &info = Data_File_Manager::column_info[k];
+      if( !info.isRanked) continue;
+      const int *ranks = info.ranked_points.data();
+      job->min[k] = job->points[k][ ranks[0]];
+      job->max[k] = job->points[k][ ranks[ npoints-1]];
+      job->ranked[k] = 1;
+    }
+  }
+
+  // Take the snapshot from the last gather if possible, since that is the
+  // state later deltas will be applied to
+  job->snapshot.resize( npoints);
+  if( Plot_Window::gathered_selection.rows() == npoints) {
+    for( int i=0; i<npoints; i++)
+      job->snapshot[i] = (unsigned char) Plot_Window::gathered_selection(i);
+  }
+  else {
+    for( int i=0; i<npoints; i++)
+      job->snapshot[i] = (unsigned char) selected(i);
+  }
+
+  job_ = job;
+  job_done_ = 0;
+  cancel_ = 0;
+  job_pending_ = 0;
+  worker_pool->submit( run_job, (void*) job);
+}
+
+//***************************************************************************
+// Column_Profile::bin_chunk( begin, end, ichunk, *data) -- STATIC body of
+// the fused pass.  Bin rows [begin,end) of every column into the partial
+// counts for chunk ichunk, for all brushes at once.
+void Column_Profile::bin_chunk( int begin, int end, int ichunk, void *data)
+{
+  Job *job = (Job *) data;
+  int ncolumns = job->ncolumns;
+  unsigned int *partial =
+    &(job->partial[ (long) ichunk*NBRUSHES*ncolumns*nbins]);
+  const unsigned char *snapshot = &(job->snapshot[0]);
+
+  for( int k=0; k<ncolumns && !job->owner->cancel_; k++) {
+    const float *points = job->points[k];
+    float xmin = job->min[k], scale = job->scale[k];
+    unsigned int *column = partial + k*nbins;
+    for( int i=begin; i<end; i++) {
+      float f = ( points[i] - xmin) * scale;
+      int bin = !( f >= 0.0f) ? 0 : f < (float) (nbins-1) ? (int) f : nbins-1;
+      column[ snapshot[i]*ncolumns*nbins + bin]++;
+    }
+  }
+}
+
+//***************************************************************************
+// Column_Profile::run_job( *data) -- STATIC body of the background job.
+// Runs on a worker thread, so it must only touch the job and read the
+// column data, never the column ranks.
+void Column_Profile::run_job( void *data)
+{
+  Job *job = (Job *) data;
+  Column_Profile *owner = job->owner;
+  int ncolumns = job->ncolumns;
+
+  // Find the ranges of columns that weren't ranked when the job was queued
+  if( job->need_ranges) {
+    job->scale.assign( ncolumns, 0.0);
+    for( int k=0; k<ncolumns && !owner->cancel_; k++) {
+      const float *points = job->points[k];
+      float xmin = job->min[k], xmax = job->max[k];
+      if( !job->ranked[k]) {
+        xmin = xmax = points[0];
+        for( int i=1; i<npoints; i++) {
+          if( points[i] < xmin) xmin = points[i];
+          if( points[i] > xmax) xmax = points[i];
+        }
+      }
+      job->min[k] = xmin;
+      job->max[k] = xmax;
+      job->scale[k] = xmax > xmin ? nbins / ( xmax - xmin) : 0.0;
+    }
+  }
+
+  // One fused pass over rows.  Per-chunk counts are bounded in memory.
+  long slots = (long) NBRUSHES * ncolumns * nbins;
+  job->nchunks = worker_pool->nthreads() + 1;
+  if( job->nchunks * slots * (long) sizeof( unsigned int) > partial_budget)
+    job->nchunks = partial_budget / ( slots * sizeof( unsigned int));
+  if( job->nchunks < 1) job->nchunks = 1;
+  if( job->nchunks > npoints) job->nchunks = npoints;
+  job->partial.assign( job->nchunks * slots, 0);
+  if( !owner->cancel_)
+    worker_pool->parallel_for( npoints, job->nchunks, bin_chunk, data);
+
+  job->counts.assign( slots, 0.0);
+  for( int c=0; c<job->nchunks && !owner->cancel_; c++) {
+    const unsigned int *partial = &(job->partial[ c*slots]);
+    for( long s=0; s<slots; s++) job->counts[s] += partial[s];
+  }
+  std::vector<unsigned int>().swap( job->partial);
+
+  // Tell the main thread we're done
+  pthread_mutex_lock( &owner->mutex_);
+  owner->job_done_ = 1;
+  pthread_cond_broadcast( &owner->cond_);
+  pthread_mutex_unlock( &owner->mutex_);
+}
+
+//***************************************************************************
+// Column_Profile::cancel_job() -- Ask the background job to stop, wait for
+// it, and discard its results.
+void Column_Profile::cancel_job()
+{
+  if( job_ == NULL) return;
+  cancel_ = 1;
+  pthread_mutex_lock( &mutex_);
+  while( !job_done_) pthread_cond_wait( &cond_, &mutex_);
+  pthread_mutex_unlock( &mutex_);
+  delete job_;
+  job_ = NULL;
+  cancel_ = 0;
+}
+
+//***************************************************************************
+// Column_Profile::finish_job() -- Install the results of the background
+// job.  The counts describe the snapshot, so move any points whose brush
+// has changed since then.
+void Column_Profile::finish_job()
+{
+  Job *job = job_;
+  job_ = NULL;
+  if( job->ncolumns != nvars || (int) job->snapshot.size() != npoints) {
+    delete job;
+    ranges_valid_ = 0;
+    job_pending_ = 1;
+    return;
+  }
+
+  ncolumns_ = job->ncolumns;
+  min_.swap( job->min);
+  max_.swap( job->max);
+  scale_.swap( job->scale);
+  ranges_valid_ = 1;
+  counts_.swap( job->counts);
+
+  if( Plot_Window::gathered_selection.rows() == npoints) {
+    for( int i=0; i<npoints; i++) {
+      int b = Plot_Window::gathered_selection(i);
+      if( b != job->snapshot[i]) {
+        apply_point( i, job->snapshot[i], -1.0);
+        apply_point( i, b, 1.0);
+      }
+    }
+  }
+  counts_valid_ = 1;
+  job_pending_ = 0;
+  display_dirty_ = 1;
+  delete job;
+}
+
+//***************************************************************************
+// Column_Profile::poll() -- Collect the results of a finished job, start a
+// new one if the counts are stale, and redraw the view if anything is new.
+void Column_Profile::poll()
+{
+  if( job_ != NULL) {
+    pthread_mutex_lock( &mutex_);
+    int bDone = job_done_;
+    pthread_mutex_unlock( &mutex_);
+    if( bDone) finish_job();
+  }
+  if( ncolumns_ != nvars) {
+    counts_valid_ = 0;
+    job_pending_ = 1;
+  }
+  if( job_ == NULL && job_pending_) submit_job();
+
+  if( display_dirty_ && view_ != NULL) {
+    display_dirty_ = 0;
+    view_->redraw();
+  }
+}
+
+//***************************************************************************
+// Column_Profile::timeout_cb( *data) -- STATIC callback to poll while the
+// window is open.
+void Column_Profile::timeout_cb( void *data)
+{
+  Column_Profile *profile = (Column_Profile *) data;
+  if( profile->window_ == NULL || !profile->window_->shown()) return;
+  profile->poll();
+  Fl::repeat_timeout( poll_interval, timeout_cb, data);
+}
+
+//***************************************************************************
+// Column_Profile::close_cb( *o, *data) -- STATIC callback to close the
+// window.  Stop tracking until it is opened again.
+void Column_Profile::close_cb( Fl_Widget *o, void *data)
+{
+  Column_Profile *profile = (Column_Profile *) data;
+  profile->window_->hide();
+  Fl::remove_timeout( timeout_cb, data);
+  profile->cancel_job();
+  profile->counts_valid_ = 0;
+}
+
+//***************************************************************************
+// Column_Profile::make_window() -- Create the non-modal profile window, if
+// necessary, show it, and start polling.
+void Column_Profile::make_window()
+{
+  if( window_ == NULL) {
+    window_ = new Fl_Window( 800, 600, "Column Profiles");
+    window_->begin();
+    window_->selection_color( FL_BLUE);
+    window_->labelsize( 10);
+
+    view_ = new Column_Profile_View( 5, 5, 790, 560, this);
+
+    Fl_Button* close_button = new Fl_Button( 370, 570, 60, 25, "&Close");
+    close_button->callback( (Fl_Callback*) close_cb, (void*) this);
+
+    window_->resizable( view_);
+    window_->callback( (Fl_Callback*) close_cb, (void*) this);
+    window_->end();
+  }
+  window_->show();
+
+  counts_valid_ = 0;
+  job_pending_ = 1;
+  display_dirty_ = 1;
+  Fl::remove_timeout( timeout_cb, (void*) this);
+  Fl::add_timeout( poll_interval, timeout_cb, (void*) this);
+  poll();
+}
+
+//***************************************************************************
+// Column_Profile::static_make_window( *o, *data) -- STATIC menu callback to
+// show the window for the global Column_Profile object.
+void Column_Profile::static_make_window( Fl_Widget *o, void *data)
+{
+  if( column_profile != NULL) column_profile->make_window();
+}
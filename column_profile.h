@@ -0,0 +1,211 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: column_profile.h
+//
+// Class definitions:
+//   Column_Profile -- Live marginal and per-brush histograms of all columns
+//   Column_Profile_View -- Widget to draw the histograms as small multiples
+//
+// Classes referenced:
+//   Plot_Window -- Source of selection deltas
+//   Worker_Pool -- Runs the binning passes
+//   Brush -- Colors for per-brush histograms
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Show how the distribution of each brush differs from that of all
+//   points across every loaded column, not just the plotted ones, while the
+//   user brushes.
+//
+// General design philosophy:
+//   1) Each column has a fixed set of equal-width bins over its full range.
+//      Counts are kept for every brush, column, and bin; the marginal is
+//      their sum over brushes.
+//   2) Counts are rebuilt by a background job in one fused pass: chunks of
+//      rows are binned in parallel, each chunk reading every column once and
+//      updating the counts of all brushes together.
+//   3) After each gather, counts are moved between brushes for just the
+//      points that changed, on the main thread.  If that would exceed a
+//      fixed budget of work, the counts are left to the background job
+//      instead, so the profile never slows down brushing.  The window is
+//      redrawn from a timer rather than on every gather.
+//   4) Nothing is tracked while the window is closed.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef COLUMN_PROFILE_H
+#define COLUMN_PROFILE_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Declare class Column_Profile so it can be used by the view
+class Column_Profile;
+
+//***************************************************************************
+// Class: Column_Profile_View
+//
+// Class definitions:
+//   Column_Profile_View -- Widget to draw the histograms as small multiples
+//
+// Classes referenced:
+//   Column_Profile
+//
+// Purpose: Draw one cell per column, holding the marginal histogram in gray
+//   and the histogram of each active brush in its color, each scaled to its
+//   own peak.  Counts are shown while a rebuild is under way.
+//
+// Functions:
+//   Column_Profile_View( x, y, w, h, *profile) -- Constructor
+//   draw() -- Draw the cells
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Column_Profile_View : public Fl_Widget
+{
+  protected:
+    Column_Profile *profile_;
+    void draw();
+
+  public:
+    Column_Profile_View( int x, int y, int w, int h, Column_Profile *profile);
+};
+
+//***************************************************************************
+// Class: Column_Profile
+//
+// Class definitions:
+//   Column_Profile -- Live marginal and per-brush histograms of all columns
+//
+// Classes referenced:
+//   Plot_Window, Worker_Pool, Column_Profile_View
+//
+// Purpose: Maintain histograms of every column for every brush and show
+//   them in a non-modal window.
+//
+// Functions:
+//   Column_Profile() -- Constructor
+//   ~Column_Profile() -- Destructor
+//
+//   update_from_selection_delta() -- Apply changes from the last gather
+//   data_changed() -- Discard everything because the data have changed
+//   make_window() -- Create and show the profile window
+//
+//   ncolumns() -- Number of columns profiled
+//   has_counts() -- Are there counts to show, even if out of date?
+//   count( brush, column, bin) -- Count of a brush in one bin of a column
+//
+//   bin_of( column, x) -- Bin of value x in a column
+//   apply_point( i, brush, sign) -- Add or remove one point from the counts
+//   submit_job() -- Start a background rebuild of the counts
+//   finish_job() -- Install the results of a background rebuild
+//   cancel_job() -- Stop a background rebuild and wait for it
+//   poll() -- Check on the background job and redraw the view
+//
+// Static functions:
+//   bin_chunk( begin, end, ichunk, *data) -- Body of the fused pass
+//   run_job( *data) -- Body of the background job
+//   timeout_cb( *data) -- Periodic callback while the window is open
+//   close_cb( *o, *data) -- Callback to close the window
+//   static_make_window( *o, *data) -- Menu callback
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Column_Profile
+{
+  protected:
+    // Columns profiled and their ranges.  Bin edges of column k are at
+    // min_[k] + bin/scale_[k].
+    int ncolumns_;
+    int ranges_valid_;
+    std::vector<float> min_, max_, scale_;
+
+    // Counts, indexed [(brush*ncolumns+k)*nbins+bin], and whether they
+    // describe the last gather
+    int counts_valid_;
+    std::vector<double> counts_;
+
+    // Background job.  The snapshot and results belong to the job until
+    // job_done is set.
+    struct Job {
+      Column_Profile *owner;
+      int ncolumns;
+      std::vector<const float*> points;
+      std::vector<unsigned char> snapshot;
+      int generation;
+      int need_ranges;
+      std::vector<unsigned char> ranked;
+      std::vector<float> min, max, scale;
+      int nchunks;
+      std::vector<unsigned int> partial;
+      std::vector<double> counts;
+    };
+    Job *job_;
+    int job_done_;
+    volatile int cancel_;
+    int job_pending_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+
+    // Window and display state
+    Fl_Window *window_;
+    Column_Profile_View *view_;
+    int display_dirty_;
+
+    inline int bin_of( int k, float x) const;
+    void apply_point( int i, int brush, double sign);
+    void submit_job();
+    void finish_job();
+    void cancel_job();
+    void poll();
+
+    static void bin_chunk( int begin, int end, int ichunk, void *data);
+    static void run_job( void *data);
+    static void timeout_cb( void *data);
+    static void close_cb( Fl_Widget *o, void *data);
+
+  public:
+    Column_Profile();
+    ~Column_Profile();
+
+    void update_from_selection_delta();
+    void data_changed();
+    void make_window();
+    static void static_make_window( Fl_Widget *o, void *data);
+
+    int ncolumns() { return ncolumns_;}
+    int has_counts() 
+    { return ncolumns_ > 0 && (int) counts_.size() == NBRUSHES*ncolumns_*nbins;}
+    double count( int brush, int k, int bin)
+    { return counts_[ (brush*ncolumns_ + k)*nbins + bin];}
+
+    // Bins per column, most column updates applied per gather, memory
+    // allowed for per-chunk counts, and seconds between redraws
+    static const int nbins = 64;
+    static const int delta_budget = 1 << 21;
+    static const long partial_budget = 64L*1024*1024;
+    static const double poll_interval;
+};
+
+//***************************************************************************
+// Column_Profile::bin_of( k, x) -- Bin of value x in column k, clamped to
+// the valid range.  Values that aren't numbers go in the first bin.
+inline int Column_Profile::bin_of( int k, float x) const
+{
+  float f = ( x - min_[k]) * scale_[k];
+  if( !( f >= 0.0f)) return 0;
+  return f < (float) (nbins-1) ? (int) f : nbins-1;
+}
+
+#endif   // COLUMN_PROFILE_H
@@ -323,7 +323,7 @@ void Control_Panel_Window::maybe_redraw()
 {
   // kludge.  Avoid double redraw when setting "don't clear".
   if( dont_clear->value()) return;
-  pw->needs_redraw = 1;
+  pw->schedule_redraw( Frame_Scheduler::REDRAW_DECORATION);
 }
 
 //***************************************************************************
@@ -491,6 +491,11 @@ void Control_Panel_Window::make_widgets( Control_Panel_Window *cpw)
     {"selection",   0, 0, (void *)HISTOGRAM_SELECTION,   FL_MENU_TOGGLE},
     {"conditional", 0, 0, (void *)HISTOGRAM_CONDITIONAL, FL_MENU_TOGGLE|FL_MENU_DIVIDER},
     {"weighted",    0, 0, (void *)HISTOGRAM_WEIGHTED,    FL_MENU_TOGGLE},
+    {"smooth (KDE)",0, 0, (void *)HISTOGRAM_KDE,         FL_MENU_TOGGLE|FL_MENU_DIVIDER},
+    {"equal width", 0, 0, (void *)HISTOGRAM_EQUAL_WIDTH, FL_MENU_RADIO|FL_MENU_VALUE},
+    {"equal depth", 0, 0, (void *)HISTOGRAM_EQUAL_DEPTH, FL_MENU_RADIO},
+    {"Freedman-Diaconis", 0, 0, (void *)HISTOGRAM_FREEDMAN_DIACONIS, FL_MENU_RADIO},
+    {"Bayesian blocks",   0, 0, (void *)HISTOGRAM_BAYESIAN_BLOCKS,   FL_MENU_RADIO},
     {0}
   };
   // int n_histogram_pulldown_items = (sizeof(histogram_pulldown) / sizeof(histogram_pulldown[0])) - 1;
@@ -600,6 +605,7 @@ void Control_Panel_Window::make_widgets( Control_Panel_Window *cpw)
   spin = b = new Fl_Button(xpos+rot_slider->w()+5, ypos, 20, 20, "spin");
   b->align(FL_ALIGN_RIGHT); b->selection_color(FL_BLUE);
   b->type(FL_TOGGLE_BUTTON);
+  b->callback((Fl_Callback*)replot, this);
   b->tooltip("toggle continuous rotation around screen y");
 
   // Next portion of the panel is miscellanious stuff, per plot
@@ -651,6 +657,30 @@ void Control_Panel_Window::make_widgets( Control_Panel_Window *cpw)
   dont_clear->callback((Fl_Callback*)static_maybe_redraw, this);
   dont_clear->tooltip("psychedelic fun");
 
+  // Draw density rendering menu for this plot
+  Fl_Menu_Item density_menu_items[] = {
+    {"points",                                 0, 0, (void *)DENSITY_OFF,               0, 0, 0, 0, 0},
+    {"points, duplicates drawn once",          0, 0, (void *)DENSITY_COLLAPSED,         0, 0, 0, 0, 0},
+    {"points, duplicates sized by count",      0, 0, (void *)DENSITY_COLLAPSED_SIZE,    0, 0, 0, 0, 0},
+    {"points, duplicates shaded by count",     0, 0, (void *)DENSITY_COLLAPSED_ALPHA,   0, 0, 0, 0, 0},
+    {"density, log scale",                     0, 0, (void *)DENSITY_LOG,               0, 0, 0, 0, 0},
+    {"density, equalized",                     0, 0, (void *)DENSITY_EQUALIZED,         0, 0, 0, 0, 0},
+    {"density of each brush, log scale",       0, 0, (void *)DENSITY_BRUSHES_LOG,       0, 0, 0, 0, 0},
+    {"density of each brush, equalized",       0, 0, (void *)DENSITY_BRUSHES_EQUALIZED, 0, 0, 0, 0, 0},
+    {"mean z",                                 0, 0, (void *)DENSITY_MEAN_Z,            0, 0, 0, 0, 0},
+    {0}
+  };
+
+  density_menu = new Fl_Choice(xpos2, ypos+=25, 20, 20);
+  density_menu->textsize(14);
+  density_menu->copy(density_menu_items);
+  density_menu->align(FL_ALIGN_RIGHT);
+  density_menu->label("density");
+  density_menu->value(DENSITY_OFF);
+  density_menu->clear_visible_focus();
+  density_menu->callback( (Fl_Callback*)redraw_one_plot, this);
+  density_menu->tooltip("draw points, points at the same place once, or a binned density of the x-y projection of all points");
+
   ypos=ypos2;
   xpos=xpos2+120;
 
@@ -752,4 +782,12 @@ void Control_Panel_Window::make_widgets( Control_Panel_Window *cpw)
   
   transform_style->end();
   no_transform->setonly();
+
+  // Button (8,1): Isodensity contours of the x-y projection
+  show_contours = b = new Fl_Button(xpos, ypos+=25, 20, 20, "contours");
+  b->callback((Fl_Callback*)static_maybe_redraw, this);
+  b->align(FL_ALIGN_RIGHT); 
+  b->type(FL_TOGGLE_BUTTON); 
+  b->selection_color(FL_BLUE);
+  b->tooltip("draw contours of a smooth density estimate enclosing 25, 50, 75, and 90% of points");
 }
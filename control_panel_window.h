@@ -183,7 +183,7 @@ class Control_Panel_Window : public Fl_Group
     static void static_maybe_redraw( Fl_Widget *w, Control_Panel_Window *cpw)
     { cpw->maybe_redraw() ;}
     static void replot( Fl_Widget *w, Control_Panel_Window *cpw)
-    { cpw->pw->needs_redraw=1;}
+    { cpw->pw->schedule_redraw( Frame_Scheduler::REDRAW_DECORATION);}
     static void reset_view( Fl_Widget *w, Control_Panel_Window *cpw)
     { cpw->pw->reset_view() ;}
     static void redraw_one_plot( Fl_Widget *w, Control_Panel_Window *cpw)
@@ -203,13 +203,19 @@ class Control_Panel_Window : public Fl_Group
     Fl_Button *scale_points;
     Fl_Button *spin, *dont_clear, *show_points, *show_deselected_points;
     Fl_Button *show_axes, *show_grid, *show_labels;
+    Fl_Button *show_contours;
 
     Fl_Menu_Button *show_histogram[3];
     enum histogram_styles {
         HISTOGRAM_MARGINAL = 0,
         HISTOGRAM_SELECTION,   
         HISTOGRAM_CONDITIONAL,
-        HISTOGRAM_WEIGHTED
+        HISTOGRAM_WEIGHTED,
+        HISTOGRAM_KDE,
+        HISTOGRAM_EQUAL_WIDTH,
+        HISTOGRAM_EQUAL_DEPTH,
+        HISTOGRAM_FREEDMAN_DIACONIS,
+        HISTOGRAM_BAYESIAN_BLOCKS
     };
 
     Fl_Button *show_scale;
@@ -258,6 +264,21 @@ class Control_Panel_Window : public Fl_Group
       BLEND_ALL3
     };
 
+    // Density rendering menu and its styles.  Styles before DENSITY_LOG
+    // draw points.
+    Fl_Choice *density_menu;
+    enum density_styles {
+      DENSITY_OFF = 0,
+      DENSITY_COLLAPSED,
+      DENSITY_COLLAPSED_SIZE,
+      DENSITY_COLLAPSED_ALPHA,
+      DENSITY_LOG,
+      DENSITY_EQUALIZED,
+      DENSITY_BRUSHES_LOG,
+      DENSITY_BRUSHES_EQUALIZED,
+      DENSITY_MEAN_Z
+    };
+
     // Pointer to and index of the plot window associated with this control
     // panel tab.  Each plot window has the same color and index as its 
     // associated control panel tab.
@@ -32,6 +32,12 @@
 #include "data_file_manager.h"
 #include "column_info.h"
 #include "plot_window.h"
+#include "brush_statistics.h"
+#include "column_profile.h"
+#include "column_buffers.h"
+#include "selection_history.h"
+#include "selection_worker.h"
+#include "brush_algebra.h"
 
 // These includes should not be necessary and have been commented out
 // #include "Vp_File_Chooser.H"   // PRG's new file chooser
@@ -302,6 +308,11 @@ int Data_File_Manager::load_data_file()
     return -1;
   }
 
+  // Make sure no background computations are reading the old data
+  if( brush_statistics != NULL) brush_statistics->data_changed();
+  if( column_profile != NULL) column_profile->data_changed();
+  Column_Buffers::data_changed();
+
   // If this is an append or merge operation, save the existing data and 
   // column labels in temporary buffers
   unsigned uHaveOldData = 0;
@@ -2656,6 +2667,9 @@ void Data_File_Manager::delete_labels( Fl_Widget *o, void* user_data)
   int nChecked = edit_labels_widget->nchecked();
   int nRemain = nvars - nChecked;
   if( nChecked <= 0) return;
+  if( brush_statistics != NULL) brush_statistics->data_changed();
+  if( column_profile != NULL) column_profile->data_changed();
+  Column_Buffers::data_changed();
   if( nRemain <=1) {
     make_confirmation_window(
       "WARNING: Attempted to delete too many columns", 1);
@@ -2734,6 +2748,46 @@ void Data_File_Manager::delete_labels( Fl_Widget *o, void* user_data)
        << "needs_restore_panels (" << needs_restore_panels_ << ")" << endl;
 }
 
+//***************************************************************************
+// Data_File_Manager::add_column( label, values) -- Add a column of derived 
+// values, such as a density estimate, after the existing columns.  As with
+// delete_labels, the plots are rebuilt later by the idle callback.  Returns
+// 1 if the column was added.
+int Data_File_Manager::add_column( string label, blitz::Array<float,1> values)
+{
+  if( values.rows() != npoints) return 0;
+  if( nvars >= maxvars_) {
+    make_confirmation_window(
+      "WARNING: Too many columns to add another", 1);
+    return 0;
+  }
+  if( brush_statistics != NULL) brush_statistics->data_changed();
+  if( column_profile != NULL) column_profile->data_changed();
+  Column_Buffers::data_changed();
+
+  // Insert the new column before the final '-nothing-' label
+  Column_Info column_info_buf;
+  column_info_buf.label = label;
+  (column_info_buf.points).resize( npoints);
+  column_info_buf.points = values;
+  (column_info_buf.ranked_points).resize( npoints);
+  column_info_buf.isRanked = 0;
+  column_info.insert( column_info.begin() + nvars, column_info_buf);
+  nvars++;
+
+  // Update the Edit Column Labels window if it exists
+  if( edit_labels_widget != NULL) {
+    edit_labels_widget->clear();
+    for( int i=0; i<nvars; i++)
+      edit_labels_widget->add( (column_info[ i].label).c_str());
+  }
+
+  // Set flag so the idle callback, cb_manage_plot_window_array, in MAIN 
+  // will know to do a Restore Panels operation!
+  needs_restore_panels_ = 1;
+  return 1;
+}
+
 //***************************************************************************
 // Data_File_Manager::close_edit_labels_window( *o, *user_data) -- Callback 
 // function to close the Edit Column Labels window.  It is assumed that a 
@@ -2824,12 +2878,16 @@ void Data_File_Manager::resize_global_arrays()
   }
   
   // Resize and reinitialize selection related arrays and flags.
+  if( selection_worker != NULL) selection_worker->cancel();
   inside_footprint.resize( npoints);
   newly_selected.resize( npoints);
   selected.resize( npoints);
   previously_selected.resize( npoints);
   saved_selection.resize(npoints);
   Plot_Window::indices_selected.resize(NBRUSHES,npoints);
+  Plot_Window::gathered_selection.free();
+  if( selection_history != NULL) selection_history->clear();
+  if( brush_algebra != NULL) brush_algebra->data_changed();
   reset_selection_arrays();
 }
 
@@ -2840,6 +2898,9 @@ void Data_File_Manager::create_default_data( int nvars_in)
 {
   // Protect against screwy values of nvars_in
   if( nvars_in < 2) return;
+  if( brush_statistics != NULL) brush_statistics->data_changed();
+  if( column_profile != NULL) column_profile->data_changed();
+  Column_Buffers::data_changed();
   nvars = nvars_in;
   // if( nvars > MAXVARS) nvars = MAXVARS;
   if( nvars > maxvars_) nvars = maxvars_;
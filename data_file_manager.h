@@ -94,6 +94,7 @@
 //   edit_column_info( *o) -- Maintain Edit Column Labels window
 //   refresh_edit_column_info() -- Refresh labels of edit window
 //   delete_labels( *o, *u) -- Static callback to delete labels
+//   add_column( label, values) -- Add a column of derived values
 //   close_edit_labels_window( *o, *u) -- Static callback to close window
 //
 //   findOutputFile() -- Query user to find output file
@@ -251,6 +252,7 @@ class Data_File_Manager
     void edit_column_info_i( Fl_Widget *o);
     void refresh_edit_column_info();
     static void delete_labels( Fl_Widget *o, void* user_data);
+    int add_column( string label, blitz::Array<float,1> values);
     static void close_edit_labels_window( Fl_Widget *o, void* user_data);
     
     // Access methods
@@ -0,0 +1,720 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: density_renderer.cpp
+//
+// Class definitions:
+//   Density_Renderer -- Draw a plot as binned 2D point density
+//
+// Classes referenced:
+//   Plot_Window -- Source of vertices and view, and owner of the GL context
+//   Worker_Pool -- Runs the binning passes
+//   Brush -- Colors for per-brush density
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    Blitz++ 0.9 -- Various math routines
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <density_renderer.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "density_renderer.h"
+#include "worker_pool.h"
+#include "plot_window.h"
+#include "control_panel_window.h"
+#include "brush.h"
+#include "column_buffers.h"
+
+// Set static data members for class Density_Renderer::
+const double Density_Renderer::poll_interval = 0.02;
+
+//***************************************************************************
+// Density_Renderer::Density_Renderer() -- Constructor
+Density_Renderer::Density_Renderer() :
+  use_count_( 0), textures_epoch_( -1),
+  npoints_( 0), kind_( KIND_COUNT), request_generation_( 0), running_( 0),
+  cancel_( 0), polling_( 0), pw_( NULL)
+{
+  running_spec_.nx = 0;
+  pthread_mutex_init( &mutex_, NULL);
+  pthread_cond_init( &cond_, NULL);
+}
+
+//***************************************************************************
+// Density_Renderer::~Density_Renderer() -- Destructor
+Density_Renderer::~Density_Renderer()
+{
+  data_changed();
+  Fl::remove_timeout( timeout_cb, (void*) this);
+  pthread_cond_destroy( &cond_);
+  pthread_mutex_destroy( &mutex_);
+}
+
+//***************************************************************************
+// Density_Renderer::same_spec( a, b) -- STATIC method to decide whether two
+// specs describe the same grid of the same quantity.
+int Density_Renderer::same_spec( const Spec &a, const Spec &b)
+{
+  return a.nx == b.nx && a.ny == b.ny && a.kind == b.kind &&
+         a.xmin == b.xmin && a.xmax == b.xmax &&
+         a.ymin == b.ymin && a.ymax == b.ymax;
+}
+
+//***************************************************************************
+// Density_Renderer::covers( spec, xmin, xmax, ymin, ymax, cell_w, cell_h) --
+// STATIC method to decide whether a grid covers [xmin,xmax] x [ymin,ymax]
+// with cells no more than half again as large as cell_w by cell_h.
+int Density_Renderer::covers(
+  const Spec &spec, float xmin, float xmax, float ymin, float ymax,
+  float cell_w, float cell_h)
+{
+  float dx = ( spec.xmax - spec.xmin) / spec.nx;
+  float dy = ( spec.ymax - spec.ymin) / spec.ny;
+  return spec.xmin <= xmin + 1.0e-3*dx && spec.xmax >= xmax - 1.0e-3*dx &&
+         spec.ymin <= ymin + 1.0e-3*dy && spec.ymax >= ymax - 1.0e-3*dy &&
+         dx <= 1.5 * cell_w && dy <= 1.5 * cell_h;
+}
+
+//***************************************************************************
+// Density_Renderer::finer( *a, *b) -- STATIC comparison to sort levels from
+// the smallest cells to the largest.
+bool Density_Renderer::finer( const Level *a, const Level *b)
+{
+  float area_a = (a->spec.xmax-a->spec.xmin)*(a->spec.ymax-a->spec.ymin) /
+                 ((float) a->spec.nx * a->spec.ny);
+  float area_b = (b->spec.xmax-b->spec.xmin)*(b->spec.ymax-b->spec.ymin) /
+                 ((float) b->spec.nx * b->spec.ny);
+  return area_a < area_b;
+}
+
+//***************************************************************************
+// Density_Renderer::bin_chunk( begin, end, ichunk, *data) -- STATIC body of
+// the binning pass.  Bin points [begin,end) into the grid for chunk ichunk,
+// giving up if a newer request or a cancel arrives.
+void Density_Renderer::bin_chunk( int begin, int end, int ichunk, void *data)
+{
+  Pass *pass = (Pass *) data;
+  Density_Renderer *r = pass->owner;
+  const Spec &spec = pass->spec;
+  int ncells = pass->ncells;
+  float *grid = &(pass->partial[ (long) ichunk * pass->nplanes * ncells]);
+  const Vertex_Source &v = r->vertices_;
+  const int *codes = spec.codes;
+  float sx = spec.nx / (spec.xmax - spec.xmin);
+  float sy = spec.ny / (spec.ymax - spec.ymin);
+  float fnx = (float) spec.nx;
+  float fny = (float) spec.ny;
+
+  for( int base=begin; base<end; base+=block_size) {
+    if( r->cancel_ ||
+        ( spec.abortable && r->request_generation_ != pass->generation)) {
+      pass->aborted = 1;
+      return;
+    }
+    int stop = base + block_size;
+    if( stop > end) stop = end;
+
+    // Points outside the grid, including NaNs, fail the range test
+    for( int i=base; i<stop; i++) {
+      float fx = ( v.value( 0, i) - spec.xmin) * sx;
+      float fy = ( v.value( 1, i) - spec.ymin) * sy;
+      if( !( fx >= 0.0f && fx < fnx && fy >= 0.0f && fy < fny)) continue;
+      int cell = ( (int) fy) * spec.nx + (int) fx;
+      if( spec.kind == KIND_BRUSHES) grid[ codes[i]*ncells + cell] += 1.0f;
+      else {
+        grid[ cell] += 1.0f;
+        if( spec.kind == KIND_MEAN_Z) grid[ ncells + cell] += v.value( 2, i);
+      }
+    }
+  }
+}
+
+//***************************************************************************
+// Density_Renderer::sum_chunk( begin, end, ichunk, *data) -- STATIC method
+// to add values [begin,end) of every chunk's grids into the first one.
+void Density_Renderer::sum_chunk( int begin, int end, int ichunk, void *data)
+{
+  Pass *pass = (Pass *) data;
+  long nvalues = (long) pass->nplanes * pass->ncells;
+  float *sum = &(pass->partial[0]);
+  for( int p=1; p<pass->nparts; p++) {
+    const float *partial = &(pass->partial[ p*nvalues]);
+    for( int k=begin; k<end; k++) sum[k] += partial[k];
+  }
+}
+
+//***************************************************************************
+// Density_Renderer::bin( spec, generation) -- Bin every point into a new
+// level.  Runs on a worker thread.  Returns NULL if the pass was abandoned
+// because a newer request arrived after request generation 'generation',
+// or because we were cancelled.
+Density_Renderer::Level *Density_Renderer::bin( const Spec &spec, int generation)
+{
+  Pass pass;
+  pass.owner = this;
+  pass.spec = spec;
+  pass.generation = generation;
+  pass.nplanes = 1;
+  if( spec.kind == KIND_BRUSHES) pass.nplanes = NBRUSHES;
+  else if( spec.kind == KIND_MEAN_Z) pass.nplanes = 2;
+  pass.ncells = spec.nx * spec.ny;
+  pass.aborted = 0;
+
+  // Use as many per-chunk grids as there are threads, memory permitting
+  int nvalues = pass.nplanes * pass.ncells;
+  pass.nparts = 1;
+  if( worker_pool != NULL && npoints_ >= 2*block_size) {
+    pass.nparts = worker_pool->nthreads() + 1;
+    long fit = partial_budget / ( (long) nvalues * sizeof( float));
+    if( fit < 1) fit = 1;
+    if( pass.nparts > fit) pass.nparts = (int) fit;
+  }
+  pass.partial.assign( (long) pass.nparts * nvalues, 0.0f);
+
+  if( pass.nparts > 1)
+    worker_pool->parallel_for( npoints_, pass.nparts, bin_chunk, (void*) &pass);
+  else bin_chunk( 0, npoints_, 0, (void*) &pass);
+  if( pass.aborted) return (Level *) NULL;
+  if( pass.nparts > 1)
+    worker_pool->parallel_for( nvalues, pass.nparts, sum_chunk, (void*) &pass);
+
+  Level *level = new Level;
+  level->spec = spec;
+  level->nplanes = pass.nplanes;
+  level->planes.assign( pass.partial.begin(), pass.partial.begin() + nvalues);
+  level->stale = 0;
+  level->last_used = 0;
+  level->texture = 0;
+  level->texture_w = level->texture_h = 0;
+
+  // Sort the totals for the equalized color map here, off the main thread
+  std::vector<float> &sorted = level->sorted_totals;
+  for( int cell=0; cell<pass.ncells; cell++) {
+    float total = level->planes[ cell];
+    if( spec.kind == KIND_BRUSHES)
+      for( int b=1; b<NBRUSHES; b++) total += level->planes[ b*pass.ncells + cell];
+    if( total > 0.0f) sorted.push_back( total);
+  }
+  std::sort( sorted.begin(), sorted.end());
+  level->max_total = sorted.empty() ? 0.0f : sorted.back();
+  return level;
+}
+
+//***************************************************************************
+// Density_Renderer::run_job( *data) -- STATIC body of the worker job.  Bin
+// requested levels until there are none left.
+void Density_Renderer::run_job( void *data)
+{
+  Density_Renderer *r = (Density_Renderer *) data;
+
+  pthread_mutex_lock( &r->mutex_);
+  while( !r->cancel_ && !r->pending_.empty()) {
+    Spec spec = r->pending_.front();
+    r->pending_.pop_front();
+    r->running_spec_ = spec;
+    int generation = r->request_generation_;
+    pthread_mutex_unlock( &r->mutex_);
+
+    Level *level = r->bin( spec, generation);
+
+    pthread_mutex_lock( &r->mutex_);
+    if( level != NULL) {
+      if( r->cancel_) delete level;
+      else r->finished_.push_back( level);
+    }
+  }
+  r->running_spec_.nx = 0;
+  r->running_ = 0;
+  pthread_cond_broadcast( &r->cond_);
+  pthread_mutex_unlock( &r->mutex_);
+}
+
+//***************************************************************************
+// Density_Renderer::request( xmin, xmax, ymin, ymax, nx, ny, abortable) --
+// Ask for a level of the current kind, unless an up-to-date one exists or
+// is already on its way.  An abortable request supersedes earlier abortable
+// ones.  Returns 1 if a new level was requested.  Main thread only.
+int Density_Renderer::request(
+  float xmin, float xmax, float ymin, float ymax,
+  int nx, int ny, int abortable)
+{
+  Spec spec;
+  spec.xmin = xmin;
+  spec.xmax = xmax;
+  spec.ymin = ymin;
+  spec.ymax = ymax;
+  spec.nx = nx;
+  spec.ny = ny;
+  spec.kind = kind_;
+  spec.abortable = abortable;
+
+  // Per-brush levels count the selection as of the last gather, so later
+  // deltas apply cleanly
+  spec.codes = (const int *) NULL;
+  spec.generation = -1;
+  if( kind_ == KIND_BRUSHES) {
+    spec.codes = selected.data();
+    if( Plot_Window::gathered_selection.rows() == npoints_) {
+      spec.codes = Plot_Window::gathered_selection.data();
+      spec.generation = Plot_Window::selection_generation;
+    }
+  }
+
+  for( unsigned int i=0; i<levels_.size(); i++) {
+    if( !levels_[i]->stale && same_spec( levels_[i]->spec, spec)) {
+      levels_[i]->last_used = ++use_count_;
+      return 0;
+    }
+  }
+
+  // Without a worker pool, bin right here
+  if( worker_pool == NULL) {
+    Level *level = bin( spec, request_generation_);
+    pthread_mutex_lock( &mutex_);
+    finished_.push_back( level);
+    pthread_mutex_unlock( &mutex_);
+    collect();
+    return 1;
+  }
+
+  int start = 0;
+  pthread_mutex_lock( &mutex_);
+  int duplicate = running_ && same_spec( running_spec_, spec);
+  for( unsigned int i=0; i<pending_.size() && !duplicate; i++)
+    duplicate = same_spec( pending_[i], spec);
+  if( duplicate) {
+    pthread_mutex_unlock( &mutex_);
+    return 0;
+  }
+  if( abortable) {
+    for( std::deque<Spec>::iterator iter = pending_.begin(); iter != pending_.end();) {
+      if( iter->abortable) iter = pending_.erase( iter);
+      else iter++;
+    }
+    request_generation_++;
+  }
+  pending_.push_back( spec);
+  if( !running_) {
+    running_ = 1;
+    start = 1;
+  }
+  pthread_mutex_unlock( &mutex_);
+
+  if( start) worker_pool->submit( run_job, (void*) this);
+  if( !polling_) {
+    polling_ = 1;
+    Fl::add_timeout( poll_interval, timeout_cb, (void*) this);
+  }
+  return 1;
+}
+
+//***************************************************************************
+// Density_Renderer::release( *level) -- Delete a level.  Its texture name
+// is kept for the next level, since there may be no GL context to delete it
+// in.  Main thread only.
+void Density_Renderer::release( Level *level)
+{
+  if( level->texture != 0) free_textures_.push_back( level->texture);
+  delete level;
+}
+
+//***************************************************************************
+// Density_Renderer::clear_levels() -- Release all levels.  Main thread only.
+void Density_Renderer::clear_levels()
+{
+  for( unsigned int i=0; i<levels_.size(); i++) release( levels_[i]);
+  levels_.clear();
+}
+
+//***************************************************************************
+// Density_Renderer::collect() -- Take levels the worker has finished.  Each
+// replaces any older level of the same grid, and the least recently used
+// levels are dropped to stay within max_levels.  Returns the number of
+// levels taken.  Main thread only.
+int Density_Renderer::collect()
+{
+  std::vector<Level*> done;
+  pthread_mutex_lock( &mutex_);
+  done.swap( finished_);
+  pthread_mutex_unlock( &mutex_);
+
+  for( unsigned int k=0; k<done.size(); k++) {
+    for( unsigned int i=0; i<levels_.size();) {
+      if( same_spec( levels_[i]->spec, done[k]->spec)) {
+        release( levels_[i]);
+        levels_.erase( levels_.begin() + i);
+      }
+      else i++;
+    }
+    done[k]->last_used = ++use_count_;
+    levels_.push_back( done[k]);
+  }
+
+  while( (int) levels_.size() > max_levels) {
+    int oldest = 0;
+    for( unsigned int i=1; i<levels_.size(); i++)
+      if( levels_[i]->last_used < levels_[oldest]->last_used) oldest = i;
+    release( levels_[oldest]);
+    levels_.erase( levels_.begin() + oldest);
+  }
+  return done.size();
+}
+
+//***************************************************************************
+// Density_Renderer::timeout_cb( *data) -- STATIC callback to pick up levels
+// as they are finished and redraw.  Stops itself when the worker is idle.
+void Density_Renderer::timeout_cb( void *data)
+{
+  Density_Renderer *r = (Density_Renderer *) data;
+  if( r->collect() && r->pw_ != NULL)
+    r->pw_->schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
+
+  pthread_mutex_lock( &r->mutex_);
+  int busy = r->running_ || !r->finished_.empty();
+  pthread_mutex_unlock( &r->mutex_);
+  if( busy) Fl::repeat_timeout( poll_interval, timeout_cb, data);
+  else r->polling_ = 0;
+}
+
+//***************************************************************************
+// Density_Renderer::wait() -- Block until no binning pass is running.  Used
+// before the gathered selection changes, since per-brush passes read it.
+void Density_Renderer::wait()
+{
+  pthread_mutex_lock( &mutex_);
+  while( running_) pthread_cond_wait( &cond_, &mutex_);
+  pthread_mutex_unlock( &mutex_);
+}
+
+//***************************************************************************
+// Density_Renderer::data_changed() -- Stop the worker, wait for it, and
+// discard every level.  Used before the vertices change, and when density
+// rendering is turned off.
+void Density_Renderer::data_changed()
+{
+  cancel_ = 1;
+  pthread_mutex_lock( &mutex_);
+  pending_.clear();
+  while( running_) pthread_cond_wait( &cond_, &mutex_);
+  pthread_mutex_unlock( &mutex_);
+  cancel_ = 0;
+
+  collect();
+  clear_levels();
+  vertices_.clear();
+  npoints_ = 0;
+}
+
+//***************************************************************************
+// Density_Renderer::free_textures() -- Delete the textures of discarded
+// levels that no new level has reused.  Must be called with the plot's
+// context current.  Textures from contexts that are gone are forgotten.
+void Density_Renderer::free_textures()
+{
+  if( free_textures_.empty()) return;
+  if( textures_epoch_ == Column_Buffers::epoch())
+    glDeleteTextures( free_textures_.size(), &free_textures_[0]);
+  free_textures_.clear();
+}
+
+//***************************************************************************
+// Density_Renderer::update_from_selection_delta() -- Move the points whose
+// brush changed in the last gather between the planes of each per-brush
+// level.  Levels the delta can't bring up to date are marked stale, to be
+// drawn until they are replaced.
+void Density_Renderer::update_from_selection_delta()
+{
+  if( kind_ != KIND_BRUSHES) return;
+  collect();
+
+  const std::vector<int> &points = Plot_Window::changed_points;
+  const std::vector<int> &from = Plot_Window::changed_from;
+  for( unsigned int l=0; l<levels_.size(); l++) {
+    Level *level = levels_[l];
+    Spec &spec = level->spec;
+    if( level->stale) continue;
+    if( !Plot_Window::selection_delta_valid ||
+        spec.generation != Plot_Window::selection_generation-1) {
+      level->stale = 1;
+      continue;
+    }
+
+    int ncells = spec.nx * spec.ny;
+    float sx = spec.nx / (spec.xmax - spec.xmin);
+    float sy = spec.ny / (spec.ymax - spec.ymin);
+    for( unsigned int k=0; k<points.size(); k++) {
+      int i = points[k];
+      float fx = ( vertices_.value( 0, i) - spec.xmin) * sx;
+      float fy = ( vertices_.value( 1, i) - spec.ymin) * sy;
+      if( !( fx >= 0.0f && fx < spec.nx && fy >= 0.0f && fy < spec.ny)) continue;
+      int cell = ( (int) fy) * spec.nx + (int) fx;
+      level->planes[ from[k]*ncells + cell] -= 1.0f;
+      level->planes[ Plot_Window::gathered_selection( i)*ncells + cell] += 1.0f;
+    }
+    spec.generation = Plot_Window::selection_generation;
+    level->texture_key.clear();
+  }
+}
+
+//***************************************************************************
+// Density_Renderer::build_texture( *pw, *level, style) -- Color map a level
+// into its texture, unless the texture is already up to date.  Counts map
+// to intensity through log( 1+count) or through their rank among all
+// nonzero cells.  Count levels use a black-red-yellow-white ramp, per-brush
+// levels mix the brush colors in proportion to their counts, and mean-z
+// levels run from blue through white to red.  Must be called with pw's GL
+// context current.
+void Density_Renderer::build_texture( Plot_Window *pw, Level *level, int style)
+{
+  const Spec &spec = level->spec;
+  int equalized = ( style == Control_Panel_Window::DENSITY_EQUALIZED ||
+                    style == Control_Panel_Window::DENSITY_BRUSHES_EQUALIZED);
+  int show_deselected = pw->cp->show_deselected_points->value();
+
+  // Everything the colors depend on besides the counts themselves
+  std::vector<float> key;
+  key.push_back( style);
+  key.push_back( show_deselected);
+  if( spec.kind == KIND_BRUSHES) {
+    for( int b=0; b<NBRUSHES; b++) {
+      key.push_back( brushes[b]->color_chooser->r());
+      key.push_back( brushes[b]->color_chooser->g());
+      key.push_back( brushes[b]->color_chooser->b());
+    }
+  }
+  if( spec.kind == KIND_MEAN_Z) {
+    key.push_back( pw->amin[2]);
+    key.push_back( pw->amax[2]);
+  }
+  if( level->texture != 0 && key == level->texture_key) return;
+
+  int ncells = spec.nx * spec.ny;
+  const std::vector<float> &sorted = level->sorted_totals;
+  float log_max = logf( 1.0f + level->max_total);
+  float zmin = pw->amin[2];
+  float zrange = pw->amax[2] - pw->amin[2];
+  std::vector<unsigned char> image( 4*ncells, 0);
+
+  for( int cell=0; cell<ncells; cell++) {
+    float r = 0.0, g = 0.0, b = 0.0, total = 0.0;
+    if( spec.kind == KIND_BRUSHES) {
+      for( int brush = show_deselected ? 0 : 1; brush<NBRUSHES; brush++) {
+        float count = level->planes[ brush*ncells + cell];
+        if( count <= 0.0f) continue;
+        r += count * brushes[brush]->color_chooser->r();
+        g += count * brushes[brush]->color_chooser->g();
+        b += count * brushes[brush]->color_chooser->b();
+        total += count;
+      }
+      if( total > 0.0f) {
+        r /= total;
+        g /= total;
+        b /= total;
+      }
+    }
+    else total = level->planes[ cell];
+    if( total <= 0.0f) continue;
+
+    float t;
+    if( equalized)
+      t = ( std::upper_bound( sorted.begin(), sorted.end(), total) - sorted.begin()) /
+          (float) sorted.size();
+    else t = logf( 1.0f + total) / log_max;
+    if( t > 1.0f) t = 1.0f;
+
+    // Keep the sparsest cells visible against a black background
+    float intensity = 0.2f + 0.8f*t;
+    if( spec.kind == KIND_COUNT) {
+      r = fminf( 1.0f, 3.0f*intensity);
+      g = fminf( 1.0f, fmaxf( 0.0f, 3.0f*intensity - 1.0f));
+      b = fmaxf( 0.0f, 3.0f*intensity - 2.0f);
+    }
+    else {
+      if( spec.kind == KIND_MEAN_Z) {
+        float u = 0.5f;
+        if( zrange > 0.0f)
+          u = ( level->planes[ ncells + cell]/total - zmin) / zrange;
+        u = fminf( 1.0f, fmaxf( 0.0f, u));
+        r = fminf( 1.0f, 2.0f*u);
+        g = 1.0f - fabsf( 2.0f*u - 1.0f);
+        b = fminf( 1.0f, 2.0f*(1.0f-u));
+      }
+      r *= intensity;
+      g *= intensity;
+      b *= intensity;
+    }
+    image[ 4*cell] = (unsigned char) ( 255.0f*r);
+    image[ 4*cell+1] = (unsigned char) ( 255.0f*g);
+    image[ 4*cell+2] = (unsigned char) ( 255.0f*b);
+    image[ 4*cell+3] = 255;
+  }
+
+  // Textures are allocated with power-of-two sizes and partly filled
+  if( level->texture == 0) {
+    if( !free_textures_.empty()) {
+      level->texture = free_textures_.back();
+      free_textures_.pop_back();
+    }
+    else glGenTextures( 1, &level->texture);
+  }
+  int texture_w = 1, texture_h = 1;
+  while( texture_w < spec.nx) texture_w *= 2;
+  while( texture_h < spec.ny) texture_h *= 2;
+
+  glBindTexture( GL_TEXTURE_2D, level->texture);
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glPixelStorei( GL_UNPACK_ALIGNMENT, 1);
+  if( texture_w != level->texture_w || texture_h != level->texture_h) {
+    glTexImage2D(
+      GL_TEXTURE_2D, 0, GL_RGBA, texture_w, texture_h, 0,
+      GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    level->texture_w = texture_w;
+    level->texture_h = texture_h;
+  }
+  glTexSubImage2D(
+    GL_TEXTURE_2D, 0, 0, 0, spec.nx, spec.ny,
+    GL_RGBA, GL_UNSIGNED_BYTE, &image[0]);
+  level->texture_key = key;
+}
+
+//***************************************************************************
+// Density_Renderer::draw( *pw, style, xmin, xmax, ymin, ymax) -- Draw the
+// density of pw's points for a view of [xmin,xmax] x [ymin,ymax], and ask
+// for any levels the view needs.  Must be called from pw's draw() method.
+void Density_Renderer::draw(
+  Plot_Window *pw, int style,
+  float xmin, float xmax, float ymin, float ymax)
+{
+  pw_ = pw;
+  int kind = KIND_COUNT;
+  if( style == Control_Panel_Window::DENSITY_BRUSHES_LOG ||
+      style == Control_Panel_Window::DENSITY_BRUSHES_EQUALIZED)
+    kind = KIND_BRUSHES;
+  else if( style == Control_Panel_Window::DENSITY_MEAN_Z) kind = KIND_MEAN_Z;
+
+  // Levels of another quantity, or of other vertices, are of no use
+  if( kind != kind_ || pw->vertex_source != vertices_ || npoints != npoints_) {
+    data_changed();
+    kind_ = kind;
+    vertices_ = pw->vertex_source;
+    npoints_ = npoints;
+  }
+  collect();
+
+  // Textures made in contexts that are gone must be made again
+  if( textures_epoch_ != Column_Buffers::epoch()) {
+    free_textures_.clear();
+    for( unsigned int i=0; i<levels_.size(); i++) {
+      levels_[i]->texture = 0;
+      levels_[i]->texture_w = levels_[i]->texture_h = 0;
+      levels_[i]->texture_key.clear();
+    }
+    textures_epoch_ = Column_Buffers::epoch();
+  }
+  if( npoints_ <= 0) return;
+
+  // Level zero covers the data's bounding box at window resolution, padded
+  // a little so points on its far edges fall inside
+  float bxmin = pw->amin[0], bxmax = pw->amax[0];
+  float bymin = pw->amin[1], bymax = pw->amax[1];
+  if( !( bxmax > bxmin)) { bxmin -= 0.5; bxmax += 0.5;}
+  if( !( bymax > bymin)) { bymin -= 0.5; bymax += 0.5;}
+  bxmax += 1.0e-5 * ( bxmax - bxmin);
+  bymax += 1.0e-5 * ( bymax - bymin);
+  int nx = pw->w() < max_grid ? pw->w() : max_grid;
+  int ny = pw->h() < max_grid ? pw->h() : max_grid;
+  if( nx < 1 || ny < 1) return;
+  request( bxmin, bxmax, bymin, bymax, nx, ny, 0);
+
+  // Part of the view that holds data, and the cell size it calls for
+  float cxmin = fmaxf( xmin, bxmin), cxmax = fminf( xmax, bxmax);
+  float cymin = fmaxf( ymin, bymin), cymax = fminf( ymax, bymax);
+  if( cxmin >= cxmax || cymin >= cymax) return;
+  float cell_w = ( xmax - xmin) / pw->w();
+  float cell_h = ( ymax - ymin) / pw->h();
+
+  // If no level covers that part finely enough, ask for one with a margin.
+  // Level zero counts even while it is being computed.
+  Spec base;
+  base.xmin = bxmin;
+  base.xmax = bxmax;
+  base.ymin = bymin;
+  base.ymax = bymax;
+  base.nx = nx;
+  base.ny = ny;
+  int covered = covers( base, cxmin, cxmax, cymin, cymax, cell_w, cell_h);
+  for( unsigned int i=0; i<levels_.size() && !covered; i++) {
+    covered = !levels_[i]->stale &&
+      covers( levels_[i]->spec, cxmin, cxmax, cymin, cymax, cell_w, cell_h);
+    if( covered) levels_[i]->last_used = ++use_count_;
+  }
+  if( !covered) {
+    float mx = 0.25 * ( xmax - xmin), my = 0.25 * ( ymax - ymin);
+    float pxmin = fmaxf( xmin - mx, bxmin), pxmax = fminf( xmax + mx, bxmax);
+    float pymin = fmaxf( ymin - my, bymin), pymax = fminf( ymax + my, bymax);
+    int vnx = (int) ceilf( ( pxmax - pxmin) / cell_w);
+    int vny = (int) ceilf( ( pymax - pymin) / cell_h);
+    vnx = vnx < 1 ? 1 : ( vnx > max_grid ? max_grid : vnx);
+    vny = vny < 1 ? 1 : ( vny > max_grid ? max_grid : vny);
+    request( pxmin, pxmax, pymin, pymax, vnx, vny, 1);
+  }
+
+  // Draw the levels that overlap the view, finest first.  Each level marks
+  // the stencil buffer where it is drawn, so coarser levels only fill in
+  // around the finer ones.
+  std::vector<Level*> visible;
+  for( unsigned int i=0; i<levels_.size(); i++) {
+    const Spec &spec = levels_[i]->spec;
+    if( spec.xmin < xmax && spec.xmax > xmin &&
+        spec.ymin < ymax && spec.ymax > ymin)
+      visible.push_back( levels_[i]);
+  }
+  std::sort( visible.begin(), visible.end(), finer);
+
+  glDisable( GL_DEPTH_TEST);
+  glEnable( GL_BLEND);
+  glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glClearStencil( 0);
+  glClear( GL_STENCIL_BUFFER_BIT);
+  glEnable( GL_STENCIL_TEST);
+  glStencilFunc( GL_EQUAL, 0, 0xff);
+  glStencilOp( GL_KEEP, GL_KEEP, GL_INCR);
+  glEnable( GL_TEXTURE_2D);
+  glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+  for( unsigned int i=0; i<visible.size(); i++) {
+    Level *level = visible[i];
+    const Spec &spec = level->spec;
+    build_texture( pw, level, style);
+    glBindTexture( GL_TEXTURE_2D, level->texture);
+    float s1 = spec.nx / (float) level->texture_w;
+    float t1 = spec.ny / (float) level->texture_h;
+    glBegin( GL_QUADS);
+    glTexCoord2f( 0.0, 0.0); glVertex2f( spec.xmin, spec.ymin);
+    glTexCoord2f( s1, 0.0);  glVertex2f( spec.xmax, spec.ymin);
+    glTexCoord2f( s1, t1);   glVertex2f( spec.xmax, spec.ymax);
+    glTexCoord2f( 0.0, t1);  glVertex2f( spec.xmin, spec.ymax);
+    glEnd();
+  }
+
+  glBindTexture( GL_TEXTURE_2D, 0);
+  glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+  glDisable( GL_TEXTURE_2D);
+  glDisable( GL_STENCIL_TEST);
+}
@@ -0,0 +1,214 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: density_renderer.h
+//
+// Class definitions:
+//   Density_Renderer -- Draw a plot as binned 2D point density
+//
+// Classes referenced:
+//   Plot_Window -- Source of vertices and view, and owner of the GL context
+//   Worker_Pool -- Runs the binning passes
+//   Brush -- Colors for per-brush density
+//
+// Required packages
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Replace point rendering with a screen-resolution grid of counts
+//   for plots with too many points to draw individually.  Cells can show
+//   the total count, a blend of brush colors weighted by per-brush counts,
+//   or the mean z of their points, through a log or equalized color map.
+//
+// General design philosophy:
+//   1) A grid ("level") covers a rectangle of the plot's x-y plane.  Level
+//      zero covers all the data at window resolution.  Further levels are
+//      made for zoomed views, with some margin so that small pans don't
+//      need a new one.  Each level is drawn as a single textured quad.
+//   2) Levels are binned on the worker pool, off the main thread, in a
+//      parallel pass over the vertices with per-chunk grids that are summed
+//      at the end.  Requests for views are latest-wins: a zoomed view that
+//      is already out of date is abandoned.
+//   3) Levels are only recomputed when the view, the axes, or the window
+//      size change.  Until a finer level is ready, the ones already
+//      computed are drawn, finest on top, so a zoom shows a coarser
+//      version of the same view immediately.
+//   4) Per-brush levels are updated from the points whose brush changed in
+//      the last gather, so brushing doesn't require rebinning.
+//   5) Levels are kept while density is turned off, and only discarded
+//      when the vertices change.  The textures of discarded levels are
+//      reused by new ones, and deleted after the plot's next draw, while
+//      its context is current.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef DENSITY_RENDERER_H
+#define DENSITY_RENDERER_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "vertex_source.h"
+
+// Declare class Plot_Window so it can be used for arguments
+class Plot_Window;
+
+//***************************************************************************
+// Class: Density_Renderer
+//
+// Class definitions:
+//   Density_Renderer -- Draw a plot as binned 2D point density
+//
+// Classes referenced:
+//   Plot_Window, Worker_Pool, Brush
+//
+// Purpose: Maintain the density levels of one plot window and draw them.
+//
+// Functions:
+//   Density_Renderer() -- Constructor
+//   ~Density_Renderer() -- Destructor
+//
+//   draw( *pw, style, xmin, xmax, ymin, ymax) -- Draw density in a view
+//   data_changed() -- Discard levels because the vertices changed
+//   free_textures() -- Delete the textures of discarded levels
+//   wait() -- Wait until no binning pass is running
+//   update_from_selection_delta() -- Move points between brushes
+//
+//   request( xmin, xmax, ymin, ymax, nx, ny, abortable) -- Queue a level
+//   collect() -- Take completed levels from the worker
+//   bin( spec, generation) -- Binning pass for one level
+//   build_texture( *pw, *level, style) -- Color map a level into its texture
+//   release( *level) -- Delete a level, keeping its texture to reuse or free
+//   clear_levels() -- Release all levels
+//
+// Static functions:
+//   same_spec( a, b) -- Do two specs describe the same grid?
+//   covers( spec, xmin, xmax, ymin, ymax, cell_w, cell_h) -- Fine enough?
+//   finer( *a, *b) -- Ordering of levels by cell size
+//   bin_chunk( begin, end, ichunk, *data) -- Body of the binning pass
+//   sum_chunk( begin, end, ichunk, *data) -- Sum the per-chunk grids
+//   run_job( *data) -- Body of the worker job
+//   timeout_cb( *data) -- Install completed levels and redraw
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Density_Renderer
+{
+  public:
+    // Quantity to aggregate per cell, and color map
+    enum density_kinds { KIND_COUNT=0, KIND_BRUSHES, KIND_MEAN_Z};
+
+    // Largest grid dimension, number of levels kept, points binned between
+    // checks for newer requests, and memory allowed for per-chunk grids
+    static const int max_grid = 2048;
+    static const int max_levels = 6;
+    static const int block_size = 65536;
+    static const long partial_budget = 256L*1024*1024;
+
+    // Seconds between checks for completed levels
+    static const double poll_interval;
+
+  protected:
+    // What to bin, and where
+    struct Spec {
+      float xmin, xmax, ymin, ymax;
+      int nx, ny;
+      int kind;
+      int abortable;
+      int generation;
+      const int *codes;
+    };
+
+    // A grid of cells.  planes holds nplanes grids of nx*ny floats: the
+    // count, the count of each brush, or the count and the sum of z.
+    struct Level {
+      Spec spec;
+      int nplanes;
+      std::vector<float> planes;
+      int stale;
+      int last_used;
+
+      // Totals, sorted, for the equalized color map, and the largest one
+      std::vector<float> sorted_totals;
+      float max_total;
+
+      // Texture and the colors it was made with
+      GLuint texture;
+      int texture_w, texture_h;
+      std::vector<float> texture_key;
+    };
+    std::vector<Level*> levels_;
+    std::vector<GLuint> free_textures_;
+    int textures_epoch_;
+    int use_count_;
+
+    // Vertices the levels describe
+    Vertex_Source vertices_;
+    int npoints_;
+    int kind_;
+
+    // Arguments and per-chunk grids for the parallel passes
+    struct Pass {
+      Density_Renderer *owner;
+      Spec spec;
+      int generation;
+      int nplanes;
+      int ncells;
+      std::vector<float> partial;
+      int nparts;
+      volatile int aborted;
+    };
+
+    // Work shared with the worker job, guarded by mutex_
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+    std::deque<Spec> pending_;
+    Spec running_spec_;
+    std::vector<Level*> finished_;
+    volatile int request_generation_;
+    volatile int running_;
+    volatile int cancel_;
+    int polling_;
+    Plot_Window *pw_;
+
+    int request(
+      float xmin, float xmax, float ymin, float ymax,
+      int nx, int ny, int abortable);
+    int collect();
+    Level *bin( const Spec &spec, int generation);
+    void build_texture( Plot_Window *pw, Level *level, int style);
+    void release( Level *level);
+    void clear_levels();
+
+    static int same_spec( const Spec &a, const Spec &b);
+    static int covers(
+      const Spec &spec, float xmin, float xmax, float ymin, float ymax,
+      float cell_w, float cell_h);
+    static bool finer( const Level *a, const Level *b);
+    static void bin_chunk( int begin, int end, int ichunk, void *data);
+    static void sum_chunk( int begin, int end, int ichunk, void *data);
+    static void run_job( void *data);
+    static void timeout_cb( void *data);
+
+  public:
+    Density_Renderer();
+    ~Density_Renderer();
+
+    void draw(
+      Plot_Window *pw, int style,
+      float xmin, float xmax, float ymin, float ymax);
+    void data_changed();
+    void free_textures();
+    void wait();
+    void update_from_selection_delta();
+};
+
+#endif   // DENSITY_RENDERER_H
@@ -0,0 +1,142 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: frame_scheduler.cpp
+//
+// Class definitions:
+//   Frame_Scheduler -- Decide when plots are drawn
+//
+// Classes referenced:
+//   Plot_Window -- Records why it needs to be drawn again
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <frame_scheduler.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "frame_scheduler.h"
+#include "plot_window.h"
+#include "control_panel_window.h"
+#include "column_buffers.h"
+#include "matrix_window.h"
+
+// Set static data members for class Frame_Scheduler::
+double Frame_Scheduler::frame_interval = 1.0/60.0;
+const double Frame_Scheduler::spin_share = 0.5;
+const double Frame_Scheduler::max_spin_step = 0.25;
+int Frame_Scheduler::armed_ = 0;
+int Frame_Scheduler::first_ = 0;
+double Frame_Scheduler::last_frame_ = 0.0;
+
+//***************************************************************************
+// Frame_Scheduler::wake( first) -- STATIC method to make sure a frame is
+// coming.  If first is a plot index, that plot is drawn first, because the
+// plot being brushed must update the selection before the others color
+// their points.  The frame starts one frame_interval after the last one,
+// or right away if that time has passed.
+void Frame_Scheduler::wake( int first)
+{
+  if( first >= 0) first_ = first;
+  if( armed_) return;
+  armed_ = 1;
+  double delay = last_frame_ + frame_interval - Point_Sampler::now();
+  if( delay < 0.0) delay = 0.0;
+  Fl::add_timeout( delay, timeout_cb);
+}
+
+//***************************************************************************
+// Frame_Scheduler::draw_frame() -- STATIC method to redraw every plot that
+// needs it, cyclically starting with the first plot, recomputing histograms
+// unless only the view changed.  Spinning plots need it once their spin
+// interval has passed.  In matrix mode the plots are cells of one window,
+// which draws only their cells.  The last frame's uploads are reported
+// before this one's are made.
+void Frame_Scheduler::draw_frame()
+{
+  last_frame_ = Point_Sampler::now();
+  Column_Buffers::report_uploads();
+  upload_buffers();
+
+  int p = first_;
+  if( p < 0 || p >= nplots) p = 0;
+  first_ = 0;
+  int nspinning = spinning();
+  for( int i=0; i<nplots; i++) {
+    Plot_Window *pw = pws[ (p+i)%nplots];
+    if( pw->cp->spin->value() && last_frame_ >= pw->next_spin) {
+      pw->needs_redraw |= REDRAW_VIEW;
+      pw->next_spin =
+        last_frame_ +
+        max( frame_interval, nspinning * pw->draw_seconds / spin_share);
+    }
+    if( pw->needs_redraw == 0) continue;
+    if( pw->needs_redraw & ~( REDRAW_VIEW | REDRAW_PROGRESS))
+      pw->compute_histograms();
+    if( matrix_window != NULL) matrix_window->redraw_cell( (p+i)%nplots);
+    else pw->redraw();
+    pw->needs_redraw = 0;
+  }
+
+  // R100_FIXES: Fix for WIN32 'slow-handler' bug.
+  #ifdef __WIN32__
+    Fl::flush();
+  #endif // __WIN32__
+}
+
+//***************************************************************************
+// Frame_Scheduler::timeout_cb( *data) -- STATIC callback for the frame
+// timeout.  Draw the frame, and keep going only while a plot spins.
+void Frame_Scheduler::timeout_cb( void *data)
+{
+  armed_ = 0;
+  draw_frame();
+  if( spinning()) wake();
+}
+
+//***************************************************************************
+// Frame_Scheduler::upload_buffers() -- STATIC method to make the uploads
+// that the plots waiting to be drawn need, in the context of the matrix
+// window or of the first of them that is shown, since buffers are shared
+// by every context.  Headless plots, and plots drawn only because their
+// window was exposed, upload in draw().
+void Frame_Scheduler::upload_buffers()
+{
+  if( !use_VBOs || headless_mode) return;
+  Fl_Gl_Window *window = matrix_window;
+  for( int i=0; i<nplots && window == NULL; i++)
+    if( pws[i]->needs_redraw && pws[i]->shown()) window = pws[i];
+  if( window == NULL || !window->shown()) return;
+  window->make_current();
+
+  for( int i=0; i<nplots; i++)
+    if( pws[i]->needs_redraw) pws[i]->upload_buffers();
+  if( Column_Buffers::available() &&
+      Plot_Window::gathered_selection.rows() > 0)
+    Column_Buffers::update_brush_ids();
+  glBindBuffer( GL_ARRAY_BUFFER, 0);
+  glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+//***************************************************************************
+// Frame_Scheduler::spinning() -- STATIC method to count the plots that
+// are spinning.
+int Frame_Scheduler::spinning()
+{
+  int nspinning = 0;
+  for( int i=0; i<nplots; i++)
+    if( pws[i]->cp->spin->value()) nspinning++;
+  return nspinning;
+}
@@ -0,0 +1,119 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: frame_scheduler.h
+//
+// Class definitions:
+//   Frame_Scheduler -- Decide when plots are drawn
+//
+// Classes referenced:
+//   Plot_Window -- Records why it needs to be drawn again
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Replace the timer that polled every plot a hundred times a
+//   second.  Plots are drawn when something has changed, at most once per
+//   frame, and nothing runs while nothing changes.
+//
+// General design philosophy:
+//   1) A plot that needs to be drawn again records why in needs_redraw, a
+//      set of reasons: its data, the selection, its view, or decorations
+//      such as the background, grid, or histogram settings.  It then wakes
+//      the scheduler.
+//   2) The first wake arms a single FLTK timeout for the next frame.
+//      Frames are at least frame_interval apart, so any number of changes
+//      between them, such as the events of a mouse drag, become one redraw
+//      of each plot.  When drawing takes longer than a frame, the next
+//      frame starts as soon as the event loop has handled pending events.
+//   3) Only a spinning plot keeps the timeout armed.  Otherwise the event
+//      loop sleeps until the next event.
+//   4) Histograms are recomputed for every reason except a change of view
+//      or the next frame of a plot drawn progressively, which leave them as
+//      they were.
+//   5) Spinning plots are drawn no more often than lets them all together
+//      spend spin_share of the time drawing, going by how long each one's
+//      last draw took, so the event loop and other plots keep up however
+//      many points spin.  Since draw() returns once the GPU has been given
+//      its work, a draw takes the longer of its time on the CPU and the
+//      time its points took on the GPU, as measured by the plot's
+//      Point_Sampler.  A plot turns by the time since it was last drawn,
+//      so it spins at the same speed however often that is, and not at
+//      all on the frame it starts spinning.
+//   6) Everything the plots of a frame draw from is uploaded at the start
+//      of the frame, in one context, before any of them draws.  GPU
+//      buffers are shared by all contexts, so each plot's draw() then
+//      finds its buffers up to date and only draws.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Frame_Scheduler
+//
+// Class definitions:
+//   Frame_Scheduler -- Decide when plots are drawn
+//
+// Classes referenced:
+//   Plot_Window -- Draws itself when told to
+//
+// Purpose: Static timer that coalesces requests to draw plots into frames.
+//
+// Functions:
+//   wake( first) -- Make sure a frame is coming, drawing plot first first
+//   draw_frame() -- Draw every plot that needs it
+//
+//   timeout_cb( *data) -- Draw a frame, and arm another if plots spin
+//   upload_buffers() -- Upload what the plots of this frame draw from
+//   spinning() -- Number of plots spinning
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Frame_Scheduler
+{
+  public:
+    // Why a plot needs to be drawn again
+    enum Reason {
+      REDRAW_DATA = 1,
+      REDRAW_SELECTION = 2,
+      REDRAW_VIEW = 4,
+      REDRAW_DECORATION = 8,
+      REDRAW_PROGRESS = 16
+    };
+
+    // Shortest time between frames, in seconds.  FLTK can't wait for the
+    // display's refresh, so this is a typical refresh period.
+    static double frame_interval;
+
+    // Largest fraction of the time that spinning plots may spend drawing,
+    // and longest time, in seconds, that one turn of a spin makes up for
+    static const double spin_share;
+    static const double max_spin_step;
+
+  protected:
+    static int armed_;
+    static int first_;
+    static double last_frame_;
+
+    static void timeout_cb( void *data);
+    static void upload_buffers();
+    static int spinning();
+
+  public:
+    static void wake( int first = -1);
+    static void draw_frame();
+};
+
+#endif   // FRAME_SCHEDULER_H
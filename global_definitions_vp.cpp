@@ -38,6 +38,12 @@
 // confirmation window.  Result of 1,0,-1 => Yes, No, Cancel.
 int make_confirmation_window( const char* text, int nButtons, int nLines)
 {
+  // Without a display, report the text and answer No (or OK)
+  if( headless_mode) {
+    cerr << text << endl;
+    return 0;
+  }
+
   // Destroy any existing window
   // MCL XXX rule #2: "Compile cleanly at high warning levels." 
   if( confirmation_window != NULL) confirmation_window->hide();
@@ -133,9 +139,16 @@ float pow2( float x)
 }
 
 //***************************************************************************
-// make_find_window( text, result) -- Make and manage the text search 
-// window.  Ignore return value, use non-empty res parameter as outcome.
-int make_find_window( const char* text, char *res)
+// make_find_window( text, result, match_mode, preview_cb, preview_data) -- 
+// Make and manage the text search window.  Ignore return value, use 
+// non-empty res parameter as outcome.  If match_mode is supplied, offer a
+// menu of match modes and use it to return the selected mode.  If 
+// preview_cb is supplied, invoke it with the current text and mode every 
+// time either one changes, so the caller can show the results as the user 
+// types.
+int make_find_window( 
+  const char* text, char *res, int *match_mode,
+  void (*preview_cb)( const char*, int, void*), void *preview_data)
 {
   // Destroy any existing window
   if( find_window != NULL) find_window->hide();
@@ -168,6 +181,21 @@ int make_find_window( const char* text, char *res)
   Fl_Button* cancel_button = new Fl_Button( 150, nHeight-20, 60, 25, "&Cancel");
   Fl_Input* inp = new Fl_Input(60, 30, 140, 30, "Text:");
 
+  // If a preview was requested, report every keystroke
+  if( preview_cb != NULL) inp->when( FL_WHEN_CHANGED);
+
+  // Define menu of match modes.  Order must match Column_Info::match_modes
+  Fl_Choice* mode_choice = (Fl_Choice*) NULL;
+  if( match_mode != NULL) {
+    mode_choice = new Fl_Choice( 260, 30, 100, 30, "Match:");
+    mode_choice->add( "substring");
+    mode_choice->add( "prefix");
+    mode_choice->add( "exact");
+    mode_choice->add( "regex");
+    mode_choice->value( *match_mode);
+    mode_choice->tooltip( "How the text is matched (case sensitive)");
+  }
+
   Fl::focus(inp);
 
   // 'modal' to prevent events from being delivered to the other windows.
@@ -183,6 +211,7 @@ int make_find_window( const char* text, char *res)
     if(Fl::event_key(FL_Enter)) {
       find_window->hide();
       strcpy(res,inp->value());
+      if( mode_choice != NULL) *match_mode = mode_choice->value();
       return 1;    
     }
 
@@ -191,10 +220,20 @@ int make_find_window( const char* text, char *res)
       // o->tooltip( "Search for string (case sensitive)");
       if( !o) break;
 
+      // Has the text or match mode changed?
+      if( o == inp || (mode_choice != NULL && o == mode_choice)) {
+        if( preview_cb != NULL)
+          (*preview_cb)(
+            inp->value(), 
+            mode_choice != NULL ? mode_choice->value() : 0, 
+            preview_data);
+      }
+
       // Has the window been closed or a button been pushed?
-      if( o == yes_button) {
+      else if( o == yes_button) {
         find_window->hide();
         strcpy(res,inp->value());
+        if( mode_choice != NULL) *match_mode = mode_choice->value();
         return 1;
       }
       else if( o == cancel_button) {
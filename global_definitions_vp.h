@@ -84,6 +84,15 @@ GLOBAL bool preserve_old_data_mode INIT(true);
 GLOBAL bool laptop_mode INIT(false);
 GLOBAL bool be_verbose INIT(false);
 GLOBAL bool update_on_mouse_up INIT(true);
+GLOBAL bool async_selection INIT(true);
+GLOBAL bool simplify_while_interacting INIT(true);
+GLOBAL bool progressive_rendering INIT(true);
+
+// Render plots to image files without a display (see Headless_Renderer)
+GLOBAL bool headless_mode INIT(false);
+
+// Draw all plots as the cells of one window (see Matrix_Window)
+GLOBAL bool matrix_mode INIT(false);
 
 // Define blitz::Arrays to hold raw and ranked (sorted) data arrays.  Used 
 // extensively in many classes, so for reasons of simplicity and clarity, 
@@ -149,10 +158,36 @@ GLOBAL Fl_Button *read_data_button;
 class Data_File_Manager;
 GLOBAL Data_File_Manager *pdfm;
 
+// Define pool of worker threads for background and parallel computations
+// (must use pointer with incomplete def'n)
+class Worker_Pool;
+GLOBAL Worker_Pool *worker_pool INIT(NULL);
+
+// Define object to maintain live per-brush statistics
+class Brush_Statistics;
+GLOBAL Brush_Statistics *brush_statistics INIT(NULL);
+
+// Define object to maintain live histograms of every column
+class Column_Profile;
+GLOBAL Column_Profile *column_profile INIT(NULL);
+
+// Define object to hold the selection history for undo/redo
+class Selection_History;
+GLOBAL Selection_History *selection_history INIT(NULL);
+
+// Define object to evaluate selections on a worker thread while dragging
+class Selection_Worker;
+GLOBAL Selection_Worker *selection_worker INIT(NULL);
+
+// Define object to combine brushes with set operations
+class Brush_Algebra;
+GLOBAL Brush_Algebra *brush_algebra INIT(NULL);
+
 // Declare classes Control_Panel_Window and Plot_Window here so they can be 
 // referenced
 class Control_Panel_Window;
 class Plot_Window;
+class Matrix_Window;
 class Brush; 
 
 // Define pointer arrays of plot windows and control panel windows.  This 
@@ -161,6 +196,9 @@ class Brush;
 // <vector> container class.
 GLOBAL Plot_Window *pws[ MAXPLOTS];
 
+// In matrix mode, the one window that draws every plot
+GLOBAL Matrix_Window *matrix_window INIT(NULL);
+
 // There is one extra Control_Panel_Window, with index=MAXPLOTS.  It has no 
 // associated plot window - it affects all (unlocked) plots.
 GLOBAL Control_Panel_Window *cps[ MAXPLOTS+1]; 
@@ -208,7 +246,10 @@ GLOBAL gsl_rng *vp_gsl_rng;
 
 // Global function definitions
 GLOBAL int make_confirmation_window( const char* text, int nButtons = 3, int nLines = 2);
-GLOBAL int make_find_window( const char* text, char *res);
+GLOBAL int make_find_window( 
+  const char* text, char *res, int *match_mode = NULL,
+  void (*preview_cb)( const char*, int, void*) = NULL, 
+  void *preview_data = NULL);
 GLOBAL void shrink_widget_fonts( Fl_Widget* target_widget, float rScale);
 GLOBAL void reset_selection_arrays();
 
@@ -0,0 +1,343 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: headless_renderer.cpp
+//
+// Class definitions:
+//   Headless_Renderer -- Render plots to PNG files without a display
+//
+// Classes referenced:
+//   Plot_Window -- Draws each plot
+//   Control_Panel_Window -- Chooses the axes of each pair of columns
+//
+// Required packages
+//    OGLEXP 1.2.2 -- Access to OpenGL extension under Windows
+//    EGL -- Creates GL contexts without a window system (DVP_HEADLESS only)
+//    zlib -- Compresses the PNG files (DVP_HEADLESS only)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//   Requires DVP_HEADLESS, else render() reports an error
+//
+// Purpose: Source code for <headless_renderer.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "headless_renderer.h"
+#include "plot_window.h"
+#include "control_panel_window.h"
+#include "data_file_manager.h"
+#include "worker_pool.h"
+#include "selection_worker.h"
+
+#ifdef VP_HEADLESS
+  #include <sys/wait.h>
+  #include <errno.h>
+  #include <string.h>
+  #include <zlib.h>
+  #include <EGL/egl.h>
+  #include <EGL/eglext.h>
+  #ifndef EGL_PLATFORM_SURFACELESS_MESA
+    #define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+  #endif // EGL_PLATFORM_SURFACELESS_MESA
+#endif // VP_HEADLESS
+
+//***************************************************************************
+// Headless_Renderer::render( directory, style) -- Render every plot, or
+// every pair of columns, to PNG files in directory.  Images are divided
+// among one forked process per processor.  Returns the number of images
+// that could not be written.
+int Headless_Renderer::render( const std::string &directory, int style)
+{
+#ifdef VP_HEADLESS
+  if( mkdir( directory.c_str(), 0777) != 0 && errno != EEXIST) {
+    cerr << "Headless_Renderer::render: ERROR, can't create directory "
+         << directory << endl;
+    return 1;
+  }
+
+  int n = njobs( style);
+  int nprocesses = Worker_Pool::number_of_processors();
+  if( nprocesses > n) nprocesses = n;
+  cout << "Headless_Renderer::render: rendering " << n << " images with "
+       << nprocesses << " processes" << endl;
+
+  // Background jobs must not be running when the processes are forked, and
+  // output must be flushed so it isn't written twice
+  if( selection_worker != NULL) selection_worker->finish();
+  if( worker_pool != NULL) worker_pool->wait_idle();
+  cout.flush();
+  cerr.flush();
+  fflush( NULL);
+
+  // Loop: Fork the processes.  Process i renders images i, i+nprocesses,
+  // and so on, and reports how many it couldn't write.
+  std::vector<pid_t> pids;
+  int nfailed = 0;
+  for( int i=0; i<nprocesses; i++) {
+    pid_t pid = fork();
+    if( pid == 0) {
+      worker_pool = NULL;
+      int nbad = 0;
+      if( make_context() != 0) nbad = n;
+      else {
+        for( int job=i; job<n; job+=nprocesses)
+          nbad += render_job( job, style, directory);
+      }
+      cout.flush();
+      cerr.flush();
+      _exit( nbad > 255 ? 255 : nbad);
+    }
+    if( pid < 0) {
+      cerr << "Headless_Renderer::render: ERROR, can't fork process " << i
+           << endl;
+      for( int job=i; job<n; job+=nprocesses) nfailed++;
+    }
+    else pids.push_back( pid);
+  }
+
+  // Wait for the processes to finish
+  for( unsigned int i=0; i<pids.size(); i++) {
+    int status;
+    if( waitpid( pids[i], &status, 0) != pids[i]) nfailed++;
+    else if( !WIFEXITED( status)) nfailed++;
+    else nfailed += WEXITSTATUS( status);
+  }
+  if( nfailed > 0)
+    cerr << "Headless_Renderer::render: WARNING, " << nfailed
+         << " images were not written" << endl;
+  return nfailed;
+#else
+  cerr << "Headless_Renderer::render: ERROR, headless mode was not built.  "
+       << "On Linux, build with \"make HEADLESS=1\"" << endl;
+  return 1;
+#endif // VP_HEADLESS
+}
+
+//***************************************************************************
+// Headless_Renderer::njobs( style) -- Number of images to render: one per
+// plot, or one per pair of columns.
+int Headless_Renderer::njobs( int style)
+{
+  if( style == RENDER_PAIRS) return nvars*(nvars-1)/2;
+  return nplots;
+}
+
+//***************************************************************************
+// Headless_Renderer::render_job( job, style, directory) -- Draw one image
+// into a framebuffer object the size of its plot window, read it back, and
+// write it.  For pairs, the first plot's axes are changed to the pair and
+// its data extracted again, which only affects this process's copy.
+// Returns 0 on success, 1 on failure.
+int Headless_Renderer::render_job(
+  int job, int style, const std::string &directory)
+{
+#ifdef VP_HEADLESS
+  Plot_Window *pw = pws[ job];
+  char name[ 64];
+  snprintf( name, sizeof( name), "plot_%02d.png", job+1);
+
+  // Find the pair of columns by walking the upper triangle row by row
+  if( style == RENDER_PAIRS) {
+    int ivar = 0, jvar = 1, k = job;
+    while( k >= nvars-1-ivar) {
+      k -= nvars-1-ivar;
+      ivar++;
+    }
+    jvar = ivar+1+k;
+    pw = pws[ 0];
+    pw->cp->varindex1->value( ivar);
+    pw->cp->varindex2->value( jvar);
+    pw->cp->varindex3->value( nvars);
+    pw->extract_data_points();
+    snprintf( name, sizeof( name), "pair_%03d_%03d.png", ivar, jvar);
+  }
+  int width = pw->w(), height = pw->h();
+  if( width <= 0 || height <= 0) return 1;
+
+  // Make a framebuffer with every plane a plot window would have
+  GLuint framebuffer, renderbuffers[ 2];
+  glGenFramebuffers( 1, &framebuffer);
+  glBindFramebuffer( GL_FRAMEBUFFER, framebuffer);
+  glGenRenderbuffers( 2, renderbuffers);
+  glBindRenderbuffer( GL_RENDERBUFFER, renderbuffers[ 0]);
+  glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glFramebufferRenderbuffer(
+    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[ 0]);
+  glBindRenderbuffer( GL_RENDERBUFFER, renderbuffers[ 1]);
+  glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  glFramebufferRenderbuffer(
+    GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+    renderbuffers[ 1]);
+
+  int result = 1;
+  if( glCheckFramebufferStatus( GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    cerr << "Headless_Renderer::render_job: ERROR, incomplete framebuffer "
+         << "for " << name << endl;
+  }
+  else {
+    pw->render_offscreen();
+
+    // Read the image back.  GL rows run bottom to top, PNG rows top to
+    // bottom.
+    std::vector<unsigned char> pixels( 3*width*height);
+    std::vector<unsigned char> flipped( 3*width*height);
+    glPixelStorei( GL_PACK_ALIGNMENT, 1);
+    glReadPixels( 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+    for( int row=0; row<height; row++)
+      memcpy(
+        &flipped[ 3*width*row], &pixels[ 3*width*(height-1-row)], 3*width);
+
+    string path = directory + "/" + name;
+    result = write_png( path, width, height, &flipped[0]);
+    if( result == 0) {
+      cout << "Headless_Renderer: wrote " << path << " ("
+           << pw->xlabel << " vs " << pw->ylabel << ")" << endl;
+    }
+  }
+
+  glBindFramebuffer( GL_FRAMEBUFFER, 0);
+  glDeleteRenderbuffers( 2, renderbuffers);
+  glDeleteFramebuffers( 1, &framebuffer);
+  return result;
+#else
+  return 1;
+#endif // VP_HEADLESS
+}
+
+//***************************************************************************
+// Headless_Renderer::make_context() -- Make a GL context current without a
+// window system, using Mesa's surfaceless EGL platform if it's available
+// and the default display otherwise.  There is no default framebuffer, so
+// everything is drawn into framebuffer objects.  Returns 0 on success.
+int Headless_Renderer::make_context()
+{
+#ifdef VP_HEADLESS
+  EGLDisplay display = EGL_NO_DISPLAY;
+  const char *extensions = eglQueryString( EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if( extensions != NULL &&
+      strstr( extensions, "EGL_MESA_platform_surfaceless") != NULL) {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress( "eglGetPlatformDisplayEXT");
+    if( get_platform_display != NULL)
+      display = get_platform_display(
+        EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+  }
+  if( display == EGL_NO_DISPLAY) display = eglGetDisplay( EGL_DEFAULT_DISPLAY);
+
+  EGLint major, minor;
+  if( display == EGL_NO_DISPLAY || !eglInitialize( display, &major, &minor)) {
+    cerr << "Headless_Renderer::make_context: ERROR, no EGL display" << endl;
+    return 1;
+  }
+  if( !eglBindAPI( EGL_OPENGL_API)) {
+    cerr << "Headless_Renderer::make_context: ERROR, EGL can't make "
+         << "OpenGL contexts" << endl;
+    return 1;
+  }
+
+  // The default surface type is a window, which surfaceless displays lack
+  const EGLint attributes[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+    EGL_NONE
+  };
+  EGLConfig config;
+  EGLint nconfigs = 0;
+  if( !eglChooseConfig( display, attributes, &config, 1, &nconfigs) ||
+      nconfigs < 1) {
+    cerr << "Headless_Renderer::make_context: ERROR, no EGL config" << endl;
+    return 1;
+  }
+  EGLContext context =
+    eglCreateContext( display, config, EGL_NO_CONTEXT, NULL);
+  if( context == EGL_NO_CONTEXT ||
+      !eglMakeCurrent( display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    cerr << "Headless_Renderer::make_context: ERROR, can't make a "
+         << "surfaceless GL context" << endl;
+    return 1;
+  }
+  if( be_verbose)
+    cout << "Headless_Renderer::make_context: EGL " << major << "." << minor
+         << ", " << glGetString( GL_RENDERER) << ", GL "
+         << glGetString( GL_VERSION) << endl;
+  return 0;
+#else
+  return 1;
+#endif // VP_HEADLESS
+}
+
+//***************************************************************************
+// Headless_Renderer::write_png( path, width, height, *rgb) -- Write an
+// 8-bit RGB image, stored top row first, as a PNG file.  Returns 0 on
+// success.
+int Headless_Renderer::write_png(
+  const std::string &path, int width, int height, const unsigned char *rgb)
+{
+#ifdef VP_HEADLESS
+  // Every row of PNG image data starts with its filter type, here none
+  std::vector<unsigned char> raw( (3*width+1)*height);
+  for( int row=0; row<height; row++) {
+    raw[ (3*width+1)*row] = 0;
+    memcpy( &raw[ (3*width+1)*row+1], &rgb[ 3*width*row], 3*width);
+  }
+  uLongf zsize = compressBound( raw.size());
+  std::vector<unsigned char> zdata( zsize);
+  if( compress2( &zdata[0], &zsize, &raw[0], raw.size(), 6) != Z_OK) {
+    cerr << "Headless_Renderer::write_png: ERROR, can't compress "
+         << path << endl;
+    return 1;
+  }
+
+  // A chunk is its length, its type, its data, and the CRC of the type
+  // and data.  Multi-byte values are big endian.
+  std::string png( "\x89PNG\r\n\x1a\n", 8);
+  unsigned char header[ 13] = {
+    (unsigned char) (width >> 24), (unsigned char) (width >> 16),
+    (unsigned char) (width >> 8), (unsigned char) width,
+    (unsigned char) (height >> 24), (unsigned char) (height >> 16),
+    (unsigned char) (height >> 8), (unsigned char) height,
+    8, 2, 0, 0, 0 };   // 8 bits, RGB, deflate, no filter, no interlace
+  const char *types[ 3] = { "IHDR", "IDAT", "IEND"};
+  const unsigned char *data[ 3] = { header, &zdata[0], NULL};
+  unsigned long sizes[ 3] = { sizeof( header), zsize, 0};
+  for( int i=0; i<3; i++) {
+    unsigned long size = sizes[ i];
+    png += (char) (size >> 24);
+    png += (char) (size >> 16);
+    png += (char) (size >> 8);
+    png += (char) size;
+    png.append( types[ i], 4);
+    if( size > 0) png.append( (const char *) data[ i], size);
+    unsigned long crc = crc32( 0L, Z_NULL, 0);
+    crc = crc32( crc, (const Bytef *) types[ i], 4);
+    if( size > 0) crc = crc32( crc, data[ i], size);
+    png += (char) (crc >> 24);
+    png += (char) (crc >> 16);
+    png += (char) (crc >> 8);
+    png += (char) crc;
+  }
+
+  std::ofstream outputFileStream(
+    path.c_str(), std::ios::out | std::ios::binary);
+  outputFileStream.write( png.data(), png.size());
+  if( !outputFileStream.good()) {
+    cerr << "Headless_Renderer::write_png: ERROR, can't write " << path
+         << endl;
+    return 1;
+  }
+  return 0;
+#else
+  return 1;
+#endif // VP_HEADLESS
+}
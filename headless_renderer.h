@@ -0,0 +1,94 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: headless_renderer.h
+//
+// Class definitions:
+//   Headless_Renderer -- Render plots to PNG files without a display
+//
+// Classes referenced:
+//   Plot_Window -- Draws each plot
+//   Control_Panel_Window -- Chooses the axes of each pair of columns
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//   Requires DVP_HEADLESS (set by "make HEADLESS=1" on Linux) and Mesa's
+//   surfaceless EGL platform, else render() reports an error
+//
+// Purpose: Batch mode for viewpoints.  After a data file and a saved
+//   configuration have been loaded, draw each plot window, or every pair of
+//   columns, into an offscreen framebuffer and write it as a PNG file.
+//   Runs on a machine with neither a GPU nor an X server.
+//
+// General design philosophy:
+//   1) Plot windows are never shown.  Each is drawn by its ordinary draw()
+//      method into a framebuffer object of the window's size.
+//   2) Images are rendered in parallel by forked processes, each with its
+//      own surfaceless EGL context and its own copy of the plots.  Plots
+//      share a great deal of static state, so processes are simpler and
+//      safer than threads, and the data and any precomputed columns are
+//      shared copy-on-write.
+//   3) Forked processes have no worker threads, so they run without the
+//      worker pool and every computation that would use it runs inline.
+//   4) FLTK draws GL text with fonts from the display, so headless images
+//      have no axis labels or tick values.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef HEADLESS_RENDERER_H
+#define HEADLESS_RENDERER_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Headless_Renderer
+//
+// Class definitions:
+//   Headless_Renderer -- Render plots to PNG files without a display
+//
+// Classes referenced:
+//   Plot_Window -- Draws each plot
+//
+// Purpose: Static methods that render the plots after the configuration
+//   has been loaded.
+//
+// Functions:
+//   render( directory, style) -- Render every image and wait for them
+//
+//   njobs( style) -- Number of images to render
+//   render_job( job, style, directory) -- Render and write one image
+//   make_context() -- Make a surfaceless GL context current
+//   write_png( path, width, height, *rgb) -- Write an image as a PNG file
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Headless_Renderer
+{
+  public:
+    // What to render: each plot window as configured, or every pair of
+    // columns as the x and y axes of the first plot
+    enum Render_Style {
+      RENDER_PLOTS = 0,
+      RENDER_PAIRS
+    };
+
+    static int render( const std::string &directory, int style);
+
+  protected:
+    static int njobs( int style);
+    static int render_job( int job, int style, const std::string &directory);
+    static int make_context();
+    static int write_png(
+      const std::string &path, int width, int height,
+      const unsigned char *rgb);
+};
+
+#endif   // HEADLESS_RENDERER_H
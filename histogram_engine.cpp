@@ -0,0 +1,375 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: histogram_engine.cpp
+//
+// Class definitions:
+//   Histogram_Engine -- Cached marginal and per-brush histogram counts
+//
+// Classes referenced:
+//   Plot_Window -- Source of selection generations and deltas
+//   Worker_Pool -- Runs the binning passes
+//
+// Required packages
+//    Blitz++ 0.9 -- Various math routines
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <histogram_engine.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "histogram_engine.h"
+#include "worker_pool.h"
+#include "plot_window.h"
+
+//***************************************************************************
+// Histogram_Engine::Histogram_Engine() -- Constructor
+Histogram_Engine::Histogram_Engine() :
+  axis_( 0), weighted_( 0), nbins_( 0), max_bins_( 0),
+  npoints_( 0), amin_( 0.0), amax_( 0.0), scale_range_( 1.0),
+  mode_( BINS_EQUAL_WIDTH), order_( NULL), marginal_valid_( 0),
+  brushes_generation_( -1)
+{}
+
+//***************************************************************************
+// Histogram_Engine::~Histogram_Engine() -- Destructor
+Histogram_Engine::~Histogram_Engine()
+{}
+
+//***************************************************************************
+// Histogram_Engine::invalidate() -- Discard cached counts.  Call this
+// whenever the axis data change.
+void Histogram_Engine::invalidate()
+{
+  marginal_valid_ = 0;
+  brushes_generation_ = -1;
+  own_order_.clear();
+}
+
+//***************************************************************************
+// Histogram_Engine::count_chunk( begin, end, ichunk, *data) -- STATIC body
+// of the binning pass.  Bin points [begin,end) into the partial counts for
+// chunk ichunk, a block at a time.
+void Histogram_Engine::count_chunk( int begin, int end, int ichunk, void *data)
+{
+  Pass *pass = (Pass *) data;
+  Histogram_Engine *h = pass->owner;
+  int nbins = h->nbins_;
+  double *marginal = &(pass->partial[ ichunk*(NBRUSHES+1)*nbins]);
+  double *brush_counts = marginal + nbins;
+  const int *codes = pass->codes;
+  const Vertex_Source &v = h->vertices_;
+  int axis = h->axis_;
+  float amin = h->amin_;
+  float fbins = (float) nbins;
+  float range = h->scale_range_;
+
+  int bins[ block_size];
+  float x[ block_size];
+  for( int base=begin; base<end; base+=block_size) {
+    int n = end - base;
+    if( n > block_size) n = block_size;
+    for( int j=0; j<n; j++) x[j] = v.value( axis, base+j);
+
+    // Compute bins without branches so the loop vectorizes.  Unequal 
+    // bins need a binary search.
+    if( h->mode_ != BINS_EQUAL_WIDTH) {
+      for( int j=0; j<n; j++) bins[j] = h->bin_of( x[j]);
+    }
+    else {
+      for( int j=0; j<n; j++) {
+        int bin = (int) ( fbins * ( ( x[j] - amin) / range));
+        bin = bin < 0 ? 0 : bin;
+        bins[j] = bin > nbins-1 ? nbins-1 : bin;
+      }
+    }
+
+    // Scatter into the marginal and per-brush counts
+    if( !h->weighted_) {
+      for( int j=0; j<n; j++) {
+        if( pass->with_marginal) marginal[ bins[j]] += 1.0;
+        brush_counts[ codes[ base+j]*nbins + bins[j]] += 1.0;
+      }
+    }
+    else {
+      for( int j=0; j<n; j++) {
+        double weight = v.value( 2, base+j);
+        if( pass->with_marginal) marginal[ bins[j]] += weight;
+        brush_counts[ codes[ base+j]*nbins + bins[j]] += weight;
+      }
+    }
+  }
+}
+
+//***************************************************************************
+// Histogram_Engine::count_all( with_marginal) -- Recompute the per-brush
+// counts, and the marginal if requested, in one parallel pass using
+// per-chunk bins that are summed at the end.
+void Histogram_Engine::count_all( int with_marginal)
+{
+  int nslots = (NBRUSHES+1)*nbins_;
+
+  Pass pass;
+  pass.owner = this;
+  pass.with_marginal = with_marginal;
+  pass.codes = selected.data();
+  pass.nchunks = 1;
+
+  // Count the selection as of the last gather, so later deltas apply
+  // cleanly.  If there hasn't been one, count again next time.
+  int generation = -1;
+  if( Plot_Window::gathered_selection.rows() == npoints_) {
+    pass.codes = Plot_Window::gathered_selection.data();
+    generation = Plot_Window::selection_generation;
+  }
+  if( worker_pool != NULL && npoints_ >= 4*block_size)
+    pass.nchunks = 4 * ( worker_pool->nthreads() + 1);
+  pass.partial.assign( pass.nchunks * nslots, 0.0);
+
+  if( pass.nchunks > 1)
+    worker_pool->parallel_for( npoints_, pass.nchunks, count_chunk, (void*) &pass);
+  else if( npoints_ > 0) count_chunk( 0, npoints_, 0, (void*) &pass);
+
+  // Sum the per-chunk counts
+  if( with_marginal) marginal_.assign( nbins_, 0.0);
+  brush_counts_.assign( NBRUSHES*nbins_, 0.0);
+  for( int c=0; c<pass.nchunks; c++) {
+    const double *partial = &(pass.partial[ c*nslots]);
+    if( with_marginal)
+      for( int bin=0; bin<nbins_; bin++) marginal_[ bin] += partial[ bin];
+    for( int k=0; k<NBRUSHES*nbins_; k++)
+      brush_counts_[k] += partial[ nbins_+k];
+  }
+  if( with_marginal) marginal_valid_ = 1;
+  brushes_generation_ = generation;
+}
+
+//***************************************************************************
+// Histogram_Engine::apply_delta() -- Move the points whose brush changed in
+// the last gather from their old brush's counts to their new one's.
+void Histogram_Engine::apply_delta()
+{
+  const std::vector<int> &points = Plot_Window::changed_points;
+  const std::vector<int> &from = Plot_Window::changed_from;
+  for( unsigned int k=0; k<points.size(); k++) {
+    int i = points[k];
+    int bin = bin_of( vertices_.value( axis_, i));
+    double weight = weighted_ ? vertices_.value( 2, i) : 1.0;
+    brush_counts_[ from[k]*nbins_ + bin] -= weight;
+    brush_counts_[ Plot_Window::gathered_selection( i)*nbins_ + bin] += weight;
+  }
+  brushes_generation_ = Plot_Window::selection_generation;
+}
+
+//***************************************************************************
+// Histogram_Engine::bayesian_blocks( max_bins) -- Find edges by Scargle's
+// Bayesian blocks for event data, at most max_bins of them.  Candidate 
+// change points are the edges of fine quantile cells read from the sorted
+// order, so the dynamic program costs O(max_cells^2) whatever the number
+// of points.  Each block's fitness is N log( N/T) for N points in width T.
+// Fitnesses are found once on the worker pool, and each attempt at a prior
+// only adds and compares them.
+void Histogram_Engine::bayesian_blocks( int max_bins)
+{
+  // Quantile cells, with ties merged so every cell has nonzero width
+  int ncells = npoints_ < max_cells ? npoints_ : max_cells;
+  std::vector<float> cell_edges( 1, ranked( 0));
+  std::vector<double> cell_counts;
+  int previous = 0;
+  for( int j=1; j<=ncells; j++) {
+    int r = (int) ( (double) j * npoints_ / ncells);
+    float value = ranked( r < npoints_ ? r : npoints_-1);
+    if( value > cell_edges.back() || j == ncells) {
+      if( value > cell_edges.back() || cell_counts.empty()) {
+        cell_edges.push_back( value);
+        cell_counts.push_back( r - previous);
+      }
+      else cell_counts.back() += r - previous;
+      previous = r;
+    }
+  }
+  int m = cell_counts.size();
+  if( m <= 1 || !( cell_edges[m] > cell_edges[0])) {
+    edges_ = cell_edges;
+    return;
+  }
+
+  // Fitness of the block of cells [i,k] for every i <= k
+  std::vector<double> cumulative( m+1, 0.0);
+  for( int k=0; k<m; k++) cumulative[k+1] = cumulative[k] + cell_counts[k];
+  std::vector<double> fitnesses( m*(m+1)/2);
+  Blocks blocks;
+  blocks.cell_edges = &cell_edges[0];
+  blocks.cumulative = &cumulative[0];
+  blocks.fitness = &fitnesses[0];
+  if( worker_pool != NULL && m >= 64)
+    worker_pool->parallel_for(
+      m, 4 * ( worker_pool->nthreads() + 1), fitness_chunk, (void*) &blocks);
+  else fitness_chunk( 0, m, 0, (void*) &blocks);
+
+  // Dynamic program over the cells: best[k] is the best total fitness of
+  // cells [0,k], and last[k] the first cell of its final block.  Raise the
+  // prior on the number of blocks until there are few enough.
+  double prior = 4.0 - log( 73.53 * 0.05 * pow( (double) npoints_, -0.478));
+  std::vector<double> best( m);
+  std::vector<int> last( m);
+  std::vector<int> starts;
+  for( int attempt=0; attempt<32; attempt++) {
+    for( int k=0; k<m; k++) {
+      const double *row = &fitnesses[ k*(k+1)/2];
+      best[k] = -1.0e300;
+      for( int i=0; i<=k; i++) {
+        double fitness = row[i] - prior;
+        if( i > 0) fitness += best[i-1];
+        if( fitness > best[k]) {
+          best[k] = fitness;
+          last[k] = i;
+        }
+      }
+    }
+    starts.clear();
+    for( int k=m-1; k>=0; k=last[k]-1) starts.push_back( last[k]);
+    if( (int) starts.size() <= max_bins) break;
+    prior *= 2.0;
+  }
+
+  edges_.clear();
+  for( int b=starts.size()-1; b>=0; b--) edges_.push_back( cell_edges[ starts[b]]);
+  edges_.push_back( cell_edges[m]);
+}
+
+//***************************************************************************
+// Histogram_Engine::fitness_chunk( begin, end, ichunk, *data) -- STATIC
+// body of the fitness pass of Bayesian blocks, for the blocks that end at
+// cells begin to end.
+void Histogram_Engine::fitness_chunk( int begin, int end, int ichunk, void *data)
+{
+  Blocks *blocks = (Blocks *) data;
+  const float *cell_edges = blocks->cell_edges;
+  const double *cumulative = blocks->cumulative;
+  for( int k=begin; k<end; k++) {
+    double *row = blocks->fitness + k*(k+1)/2;
+    for( int i=0; i<=k; i++) {
+      double n = cumulative[k+1] - cumulative[i];
+      double t = cell_edges[k+1] - cell_edges[i];
+      row[i] = n > 0.0 ? n * log( n / t) : 0.0;
+    }
+  }
+}
+
+//***************************************************************************
+// Histogram_Engine::compute_edges() -- Set the bin edges and number of 
+// bins for the binning mode.  Modes other than equal widths read quantiles
+// from the sorted order, sorting the coordinates here only if the caller 
+// didn't supply ranks.  Edges are confined to [amin,amax], and points 
+// beyond them fall in the end bins, as with equal widths.
+void Histogram_Engine::compute_edges()
+{
+  nbins_ = max_bins_;
+  if( mode_ == BINS_EQUAL_WIDTH || npoints_ < 2) {
+    edges_.resize( nbins_+1);
+    for( int i=0; i<=nbins_; i++)
+      edges_[i] = amin_ + i * ( amax_ - amin_) / nbins_;
+    return;
+  }
+
+  // Sort the coordinates if need be
+  if( order_ == NULL) {
+    if( (int) own_order_.size() != npoints_) {
+      own_order_.resize( npoints_);
+      for( int i=0; i<npoints_; i++) own_order_[i] = i;
+      std::sort( own_order_.begin(), own_order_.end(), Compare( this));
+    }
+  }
+  const int *supplied = order_;
+  if( order_ == NULL) order_ = &own_order_[0];
+
+  edges_.clear();
+  if( mode_ == BINS_EQUAL_DEPTH) {
+    for( int i=0; i<=nbins_; i++) {
+      int r = (int) ( (double) i * npoints_ / nbins_);
+      edges_.push_back( ranked( r < npoints_ ? r : npoints_-1));
+    }
+  }
+  else if( mode_ == BINS_FREEDMAN_DIACONIS) {
+    // Width 2 IQR n^(-1/3), with at most max_bins_ bins
+    float iqr = ranked( (3*npoints_)/4) - ranked( npoints_/4);
+    float width = 2.0 * iqr * pow( (double) npoints_, -1.0/3.0);
+    int nbins = max_bins_;
+    if( width > 0.0 && ( amax_ - amin_) / width < max_bins_)
+      nbins = (int) ceil( ( amax_ - amin_) / width);
+    if( nbins < 1) nbins = 1;
+    for( int i=0; i<=nbins; i++)
+      edges_.push_back( amin_ + i * ( amax_ - amin_) / nbins);
+  }
+  else bayesian_blocks( max_bins_);
+  order_ = supplied;
+
+  // Confine edges to the axis and drop empty bins left by ties
+  for( unsigned int i=0; i<edges_.size(); i++) {
+    if( edges_[i] < amin_) edges_[i] = amin_;
+    if( edges_[i] > amax_) edges_[i] = amax_;
+  }
+  edges_.front() = amin_;
+  edges_.back() = amax_;
+  edges_.erase( std::unique( edges_.begin(), edges_.end()), edges_.end());
+  if( edges_.size() < 2) edges_.push_back( amax_ > amin_ ? amax_ : amin_ + 1.0);
+  nbins_ = edges_.size() - 1;
+}
+
+//***************************************************************************
+// Histogram_Engine::update( vertices, axis, weighted, nbins, amin, amax,
+// mode, order) -- Bring the counts up to date for coordinate axis of
+// vertices, weighted by the z coordinate if asked, binned over
+// [amin,amax] into nbins bins, or at most nbins for adaptive modes.
+// order, if given, lists the points in increasing order of the
+// coordinate.  Does as little work as possible: nothing if 
+// neither the binning nor the selection has changed, and only the changed
+// points after a gather.
+void Histogram_Engine::update(
+  const Vertex_Source &vertices, int axis, int weighted,
+  int nbins, float amin, float amax, int mode, const int *order)
+{
+  if( nbins <= 0) return;
+
+  // A change in binning or data invalidates everything
+  if( vertices != vertices_ || axis != axis_ || weighted != weighted_ ||
+      nbins != max_bins_ ||
+      npoints != npoints_ || amin != amin_ || amax != amax_ ||
+      mode != mode_ || order != order_) {
+    vertices_ = vertices;
+    axis_ = axis;
+    weighted_ = weighted;
+    nbins_ = max_bins_ = nbins;
+    npoints_ = npoints;
+    amin_ = amin;
+    amax_ = amax;
+    mode_ = mode;
+    order_ = order;
+    invalidate();
+  }
+
+  // range is tweaked by (n+1)/n to get the "last" point into the correct bin.
+  scale_range_ = (amax_ - amin_) * ((float)(npoints_+1)/(float)npoints_);
+
+  if( !marginal_valid_) {
+    compute_edges();
+    count_all( 1);
+  }
+  else if( brushes_generation_ != Plot_Window::selection_generation) {
+    if( Plot_Window::selection_delta_valid &&
+        brushes_generation_ == Plot_Window::selection_generation-1)
+      apply_delta();
+    else count_all( 0);
+  }
+}
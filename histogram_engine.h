@@ -0,0 +1,199 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: histogram_engine.h
+//
+// Class definitions:
+//   Histogram_Engine -- Cached marginal and per-brush histogram counts
+//
+// Classes referenced:
+//   Plot_Window -- Source of selection generations, deltas, and ranks
+//   Worker_Pool -- Runs the binning passes
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Compute histogram counts for one axis of a plot, for all points
+//   and for every brush, and keep them current cheaply.  Bins can have
+//   equal widths, equal depths (quantiles), Freedman-Diaconis widths, or
+//   adaptive widths from Bayesian blocks.
+//
+// General design philosophy:
+//   1) Marginal counts depend only on the axis data and the binning, so
+//      they are computed once after each extract and cached.
+//   2) Per-brush counts for all brushes are computed together with the
+//      marginal in a single pass.  Points are binned a block at a time in a
+//      branch-free loop the compiler can vectorize, then scattered into
+//      per-chunk bins, and chunks run in parallel on the worker pool.
+//   3) While brushing, per-brush counts are updated only for the points
+//      whose brush changed in the last gather.  Bins are recomputed for
+//      those points on the fly, so no per-point storage is needed.
+//   4) Bin edges other than equal widths are read from the sorted order of
+//      the axis, normally the column ranks the plot already keeps, so they
+//      cost O(nbins) rather than a pass over the points.  Bayesian blocks
+//      are found by dynamic programming over fine quantile cells.  The
+//      fitness of every run of cells is computed once, in parallel, so
+//      raising the prior to get fewer blocks only repeats the cheap part.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef HISTOGRAM_ENGINE_H
+#define HISTOGRAM_ENGINE_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "vertex_source.h"
+
+//***************************************************************************
+// Class: Histogram_Engine
+//
+// Class definitions:
+//   Histogram_Engine -- Cached marginal and per-brush histogram counts
+//
+// Classes referenced:
+//   Plot_Window, Worker_Pool
+//
+// Purpose: Maintain histogram counts for one axis of one plot.
+//
+// Functions:
+//   Histogram_Engine() -- Constructor
+//   ~Histogram_Engine() -- Destructor
+//
+//   invalidate() -- Discard cached counts because the axis data changed
+//   update( vertices, axis, weighted, nbins, amin, amax, mode, order) --
+//     Bring counts up to date
+//   nbins() -- Get number of bins
+//   edge( i) -- Lower edge of bin i, or upper edge of the last bin
+//   marginal( bin) -- Weighted count of all points in a bin
+//   brush_count( brush, bin) -- Weighted count of a brush in a bin
+//   bin_of( x) -- Bin for coordinate x
+//
+//   count_all( with_marginal) -- Full binning pass
+//   apply_delta() -- Update per-brush counts from the last gather
+//   compute_edges() -- Find the bin edges for the binning mode
+//   ranked( r) -- Coordinate of the point with rank r
+//   bayesian_blocks( max_bins) -- Edges of Bayesian blocks
+//
+// Static functions:
+//   count_chunk( begin, end, ichunk, *data) -- Body of the binning pass
+//   fitness_chunk( begin, end, ichunk, *data) -- Body of the fitness pass
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Histogram_Engine
+{
+  public:
+    // Ways to choose bin edges
+    enum binning_modes {
+      BINS_EQUAL_WIDTH = 0,
+      BINS_EQUAL_DEPTH,
+      BINS_FREEDMAN_DIACONIS,
+      BINS_BAYESIAN_BLOCKS
+    };
+
+  protected:
+    // Binning and data the cached counts describe.  For adaptive modes,
+    // nbins_ is the number of bins found and max_bins_ the number asked for.
+    Vertex_Source vertices_;
+    int axis_, weighted_;
+    int nbins_, max_bins_;
+    int npoints_;
+    float amin_, amax_;
+    float scale_range_;
+    int mode_;
+    const int *order_;
+    int marginal_valid_;
+    int brushes_generation_;
+
+    // Bin edges, nbins_+1 of them, and the sort order of the coordinates 
+    // when no ranks were supplied
+    std::vector<float> edges_;
+    std::vector<int> own_order_;
+
+    // Counts, indexed [bin] and [brush*nbins+bin]
+    std::vector<double> marginal_;
+    std::vector<double> brush_counts_;
+
+    // Per-chunk partial counts for the parallel pass
+    struct Pass {
+      Histogram_Engine *owner;
+      int with_marginal;
+      const int *codes;
+      int nchunks;
+      std::vector<double> partial;
+    };
+
+    void count_all( int with_marginal);
+    void apply_delta();
+    void compute_edges();
+    float ranked( int r) { return vertices_.value( axis_, order_[r]);}
+    void bayesian_blocks( int max_bins);
+
+    // Ordering of points by coordinate, for sorting
+    struct Compare {
+      const Histogram_Engine *h;
+      Compare( const Histogram_Engine *h_in) : h( h_in) {}
+      bool operator()( int i, int j) const
+      { return h->vertices_.value( h->axis_, i) <
+               h->vertices_.value( h->axis_, j);}
+    };
+
+    // Quantile cells and the fitness of every run of them, for the
+    // parallel pass of Bayesian blocks.  The runs ending at cell k start
+    // at fitness[k*(k+1)/2].
+    struct Blocks {
+      const float *cell_edges;
+      const double *cumulative;
+      double *fitness;
+    };
+
+    static void count_chunk( int begin, int end, int ichunk, void *data);
+    static void fitness_chunk( int begin, int end, int ichunk, void *data);
+
+  public:
+    Histogram_Engine();
+    ~Histogram_Engine();
+
+    void invalidate();
+    void update(
+      const Vertex_Source &vertices, int axis, int weighted,
+      int nbins, float amin, float amax,
+      int mode = BINS_EQUAL_WIDTH, const int *order = NULL);
+    int nbins() { return nbins_;}
+    float edge( int i) { return edges_[ i];}
+    double marginal( int bin) { return marginal_[ bin];}
+    double brush_count( int brush, int bin)
+    { return brush_counts_[ brush*nbins_ + bin];}
+    inline int bin_of( float x) const;
+
+    // Points binned at a time before scattering, and quantile cells 
+    // searched for Bayesian blocks
+    static const int block_size = 1024;
+    static const int max_cells = 1024;
+};
+
+//***************************************************************************
+// Histogram_Engine::bin_of( x) -- Bin for coordinate x, clamped to the
+// valid range, using the same arithmetic as the binning pass.  Bins with
+// unequal widths are found by binary search of the interior edges.
+inline int Histogram_Engine::bin_of( float x) const
+{
+  if( mode_ != BINS_EQUAL_WIDTH)
+    return std::upper_bound( 
+      edges_.begin()+1, edges_.begin()+nbins_, x) - (edges_.begin()+1);
+  int bin = (int) ( nbins_ * ( ( x - amin_) / scale_range_));
+  if( bin < 0) bin = 0;
+  if( bin > nbins_-1) bin = nbins_-1;
+  return bin;
+}
+
+#endif   // HISTOGRAM_ENGINE_H
@@ -91,6 +91,16 @@
   #include <getopt.h>
 #endif // __WIN32__
 
+// POSIX threads, used by the worker pool.  Under Windows these are supplied
+// by pthreads-win32.
+#include <pthread.h>
+
+// POSIX regular expressions, used for string searches on ASCII columns.  Not
+// available under Windows.
+#ifndef __WIN32__
+  #include <regex.h>
+#endif // __WIN32__
+
 // These includes should all be part of Dev-C++ environment
 // <float.h>  -- c:\Dev-cpp\include
 // <values.h> -- c:\Dev-cpp\include
@@ -106,9 +116,11 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <deque>
 #include <map>
 #include <string>
 #include <algorithm>
+#include <iterator>
 #include <typeinfo>
 
 // FLTK.  These includes should be handled by the relevant Dev-C++
@@ -135,6 +147,7 @@
 #include <FL/Fl_Menu_Bar.H>
 #include <FL/Fl_Multiline_Output.H>
 #include <FL/Fl_Help_View.H>
+#include <FL/fl_draw.H>
 
 // flews widgets build on FLTK.  On the primary Windows system, these should 
 // be located in c:\devusr\flews as described above
@@ -177,6 +190,8 @@
 #include <gsl/gsl_cdf.h>
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
+#include <gsl/gsl_fft_real.h>
+#include <gsl/gsl_fft_halfcomplex.h>
 
 // Blitz++ (C++ array operations via template metaprogramming)
 #include <blitz/array.h>
@@ -0,0 +1,531 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: kernel_density.cpp
+//
+// Class definitions:
+//   Kernel_Density -- Binned Gaussian kernel density estimates
+//
+// Classes referenced:
+//   Plot_Window -- Source of selection generations and deltas
+//   Worker_Pool -- Runs the binning passes
+//
+// Required packages
+//    GSL 1.6 -- Gnu Scientific Library package for Windows
+//    Blitz++ 0.9 -- Various math routines
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <kernel_density.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "kernel_density.h"
+#include "worker_pool.h"
+#include "plot_window.h"
+
+//***************************************************************************
+// Kernel_Density::Kernel_Density() -- Constructor
+Kernel_Density::Kernel_Density() :
+  ndims_( 0), axis_( 0), npoints_( 0),
+  xmin_( 0.0), xmax_( 0.0), ymin_( 0.0), ymax_( 0.0), valid_( 0),
+  brushes_generation_( -1), smoothed_valid_( 0), curve_brush_( -1),
+  curve_brush_generation_( -1), contours_valid_( 0)
+{}
+
+//***************************************************************************
+// Kernel_Density::~Kernel_Density() -- Destructor
+Kernel_Density::~Kernel_Density()
+{}
+
+//***************************************************************************
+// Kernel_Density::invalidate() -- Discard cached estimates.  Call this
+// whenever the data change.
+void Kernel_Density::invalidate()
+{
+  valid_ = 0;
+  smoothed_valid_ = 0;
+  brushes_generation_ = -1;
+  curve_brush_ = -1;
+}
+
+//***************************************************************************
+// Kernel_Density::bin_chunk( begin, end, ichunk, *data) -- STATIC body of
+// the binning pass.  Split the weight of points [begin,end) between their
+// nearest grid nodes, in the per-chunk grid for chunk ichunk.
+void Kernel_Density::bin_chunk( int begin, int end, int ichunk, void *data)
+{
+  Pass *pass = (Pass *) data;
+  Kernel_Density *kd = pass->owner;
+  double *grid = &(pass->partial[ ichunk*pass->nslots]);
+  int ngrid = kd->ngrid();
+  float last = (float) (ngrid-1);
+  const Vertex_Source &v = kd->vertices_;
+  float xscale = last / ( kd->xmax_ - kd->xmin_);
+  float yscale = last / ( kd->ymax_ - kd->ymin_);
+
+  if( kd->ndims_ == 1) {
+    double *brush_grid = grid + ngrid;
+    const int *codes = pass->codes;
+    for( int i=begin; i<end; i++) {
+      float f = ( v.value( kd->axis_, i) - kd->xmin_) * xscale;
+      if( !( f >= 0.0f && f <= last)) continue;
+      int k = (int) f;
+      if( k > ngrid-2) k = ngrid-2;
+      double w1 = f - k;
+      grid[ k] += 1.0 - w1;
+      grid[ k+1] += w1;
+      brush_grid[ codes[i]*ngrid + k] += 1.0 - w1;
+      brush_grid[ codes[i]*ngrid + k+1] += w1;
+    }
+  }
+  else {
+    for( int i=begin; i<end; i++) {
+      float fx = ( v.value( 0, i) - kd->xmin_) * xscale;
+      float fy = ( v.value( 1, i) - kd->ymin_) * yscale;
+      if( !( fx >= 0.0f && fx <= last && fy >= 0.0f && fy <= last)) continue;
+      int kx = (int) fx;
+      int ky = (int) fy;
+      if( kx > ngrid-2) kx = ngrid-2;
+      if( ky > ngrid-2) ky = ngrid-2;
+      double wx = fx - kx, wy = fy - ky;
+      double *node = grid + ky*ngrid + kx;
+      node[ 0] += ( 1.0-wx) * ( 1.0-wy);
+      node[ 1] += wx * ( 1.0-wy);
+      node[ ngrid] += ( 1.0-wx) * wy;
+      node[ ngrid+1] += wx * wy;
+    }
+  }
+}
+
+//***************************************************************************
+// Kernel_Density::bin_all() -- Bin every point, in parallel using per-chunk
+// grids that are summed at the end.
+void Kernel_Density::bin_all()
+{
+  int ngrid = this->ngrid();
+
+  Pass pass;
+  pass.owner = this;
+  pass.codes = selected.data();
+  pass.nslots = ( ndims_ == 1) ? (NBRUSHES+1)*ngrid : ngrid*ngrid;
+  pass.nchunks = 1;
+
+  // Count brushes as of the last gather, so later deltas apply cleanly
+  int generation = -1;
+  if( ndims_ == 1 && Plot_Window::gathered_selection.rows() == npoints_) {
+    pass.codes = Plot_Window::gathered_selection.data();
+    generation = Plot_Window::selection_generation;
+  }
+  if( worker_pool != NULL && npoints_ >= 65536)
+    pass.nchunks = worker_pool->nthreads() + 1;
+  pass.partial.assign( pass.nchunks * pass.nslots, 0.0);
+
+  if( pass.nchunks > 1)
+    worker_pool->parallel_for( npoints_, pass.nchunks, bin_chunk, (void*) &pass);
+  else if( npoints_ > 0) bin_chunk( 0, npoints_, 0, (void*) &pass);
+
+  // Sum the per-chunk grids and split off the brushes
+  std::vector<double> sum( pass.nslots, 0.0);
+  for( int c=0; c<pass.nchunks; c++) {
+    const double *partial = &(pass.partial[ c*pass.nslots]);
+    for( int k=0; k<pass.nslots; k++) sum[k] += partial[k];
+  }
+  if( ndims_ == 1) {
+    counts_.assign( sum.begin(), sum.begin() + ngrid);
+    brush_counts_.assign( sum.begin() + ngrid, sum.end());
+  }
+  else counts_.swap( sum);
+
+  valid_ = 1;
+  smoothed_valid_ = 0;
+  brushes_generation_ = generation;
+  curve_brush_ = -1;
+}
+
+//***************************************************************************
+// Kernel_Density::apply_delta() -- Move the points whose brush changed in
+// the last gather from their old brush's counts to their new one's.
+void Kernel_Density::apply_delta()
+{
+  int ngrid = this->ngrid();
+  float last = (float) (ngrid-1);
+  float xscale = last / ( xmax_ - xmin_);
+  const std::vector<int> &points = Plot_Window::changed_points;
+  const std::vector<int> &from = Plot_Window::changed_from;
+  for( unsigned int j=0; j<points.size(); j++) {
+    int i = points[j];
+    float f = ( vertices_.value( axis_, i) - xmin_) * xscale;
+    if( !( f >= 0.0f && f <= last)) continue;
+    int k = (int) f;
+    if( k > ngrid-2) k = ngrid-2;
+    double w1 = f - k;
+    int to = Plot_Window::gathered_selection( i);
+    brush_counts_[ from[j]*ngrid + k] -= 1.0 - w1;
+    brush_counts_[ from[j]*ngrid + k+1] -= w1;
+    brush_counts_[ to*ngrid + k] += 1.0 - w1;
+    brush_counts_[ to*ngrid + k+1] += w1;
+  }
+  brushes_generation_ = Plot_Window::selection_generation;
+}
+
+//***************************************************************************
+// Kernel_Density::update_1d( vertices, axis, xmin, xmax) -- Bring a 1D
+// estimate of coordinate axis of vertices over [xmin,xmax] up to date.
+// Nothing is done if neither the data nor the selection have changed, and
+// after a gather only the changed points are rebinned.
+void Kernel_Density::update_1d(
+  const Vertex_Source &vertices, int axis, float xmin, float xmax)
+{
+  if( !( xmax > xmin)) {
+    xmin -= 0.5;
+    xmax += 0.5;
+  }
+  if( ndims_ != 1 || vertices != vertices_ || axis != axis_ ||
+      npoints != npoints_ || xmin != xmin_ || xmax != xmax_) {
+    ndims_ = 1;
+    vertices_ = vertices;
+    axis_ = axis;
+    npoints_ = npoints;
+    xmin_ = xmin;
+    xmax_ = xmax;
+    invalidate();
+  }
+
+  if( !valid_) bin_all();
+  else if( brushes_generation_ != Plot_Window::selection_generation) {
+    if( Plot_Window::selection_delta_valid &&
+        brushes_generation_ == Plot_Window::selection_generation-1)
+      apply_delta();
+    else bin_all();
+  }
+}
+
+//***************************************************************************
+// Kernel_Density::update_2d( vertices, xmin, xmax, ymin, ymax) -- Bring a
+// 2D estimate of the x and y coordinates of vertices over
+// [xmin,xmax] x [ymin,ymax] up to date.
+void Kernel_Density::update_2d(
+  const Vertex_Source &vertices,
+  float xmin, float xmax, float ymin, float ymax)
+{
+  if( !( xmax > xmin)) {
+    xmin -= 0.5;
+    xmax += 0.5;
+  }
+  if( !( ymax > ymin)) {
+    ymin -= 0.5;
+    ymax += 0.5;
+  }
+  if( ndims_ != 2 || vertices != vertices_ ||
+      npoints != npoints_ || xmin != xmin_ || xmax != xmax_ ||
+      ymin != ymin_ || ymax != ymax_) {
+    ndims_ = 2;
+    vertices_ = vertices;
+    npoints_ = npoints;
+    xmin_ = xmin;
+    xmax_ = xmax;
+    ymin_ = ymin;
+    ymax_ = ymax;
+    invalidate();
+  }
+  if( !valid_) bin_all();
+}
+
+//***************************************************************************
+// Kernel_Density::spread( *grid, n, stride, count, sd, iqr) -- STATIC
+// method to find the total, standard deviation, and interquartile range of
+// binned counts, in units of grid cells.
+void Kernel_Density::spread(
+  const double *grid, int n, int stride,
+  double &count, double &sd, double &iqr)
+{
+  double sum = 0.0, sum1 = 0.0, sum2 = 0.0;
+  for( int k=0; k<n; k++) {
+    double c = grid[ k*stride];
+    sum += c;
+    sum1 += c*k;
+    sum2 += c*k*k;
+  }
+  count = sum;
+  sd = iqr = 0.0;
+  if( sum <= 0.0) return;
+  double mean = sum1/sum;
+  double var = sum2/sum - mean*mean;
+  sd = var > 0.0 ? sqrt( var) : 0.0;
+
+  // Quartiles by interpolating the cumulative counts
+  double q[2] = { 0.25*sum, 0.75*sum}, at[2] = { 0.0, 0.0};
+  double cumulative = 0.0;
+  for( int k=0, iq=0; k<n && iq<2; k++) {
+    double c = grid[ k*stride];
+    while( iq<2 && cumulative + c >= q[iq]) {
+      at[iq] = k + ( c > 0.0 ? ( q[iq] - cumulative) / c : 0.0);
+      iq++;
+    }
+    cumulative += c;
+  }
+  iqr = at[1] - at[0];
+}
+
+//***************************************************************************
+// Kernel_Density::smooth( *grid, n, stride, sigma) -- STATIC method to
+// convolve n values of a grid, with the given stride, with a Gaussian of
+// standard deviation sigma grid cells.  Values are zero-padded to a power
+// of two long enough that the FFT's circular convolution doesn't wrap.
+// The Gaussian's transform is known in closed form, so only the forward
+// and inverse transforms of the data are needed.
+void Kernel_Density::smooth( double *grid, int n, int stride, double sigma)
+{
+  if( n <= 1 || sigma < 0.1) return;
+  if( sigma > n) sigma = n;
+  int m = 2;
+  while( m < n + (int) ceil( 4.0*sigma) + 1) m *= 2;
+
+  std::vector<double> buffer( m, 0.0);
+  for( int k=0; k<n; k++) buffer[k] = grid[ k*stride];
+  gsl_fft_real_radix2_transform( &buffer[0], 1, m);
+
+  // Halfcomplex order: real parts in [0,m/2], imaginary parts of frequency
+  // i in m-i.  The kernel's transform is real, so both are scaled alike.
+  double factor = -2.0 * M_PI * M_PI * sigma * sigma / ( (double) m * m);
+  for( int i=1; i<=m/2; i++) {
+    double kernel = exp( factor * i * i);
+    buffer[i] *= kernel;
+    if( i < m/2) buffer[ m-i] *= kernel;
+  }
+  gsl_fft_halfcomplex_radix2_inverse( &buffer[0], 1, m);
+
+  // Clip the small negative ringing near empty regions
+  for( int k=0; k<n; k++) grid[ k*stride] = buffer[k] > 0.0 ? buffer[k] : 0.0;
+}
+
+//***************************************************************************
+// Kernel_Density::smoothed() -- Smoothed counts of all points, recomputed
+// only when the counts change.  1D estimates use Silverman's bandwidth,
+// 0.9 min( sd, IQR/1.34) n^-1/5.  2D estimates use Scott's, sd n^-1/6 for
+// each axis, and are smoothed along rows and then along columns.
+const std::vector<double> &Kernel_Density::smoothed()
+{
+  if( smoothed_valid_) return smoothed_;
+  contours_valid_ = 0;
+  int ngrid = this->ngrid();
+  smoothed_ = counts_;
+  if( smoothed_.empty()) return smoothed_;
+
+  double count, sd, iqr;
+  if( ndims_ == 1) {
+    spread( &smoothed_[0], ngrid, 1, count, sd, iqr);
+    double s = ( iqr > 0.0 && iqr/1.34 < sd) ? iqr/1.34 : sd;
+    double sigma = count > 1.0 ? 0.9 * s * pow( count, -0.2) : 1.0;
+    smooth( &smoothed_[0], ngrid, 1, sigma > 0.5 ? sigma : 0.5);
+  }
+  else {
+    std::vector<double> xsum( ngrid, 0.0), ysum( ngrid, 0.0);
+    for( int iy=0; iy<ngrid; iy++) {
+      for( int ix=0; ix<ngrid; ix++) {
+        xsum[ ix] += smoothed_[ iy*ngrid + ix];
+        ysum[ iy] += smoothed_[ iy*ngrid + ix];
+      }
+    }
+    double sdx, sdy;
+    spread( &xsum[0], ngrid, 1, count, sdx, iqr);
+    spread( &ysum[0], ngrid, 1, count, sdy, iqr);
+    double scott = count > 1.0 ? pow( count, -1.0/6.0) : 1.0;
+    double sigma_x = sdx * scott > 0.5 ? sdx * scott : 0.5;
+    double sigma_y = sdy * scott > 0.5 ? sdy * scott : 0.5;
+    for( int iy=0; iy<ngrid; iy++)
+      smooth( &smoothed_[ iy*ngrid], ngrid, 1, sigma_x);
+    for( int ix=0; ix<ngrid; ix++)
+      smooth( &smoothed_[ ix], ngrid, ngrid, sigma_y);
+  }
+  smoothed_valid_ = 1;
+  return smoothed_;
+}
+
+//***************************************************************************
+// Kernel_Density::curve( brush) -- Smoothed 1D counts at each grid node, of
+// all points if brush is negative or else of one brush, with a bandwidth
+// chosen for those points.  Call update_1d() first.
+const std::vector<double> &Kernel_Density::curve( int brush)
+{
+  if( brush < 0 || brush_counts_.empty()) return smoothed();
+  if( brush == curve_brush_ &&
+      brushes_generation_ == curve_brush_generation_)
+    return smoothed_brush_;
+
+  int ngrid = this->ngrid();
+  smoothed_brush_.assign(
+    brush_counts_.begin() + brush*ngrid,
+    brush_counts_.begin() + (brush+1)*ngrid);
+  double count, sd, iqr;
+  spread( &smoothed_brush_[0], ngrid, 1, count, sd, iqr);
+  double s = ( iqr > 0.0 && iqr/1.34 < sd) ? iqr/1.34 : sd;
+  double sigma = count > 1.0 ? 0.9 * s * pow( count, -0.2) : 1.0;
+  smooth( &smoothed_brush_[0], ngrid, 1, sigma > 0.5 ? sigma : 0.5);
+  curve_brush_ = brush;
+  curve_brush_generation_ = brushes_generation_;
+  return smoothed_brush_;
+}
+
+//***************************************************************************
+// Kernel_Density::contours( fractions) -- Trace isodensity lines of a 2D
+// estimate by marching squares.  Each fraction p gives the level whose
+// contour encloses the densest region holding a fraction p of the points.
+// Element l of the result holds x0, y0, x1, y1 for each line segment of
+// level l, in data coordinates.  The lines are traced again only when the
+// smoothed counts or the fractions change.  Call update_2d() first.
+const std::vector< std::vector<float> > &Kernel_Density::contours(
+  const std::vector<double> &fractions)
+{
+  std::vector< std::vector<float> > &segments = contour_segments_;
+  if( ndims_ != 2) {
+    segments.assign( fractions.size(), std::vector<float>());
+    contours_valid_ = 0;
+    return segments;
+  }
+  const std::vector<double> &s = smoothed();
+  if( contours_valid_ && fractions == contour_fractions_) return segments;
+  segments.assign( fractions.size(), std::vector<float>());
+  contour_fractions_ = fractions;
+  contours_valid_ = 1;
+  int ngrid = this->ngrid();
+  if( (int) s.size() != ngrid*ngrid) return segments;
+
+  // Find the level for each fraction from the nodes sorted by density
+  std::vector<double> sorted( s);
+  std::sort( sorted.begin(), sorted.end());
+  double total = 0.0;
+  for( unsigned int k=0; k<sorted.size(); k++) total += sorted[k];
+  if( total <= 0.0) return segments;
+  std::vector<double> levels( fractions.size(), 0.0);
+  double cumulative = 0.0;
+  int next = sorted.size()-1;
+  for( unsigned int l=0; l<fractions.size(); l++) {
+    while( next > 0 && cumulative < fractions[l]*total) cumulative += sorted[ next--];
+    levels[l] = sorted[ next+1];
+  }
+
+  float dx = ( xmax_ - xmin_) / (ngrid-1);
+  float dy = ( ymax_ - ymin_) / (ngrid-1);
+  for( unsigned int l=0; l<levels.size(); l++) {
+    double level = levels[l];
+    std::vector<float> &out = segments[l];
+    for( int iy=0; iy<ngrid-1; iy++) {
+      for( int ix=0; ix<ngrid-1; ix++) {
+
+        // Corners counterclockwise from lower left, and edges bottom,
+        // right, top, left
+        double v[4];
+        v[0] = s[ iy*ngrid + ix];
+        v[1] = s[ iy*ngrid + ix+1];
+        v[2] = s[ (iy+1)*ngrid + ix+1];
+        v[3] = s[ (iy+1)*ngrid + ix];
+        int index = ( v[0] > level) | (( v[1] > level) << 1) |
+                    (( v[2] > level) << 2) | (( v[3] > level) << 3);
+        if( index == 0 || index == 15) continue;
+
+        float x0 = xmin_ + ix*dx, y0 = ymin_ + iy*dy;
+        float ex[4], ey[4];
+        ex[0] = x0 + dx * ( level - v[0]) / ( v[1] - v[0]); ey[0] = y0;
+        ex[1] = x0 + dx; ey[1] = y0 + dy * ( level - v[1]) / ( v[2] - v[1]);
+        ex[2] = x0 + dx * ( level - v[3]) / ( v[2] - v[3]); ey[2] = y0 + dy;
+        ex[3] = x0; ey[3] = y0 + dy * ( level - v[0]) / ( v[3] - v[0]);
+
+        // Pairs of edges crossed for each case.  Saddles are resolved by
+        // the value at the center of the cell.
+        int pairs[4] = { -1, -1, -1, -1};
+        int center_high = 0.25*( v[0]+v[1]+v[2]+v[3]) > level;
+        switch( index) {
+          case 1: case 14: pairs[0] = 3; pairs[1] = 0; break;
+          case 2: case 13: pairs[0] = 0; pairs[1] = 1; break;
+          case 3: case 12: pairs[0] = 3; pairs[1] = 1; break;
+          case 4: case 11: pairs[0] = 1; pairs[1] = 2; break;
+          case 6: case 9:  pairs[0] = 0; pairs[1] = 2; break;
+          case 7: case 8:  pairs[0] = 3; pairs[1] = 2; break;
+          case 5:
+            if( center_high) { pairs[0]=0; pairs[1]=1; pairs[2]=2; pairs[3]=3;}
+            else { pairs[0]=3; pairs[1]=0; pairs[2]=1; pairs[3]=2;}
+            break;
+          case 10:
+            if( center_high) { pairs[0]=3; pairs[1]=0; pairs[2]=1; pairs[3]=2;}
+            else { pairs[0]=0; pairs[1]=1; pairs[2]=2; pairs[3]=3;}
+            break;
+        }
+        for( int p=0; p<4 && pairs[p] >= 0; p+=2) {
+          out.push_back( ex[ pairs[p]]);
+          out.push_back( ey[ pairs[p]]);
+          out.push_back( ex[ pairs[p+1]]);
+          out.push_back( ey[ pairs[p+1]]);
+        }
+      }
+    }
+  }
+  return segments;
+}
+
+//***************************************************************************
+// Kernel_Density::evaluate_chunk( begin, end, ichunk, *data) -- STATIC body
+// of evaluate().  Interpolate the smoothed grid bilinearly at points
+// [begin,end).
+void Kernel_Density::evaluate_chunk( int begin, int end, int ichunk, void *data)
+{
+  Pass *pass = (Pass *) data;
+  Kernel_Density *kd = pass->owner;
+  const double *s = &(kd->smoothed_[0]);
+  int ngrid = kd->ngrid();
+  float last = (float) (ngrid-1);
+  float xscale = last / ( kd->xmax_ - kd->xmin_);
+  float yscale = last / ( kd->ymax_ - kd->ymin_);
+
+  // Scale counts to probability density per unit area
+  double total = 0.0;
+  for( int k=0; k<ngrid*ngrid; k++) total += kd->counts_[k];
+  double norm = total > 0.0 ? 1.0 / ( total / ( xscale * yscale)) : 0.0;
+
+  for( int i=begin; i<end; i++) {
+    float fx = ( pass->evaluated->value( 0, i) - kd->xmin_) * xscale;
+    float fy = ( pass->evaluated->value( 1, i) - kd->ymin_) * yscale;
+    if( !( fx >= 0.0f && fx <= last && fy >= 0.0f && fy <= last)) {
+      pass->out[i] = 0.0;
+      continue;
+    }
+    int kx = (int) fx;
+    int ky = (int) fy;
+    if( kx > ngrid-2) kx = ngrid-2;
+    if( ky > ngrid-2) ky = ngrid-2;
+    double wx = fx - kx, wy = fy - ky;
+    const double *node = s + ky*ngrid + kx;
+    pass->out[i] = norm * (
+      ( 1.0-wx) * ( 1.0-wy) * node[ 0] + wx * ( 1.0-wy) * node[ 1] +
+      ( 1.0-wx) * wy * node[ ngrid] + wx * wy * node[ ngrid+1]);
+  }
+}
+
+//***************************************************************************
+// Kernel_Density::evaluate( vertices, n, out) -- Evaluate a 2D estimate as
+// a probability density at the x and y coordinates of the first n points
+// of vertices, and store the results in out.  Call update_2d() first.
+void Kernel_Density::evaluate(
+  const Vertex_Source &vertices, int n, float *out)
+{
+  if( ndims_ != 2 || n <= 0) return;
+  smoothed();
+
+  Pass pass;
+  pass.owner = this;
+  pass.evaluated = &vertices;
+  pass.out = out;
+  if( worker_pool != NULL && n >= 65536)
+    worker_pool->parallel_for( n, worker_pool->nthreads()+1, evaluate_chunk, (void*) &pass);
+  else evaluate_chunk( 0, n, 0, (void*) &pass);
+}
@@ -0,0 +1,165 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: kernel_density.h
+//
+// Class definitions:
+//   Kernel_Density -- Binned Gaussian kernel density estimates
+//
+// Classes referenced:
+//   Plot_Window -- Source of selection generations and deltas
+//   Worker_Pool -- Runs the binning passes
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Compute smooth density estimates of one axis, or of two axes
+//   jointly, fast enough for very large data sets.  The 1D estimates are
+//   drawn as marginal curves, the 2D ones as isodensity contours, and the 2D
+//   estimate can be evaluated at every point to make a new column.
+//
+// General design philosophy:
+//   1) Points are linearly binned onto a regular grid, each point's weight
+//      split between its two (or four) nearest grid nodes.  Binning is a
+//      single parallel pass with per-chunk grids.
+//   2) The binned counts are convolved with a Gaussian kernel using GSL's
+//      FFTs on a zero-padded grid.  The 2D kernel is separable, so it is
+//      applied along rows and then along columns.  Cost is O(n) for the
+//      binning and O(G log G) for the smoothing, for G grid nodes.
+//   3) Bandwidths follow Silverman's rule in 1D and Scott's rule in 2D, with
+//      spreads estimated from the binned counts.
+//   4) As in Histogram_Engine, the 1D estimate keeps binned counts for each
+//      brush and updates them from the selection delta, so brushing only
+//      costs a smoothing pass.
+//   5) Contours are traced once per smoothing and set of fractions, and
+//      kept, so redrawing a plot with a new view doesn't trace them again.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef KERNEL_DENSITY_H
+#define KERNEL_DENSITY_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "vertex_source.h"
+
+//***************************************************************************
+// Class: Kernel_Density
+//
+// Class definitions:
+//   Kernel_Density -- Binned Gaussian kernel density estimates
+//
+// Classes referenced:
+//   Plot_Window, Worker_Pool
+//
+// Purpose: Maintain a 1D or 2D kernel density estimate for one plot.
+//
+// Functions:
+//   Kernel_Density() -- Constructor
+//   ~Kernel_Density() -- Destructor
+//
+//   invalidate() -- Discard cached estimates because the data changed
+//   update_1d( vertices, axis, xmin, xmax) -- Bring a 1D estimate up to
+//     date
+//   update_2d( vertices, xmin, xmax, ymin, ymax) -- Same for 2D
+//   curve( brush) -- Smoothed 1D counts of all points or of one brush
+//   contours( fractions) -- Isodensity lines of the 2D estimate
+//   evaluate( vertices, n, out) -- 2D probability density at points
+//   ngrid() -- Number of grid nodes along each axis
+//
+//   bin_all() -- Full binning pass
+//   apply_delta() -- Update per-brush counts from the last gather
+//   smoothed() -- Smoothed counts of all points
+//
+// Static functions:
+//   bin_chunk( begin, end, ichunk, *data) -- Body of the binning pass
+//   evaluate_chunk( begin, end, ichunk, *data) -- Body of evaluate()
+//   smooth( *grid, n, stride, sigma) -- Convolve with a Gaussian by FFT
+//   spread( *grid, n, stride, ...) -- Count, sd, and IQR of binned counts
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Kernel_Density
+{
+  protected:
+    // Data and grid the cached counts describe: one axis of the vertices
+    // in 1D, x and y in 2D.  Grid node k of an axis is at
+    // min + k*(max-min)/(ngrid-1).
+    int ndims_;
+    Vertex_Source vertices_;
+    int axis_;
+    int npoints_;
+    float xmin_, xmax_, ymin_, ymax_;
+    int valid_;
+    int brushes_generation_;
+
+    // Binned counts of all points, indexed [iy*ngrid+ix], and of each brush
+    // in 1D, indexed [brush*ngrid+ix]
+    std::vector<double> counts_;
+    std::vector<double> brush_counts_;
+
+    // Smoothed counts, kept until the counts change
+    std::vector<double> smoothed_;
+    int smoothed_valid_;
+    std::vector<double> smoothed_brush_;
+    int curve_brush_, curve_brush_generation_;
+
+    // Contour segments of each level, kept until the smoothed counts or
+    // the fractions change
+    std::vector<double> contour_fractions_;
+    std::vector< std::vector<float> > contour_segments_;
+    int contours_valid_;
+
+    // Arguments and per-chunk grids for the parallel passes
+    struct Pass {
+      Kernel_Density *owner;
+      const int *codes;
+      int nchunks;
+      int nslots;
+      std::vector<double> partial;
+      const Vertex_Source *evaluated;
+      float *out;
+    };
+
+    void bin_all();
+    void apply_delta();
+    const std::vector<double> &smoothed();
+
+    static void bin_chunk( int begin, int end, int ichunk, void *data);
+    static void evaluate_chunk( int begin, int end, int ichunk, void *data);
+    static void smooth( double *grid, int n, int stride, double sigma);
+    static void spread(
+      const double *grid, int n, int stride,
+      double &count, double &sd, double &iqr);
+
+  public:
+    Kernel_Density();
+    ~Kernel_Density();
+
+    void invalidate();
+    void update_1d(
+      const Vertex_Source &vertices, int axis, float xmin, float xmax);
+    void update_2d(
+      const Vertex_Source &vertices,
+      float xmin, float xmax, float ymin, float ymax);
+    const std::vector<double> &curve( int brush);
+    const std::vector< std::vector<float> > &contours(
+      const std::vector<double> &fractions);
+    void evaluate( const Vertex_Source &vertices, int n, float *out);
+    int ngrid() { return ndims_ == 2 ? ngrid_2d : ngrid_1d;}
+
+    // Grid nodes along each axis in 1D and 2D
+    static const int ngrid_1d = 512;
+    static const int ngrid_2d = 256;
+};
+
+#endif   // KERNEL_DENSITY_H
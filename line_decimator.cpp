@@ -0,0 +1,311 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: line_decimator.cpp
+//
+// Class definitions:
+//   Line_Decimator -- Draw long line strips through a few points per
+//     pixel column
+//
+// Classes referenced:
+//   Plot_Window -- Source of the vertices and each brush's indices
+//   Worker_Pool -- Runs the decimation passes
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <line_decimator.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "line_decimator.h"
+#include "plot_window.h"
+#include "worker_pool.h"
+
+// Number of chunks for a parallel pass over a strip of n points
+static int number_of_chunks( int n)
+{
+  if( worker_pool == NULL || n < 1<<18) return 1;
+  return 4 * ( worker_pool->nthreads() + 1);
+}
+
+//***************************************************************************
+// Line_Decimator::Line_Decimator() -- Constructor
+Line_Decimator::Line_Decimator()
+{
+  data_changed();
+}
+
+//***************************************************************************
+// Line_Decimator::data_changed() -- Discard the summaries and the points
+// kept, because the plot's vertices have changed.
+void Line_Decimator::data_changed()
+{
+  for( int i=0; i<NBRUSHES; i++) {
+    strips_[i].vertices.clear();
+    strips_[i].indices = NULL;
+    strips_[i].count = 0;
+    strips_[i].generation = -1;
+    strips_[i].increasing = 0;
+    strips_[i].ncolumns = 0;
+    strips_[i].kept.clear();
+  }
+}
+
+//***************************************************************************
+// Line_Decimator::update( brush, vertices, indices, count, xmin, xmax,
+// ncolumns) -- Decimate the strip through the points indices[0] up to
+// indices[count-1] read from vertices, for a view from xmin to
+// xmax that is ncolumns pixels wide.  Returns the number of points kept,
+// or 0 if the strip should be drawn in full.
+int Line_Decimator::update(
+  int brush, const Vertex_Source &vertices, const unsigned int *indices,
+  int count, float xmin, float xmax, int ncolumns)
+{
+  if( ncolumns <= 0 || !( xmax > xmin)) return 0;
+  if( count <= min_points_per_column*ncolumns) return 0;
+
+  Strip &strip = strips_[ brush];
+  if( strip.generation != Plot_Window::selection_generation ||
+      strip.vertices != vertices || strip.indices != indices ||
+      strip.count != count) {
+    strip.vertices = vertices;
+    strip.indices = indices;
+    strip.count = count;
+    summarize( strip);
+    strip.generation = Plot_Window::selection_generation;
+    strip.ncolumns = 0;
+  }
+  if( strip.ncolumns != ncolumns ||
+      strip.xmin != xmin || strip.xmax != xmax) {
+    strip.xmin = xmin;
+    strip.xmax = xmax;
+    strip.ncolumns = ncolumns;
+    if( strip.increasing) decimate_columns( strip);
+    else decimate_runs( strip);
+  }
+  return strip.kept.size();
+}
+
+//***************************************************************************
+// Line_Decimator::summarize( strip) -- Check whether x never decreases
+// along a strip, and find the lowest and highest point of each block.
+void Line_Decimator::summarize( Strip &strip)
+{
+  int nblocks = ( strip.count + block_size - 1) / block_size;
+  strip.block_low.resize( nblocks);
+  strip.block_high.resize( nblocks);
+  int nchunks = number_of_chunks( strip.count);
+  strip.chunk_increasing.assign( nchunks, 1);
+  if( nchunks > 1)
+    worker_pool->parallel_for( nblocks, nchunks, check_chunk, (void*) &strip);
+  else check_chunk( 0, nblocks, 0, (void*) &strip);
+
+  strip.increasing = 1;
+  for( int i=0; i<nchunks; i++)
+    if( !strip.chunk_increasing[i]) strip.increasing = 0;
+}
+
+//***************************************************************************
+// Line_Decimator::check_chunk( begin, end, ichunk, data) -- STATIC body of
+// the summary pass over blocks begin to end of the strip in data.  NaNs
+// count as decreasing.
+void Line_Decimator::check_chunk( int begin, int end, int ichunk, void *data)
+{
+  Strip *strip = (Strip *) data;
+  const Vertex_Source &v = strip->vertices;
+  const unsigned int *indices = strip->indices;
+  int increasing = 1;
+  for( int block=begin; block<end; block++) {
+    int first = block*block_size;
+    int last = min( first+block_size, strip->count);
+    int low = first, high = first;
+    for( int p=first; p<last; p++) {
+      float x = v.value( 0, indices[p]), y = v.value( 1, indices[p]);
+      if( p > 0 && !( x >= v.value( 0, indices[p-1]))) increasing = 0;
+      if( y < v.value( 1, indices[low])) low = p;
+      if( y > v.value( 1, indices[high])) high = p;
+    }
+    strip->block_low[ block] = low;
+    strip->block_high[ block] = high;
+  }
+  strip->chunk_increasing[ ichunk] = increasing;
+}
+
+//***************************************************************************
+// Line_Decimator::keep( kept, strip, first, lowest, highest, last) --
+// STATIC method to add the points of a column, or run, at strip positions
+// first <= lowest, highest <= last to kept, in strip order and without
+// repeats.
+void Line_Decimator::keep(
+  std::vector<unsigned int> &kept, const Strip &strip,
+  int first, int lowest, int highest, int last)
+{
+  int positions[4] = { first, min( lowest, highest), max( lowest, highest), last};
+  for( int i=0; i<4; i++)
+    if( i == 0 || positions[i] != positions[i-1])
+      kept.push_back( strip.indices[ positions[i]]);
+}
+
+//***************************************************************************
+// Line_Decimator::decimate_columns( strip) -- Keep the points of a strip
+// whose x never decreases, column by column.  Outside the view, only the
+// last point before it and the first point after it are kept.
+void Line_Decimator::decimate_columns( Strip &strip)
+{
+  int nchunks = number_of_chunks( strip.count);
+  strip.chunk_kept.resize( nchunks);
+  if( nchunks > 1)
+    worker_pool->parallel_for(
+      strip.ncolumns, nchunks, column_chunk, (void*) &strip);
+  else column_chunk( 0, strip.ncolumns, 0, (void*) &strip);
+
+  // The points kept, with the segments into and out of the view
+  const Vertex_Source &v = strip.vertices;
+  const unsigned int *indices = strip.indices;
+  int n = strip.count;
+  int before = 0, after = n;
+  while( after > before) {
+    int middle = ( before + after) / 2;
+    if( v.value( 0, indices[middle]) < strip.xmin) before = middle+1;
+    else after = middle;
+  }
+  strip.kept.clear();
+  if( before > 0) strip.kept.push_back( indices[ before-1]);
+  for( int i=0; i<nchunks; i++) {
+    strip.kept.insert(
+      strip.kept.end(), strip.chunk_kept[i].begin(), strip.chunk_kept[i].end());
+    strip.chunk_kept[i].clear();
+  }
+  before = 0, after = n;
+  while( after > before) {
+    int middle = ( before + after) / 2;
+    if( v.value( 0, indices[middle]) <= strip.xmax) before = middle+1;
+    else after = middle;
+  }
+  if( before < n) strip.kept.push_back( indices[ before]);
+}
+
+//***************************************************************************
+// Line_Decimator::column_chunk( begin, end, ichunk, data) -- STATIC body of
+// the column pass over pixel columns begin to end of the strip in data.
+// Each column's points are found by binary search, and its lowest and
+// highest points from the block summaries and the partial blocks at
+// either end.  The last column includes points at xmax.
+void Line_Decimator::column_chunk( int begin, int end, int ichunk, void *data)
+{
+  Strip *strip = (Strip *) data;
+  const Vertex_Source &v = strip->vertices;
+  const unsigned int *indices = strip->indices;
+  int n = strip->count;
+  double width = ( (double) strip->xmax - strip->xmin) / strip->ncolumns;
+  std::vector<unsigned int> &kept = strip->chunk_kept[ ichunk];
+
+  // Strip position of the first point at or right of a column's left
+  // edge, or past xmax for the right edge of the last column
+  int left = 0;
+  for( int column=begin; column<=end; column++) {
+    int first = 0, last = n;
+    while( last > first) {
+      int middle = ( first + last) / 2;
+      float x = v.value( 0, indices[middle]);
+      int before =
+        column < strip->ncolumns ? x < strip->xmin + column*width :
+                                   x <= strip->xmax;
+      if( before) first = middle+1;
+      else last = middle;
+    }
+    int right = first;
+    if( column > begin && right > left) {
+      int low = left, high = left;
+      for( int p=left; p<right; ) {
+        if( p % block_size == 0 && p + block_size <= right) {
+          int block = p / block_size;
+          if( v.value( 1, indices[ strip->block_low[block]]) <
+              v.value( 1, indices[low])) low = strip->block_low[block];
+          if( v.value( 1, indices[ strip->block_high[block]]) >
+              v.value( 1, indices[high])) high = strip->block_high[block];
+          p += block_size;
+        }
+        else {
+          float y = v.value( 1, indices[p]);
+          if( y < v.value( 1, indices[low])) low = p;
+          if( y > v.value( 1, indices[high])) high = p;
+          p++;
+        }
+      }
+      keep( kept, *strip, left, low, high, right-1);
+    }
+    left = right;
+  }
+}
+
+//***************************************************************************
+// Line_Decimator::decimate_runs( strip) -- Keep the points of any strip by
+// cutting it into runs of consecutive points in the same column.  Runs
+// that cross chunk boundaries are cut there too, which keeps a few more
+// points but doesn't change what is drawn.
+void Line_Decimator::decimate_runs( Strip &strip)
+{
+  int nchunks = number_of_chunks( strip.count);
+  strip.chunk_kept.resize( nchunks);
+  if( nchunks > 1)
+    worker_pool->parallel_for( strip.count, nchunks, run_chunk, (void*) &strip);
+  else run_chunk( 0, strip.count, 0, (void*) &strip);
+
+  strip.kept.clear();
+  for( int i=0; i<nchunks; i++) {
+    strip.kept.insert(
+      strip.kept.end(), strip.chunk_kept[i].begin(), strip.chunk_kept[i].end());
+    strip.chunk_kept[i].clear();
+  }
+}
+
+//***************************************************************************
+// Line_Decimator::run_chunk( begin, end, ichunk, data) -- STATIC body of
+// the run pass over strip positions begin to end of the strip in data.
+// Points left and right of the view, or with x a NaN, belong to columns
+// -1 and ncolumns, whose runs keep only their first and last points.
+void Line_Decimator::run_chunk( int begin, int end, int ichunk, void *data)
+{
+  Strip *strip = (Strip *) data;
+  const Vertex_Source &v = strip->vertices;
+  const unsigned int *indices = strip->indices;
+  int ncolumns = strip->ncolumns;
+  double scale = ncolumns / ( (double) strip->xmax - strip->xmin);
+  std::vector<unsigned int> &kept = strip->chunk_kept[ ichunk];
+
+  int run_column = 0, first = begin, low = begin, high = begin;
+  for( int p=begin; p<=end; p++) {
+    int column = ncolumns+1;
+    float y = 0.0;
+    if( p < end) {
+      float x = v.value( 0, indices[p]);
+      y = v.value( 1, indices[p]);
+      if( x > strip->xmax) column = ncolumns;
+      else if( !( x >= strip->xmin)) column = -1;
+      else column = min( (int) ( ( x - strip->xmin) * scale), ncolumns-1);
+    }
+    if( p > begin && column == run_column) {
+      if( y < v.value( 1, indices[low])) low = p;
+      if( y > v.value( 1, indices[high])) high = p;
+      continue;
+    }
+    if( p > begin) {
+      if( run_column < 0 || run_column >= ncolumns) low = high = first;
+      keep( kept, *strip, first, low, high, p-1);
+    }
+    run_column = column;
+    first = low = high = p;
+  }
+}
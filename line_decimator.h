@@ -0,0 +1,145 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: line_decimator.h
+//
+// Class definitions:
+//   Line_Decimator -- Draw long line strips through a few points per
+//     pixel column
+//
+// Classes referenced:
+//   Plot_Window -- Source of the vertices and each brush's indices
+//   Worker_Pool -- Runs the decimation passes
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: A brush drawn as line strips connects all of its points in
+//   order, which for a long time series is far more segments than the
+//   window has pixels.  Within one pixel column, the strip covers the
+//   span from its lowest to its highest point and leaves through its last
+//   one, so drawing only the first, last, lowest, and highest point of
+//   each column (M4 decimation) looks the same at a fraction of the cost.
+//
+// General design philosophy:
+//   1) A brush's indices are in the order of the points, which is the
+//      order of the strip.  After each gather, each brush is checked, in a
+//      parallel pass, for x that never decreases along its strip, as for a
+//      time series, and the position of the lowest and highest point of
+//      each block of the strip is noted.
+//   2) For such brushes, the strip positions at each column boundary are
+//      found by binary search, and the extremes of each column come from
+//      the block summaries plus the partial blocks at either end, so the
+//      cost of a view follows the number of columns rather than points.
+//      Columns are decimated in parallel.
+//   3) Other strips are cut into runs of consecutive points in the same
+//      column, in a parallel pass over the whole strip, and each run is
+//      reduced to its four points.  Runs outside the view keep only their
+//      first and last points, which carry the segments into the view.
+//   4) The points kept are recomputed whenever the x range of the view,
+//      the window width, the gather, or the vertices change.  Rotated
+//      views, and strips with too few points to gain anything, are drawn
+//      in full.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef LINE_DECIMATOR_H
+#define LINE_DECIMATOR_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "vertex_source.h"
+
+//***************************************************************************
+// Class: Line_Decimator
+//
+// Class definitions:
+//   Line_Decimator -- Draw long line strips through a few points per
+//     pixel column
+//
+// Classes referenced:
+//   Plot_Window, Worker_Pool
+//
+// Purpose: Keep, for each brush of one plot, the indices of the points of
+//   its strip that are drawn for the current view.
+//
+// Functions:
+//   Line_Decimator() -- Constructor
+//
+//   update( brush, vertices, *indices, count, xmin, xmax, ncolumns) --
+//     Decimate a brush's strip for a view, if worthwhile
+//   order( brush) -- Indices of the points kept
+//   data_changed() -- Discard everything because the vertices changed
+//
+//   summarize( strip) -- Check a strip for increasing x and summarize it
+//   decimate_columns( strip) -- Decimate an increasing strip by column
+//   decimate_runs( strip) -- Decimate any strip by runs
+//
+// Static functions:
+//   check_chunk( begin, end, ichunk, *data) -- Body of the summary pass
+//   column_chunk( begin, end, ichunk, *data) -- Body of the column pass
+//   run_chunk( begin, end, ichunk, *data) -- Body of the run pass
+//   keep( *kept, first, lowest, highest, last) -- Add a column's points
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Line_Decimator
+{
+  public:
+    // Strip positions per block of the summary, and points per pixel
+    // column below which a strip is drawn in full
+    static const int block_size = 1024;
+    static const int min_points_per_column = 4;
+
+  protected:
+    // One brush's strip, what its kept points were made for, and the
+    // positions of the lowest and highest point of each block
+    struct Strip {
+      Vertex_Source vertices;
+      const unsigned int *indices;
+      int count;
+      int generation;
+      int increasing;
+      std::vector<int> block_low, block_high;
+      float xmin, xmax;
+      int ncolumns;
+      std::vector<unsigned int> kept;
+
+      // Per-chunk results of the parallel passes
+      std::vector<int> chunk_increasing;
+      std::vector< std::vector<unsigned int> > chunk_kept;
+    };
+    Strip strips_[ NBRUSHES];
+
+    void summarize( Strip &strip);
+    void decimate_columns( Strip &strip);
+    void decimate_runs( Strip &strip);
+
+    static void check_chunk( int begin, int end, int ichunk, void *data);
+    static void column_chunk( int begin, int end, int ichunk, void *data);
+    static void run_chunk( int begin, int end, int ichunk, void *data);
+    static void keep(
+      std::vector<unsigned int> &kept, const Strip &strip,
+      int first, int lowest, int highest, int last);
+
+  public:
+    Line_Decimator();
+
+    int update(
+      int brush, const Vertex_Source &vertices, const unsigned int *indices,
+      int count, float xmin, float xmax, int ncolumns);
+    const unsigned int *order( int brush)
+    { return &(strips_[ brush].kept[0]);}
+    void data_changed();
+};
+
+#endif   // LINE_DECIMATOR_H
@@ -0,0 +1,296 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: matrix_window.cpp
+//
+// Class definitions:
+//   Matrix_Window -- One GL window that draws every plot as a cell
+//
+// Classes referenced:
+//   Plot_Window -- Draws each cell and handles its events
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    OGLEXP 1.2.2 -- Access to OpenGL extension under Windows
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <matrix_window.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "matrix_window.h"
+#include "plot_window.h"
+#include "control_panel_window.h"
+#include "column_buffers.h"
+#include "progressive_renderer.h"
+
+//***************************************************************************
+// Matrix_Window::Matrix_Window( x, y, w, h) -- Constructor.  Ask for the
+// same framebuffer as a plot window.
+Matrix_Window::Matrix_Window( int x, int y, int w, int h) :
+  Fl_Gl_Window( x, y, w, h, "viewpoints"),
+  cell_w_( w), cell_h_( h), grab_( -1), hover_( -1),
+  framebuffer_( 0), framebuffer_w_( 0), framebuffer_h_( 0),
+  framebuffer_epoch_( -1)
+{
+  renderbuffers_[0] = renderbuffers_[1] = 0;
+  if( can_do( FL_RGB|FL_DOUBLE|FL_ALPHA|FL_DEPTH|FL_STENCIL))
+    mode( FL_RGB|FL_DOUBLE|FL_ALPHA|FL_DEPTH|FL_STENCIL);
+  else mode( FL_RGB|FL_DOUBLE|FL_ALPHA|FL_DEPTH);
+  end();
+}
+
+//***************************************************************************
+// Matrix_Window::arrange( argc, argv, no_border) -- STATIC method to create
+// the window the first time, covering the area the plot windows would have,
+// then fit the cells to the current rows and columns and show it.  The
+// command line arguments are passed to show() as for plot windows.
+void Matrix_Window::arrange( int argc, char **argv, int no_border)
+{
+  if( !matrix_mode || headless_mode || nplots <= 0) return;
+
+  if( matrix_window == NULL) {
+    Plot_Window *first = pws[0], *last = pws[nplots-1];
+    Fl_Group::current( 0);
+    matrix_window =
+      new Matrix_Window(
+        first->x(), first->y(),
+        last->x() + last->w() - first->x(), last->y() + last->h() - first->y());
+    matrix_window->size_range( 10*ncols, 10*nrows);
+    matrix_window->resizable( matrix_window);
+    if( no_border) matrix_window->border( 0);
+  }
+  matrix_window->grab_ = matrix_window->hover_ = -1;
+  matrix_window->layout();
+  if( !matrix_window->shown())
+    matrix_window->show( argc, argv);
+  matrix_window->redraw();
+}
+
+//***************************************************************************
+// Matrix_Window::layout() -- Divide the window into nrows x ncols cells and
+// size each plot to its cell, so that it converts mouse positions and
+// scales its labels as it would in a window of its own.
+void Matrix_Window::layout()
+{
+  cell_w_ = ( w() - (ncols-1)*gap_) / ncols;
+  cell_h_ = ( h() - (nrows-1)*gap_) / nrows;
+  if( cell_w_ < 1) cell_w_ = 1;
+  if( cell_h_ < 1) cell_h_ = 1;
+  for( int i=0; i<nplots; i++) {
+    pws[i]->size( cell_w_, cell_h_);
+    pws[i]->schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
+  }
+}
+
+//***************************************************************************
+// Matrix_Window::resize( x, y, w, h) -- Resize the window and its cells.
+void Matrix_Window::resize( int x, int y, int w, int h)
+{
+  Fl_Gl_Window::resize( x, y, w, h);
+  layout();
+}
+
+//***************************************************************************
+// Matrix_Window::cell_origin( i, x, y) -- Upper left corner of the cell of
+// plot i, in window coordinates.
+void Matrix_Window::cell_origin( int i, int &x, int &y)
+{
+  x = (i % ncols) * ( cell_w_ + gap_);
+  y = (i / ncols) * ( cell_h_ + gap_);
+}
+
+//***************************************************************************
+// Matrix_Window::cell_at( x, y) -- Index of the plot whose cell contains
+// window position (x, y), or -1 if it is in a gap or outside the cells.
+int Matrix_Window::cell_at( int x, int y)
+{
+  if( x < 0 || y < 0) return -1;
+  int col = x / ( cell_w_ + gap_), row = y / ( cell_h_ + gap_);
+  if( col >= ncols || row >= nrows) return -1;
+  if( x - col*( cell_w_ + gap_) >= cell_w_) return -1;
+  if( y - row*( cell_h_ + gap_) >= cell_h_) return -1;
+  int i = row*ncols + col;
+  if( i >= nplots) return -1;
+  return i;
+}
+
+//***************************************************************************
+// Matrix_Window::send( i, event) -- Pass an event to plot i with the mouse
+// position made relative to its cell, as Fl_Group does for subwindows.
+int Matrix_Window::send( int i, int event)
+{
+  if( i < 0 || i >= nplots) return 0;
+  int x0, y0;
+  cell_origin( i, x0, y0);
+  int save_x = Fl::e_x, save_y = Fl::e_y;
+  Fl::e_x -= x0;
+  Fl::e_y -= y0;
+  int result = pws[i]->handle( event);
+  Fl::e_x = save_x;
+  Fl::e_y = save_y;
+  return result;
+}
+
+//***************************************************************************
+// Matrix_Window::handle( event) -- A push goes to the plot under the mouse,
+// which then receives the drag and release.  Keys and the mouse wheel go to
+// the plot under the mouse.
+int Matrix_Window::handle( int event)
+{
+  switch( event) {
+    case FL_ENTER:
+    case FL_MOVE:
+      hover_ = cell_at( Fl::event_x(), Fl::event_y());
+      return 1;
+
+    case FL_LEAVE:
+      hover_ = -1;
+      return 1;
+
+    case FL_FOCUS:
+    case FL_UNFOCUS:
+      return 1;
+
+    case FL_PUSH:
+      grab_ = cell_at( Fl::event_x(), Fl::event_y());
+      if( grab_ < 0) return 1;
+      hover_ = grab_;
+      return send( grab_, event);
+
+    case FL_DRAG:
+      return send( grab_, event);
+
+    case FL_RELEASE:
+    {
+      int result = send( grab_, event);
+      grab_ = -1;
+      return result;
+    }
+
+    case FL_KEYDOWN:
+    case FL_KEYUP:
+    case FL_MOUSEWHEEL:
+      hover_ = cell_at( Fl::event_x(), Fl::event_y());
+      return send( hover_, event);
+
+    default:
+      return Fl_Gl_Window::handle( event);
+  }
+}
+
+//***************************************************************************
+// Matrix_Window::redraw_cell( i) -- Draw plot i's cell with the next frame,
+// leaving the other cells as they are.
+void Matrix_Window::redraw_cell( int i)
+{
+  if( i < 0 || i >= nplots) return;
+  if( (int) dirty_.size() < nplots) dirty_.resize( nplots, 1);
+  dirty_[ i] = 1;
+  damage( FL_DAMAGE_USER1);
+}
+
+//***************************************************************************
+// Matrix_Window::bind_framebuffer( remade) -- Bind the framebuffer the
+// window's image is kept in, making it again, and setting remade, if the
+// window's size or the GL context changed.  Returns 0, with the window's
+// own framebuffer bound, if framebuffer objects can't be used.
+int Matrix_Window::bind_framebuffer( int &remade)
+{
+  remade = 0;
+  if( !Progressive_Renderer::available()) return 0;
+  if( framebuffer_ != 0 && framebuffer_epoch_ == Column_Buffers::epoch() &&
+      framebuffer_w_ == w() && framebuffer_h_ == h()) {
+    glBindFramebuffer( GL_FRAMEBUFFER, framebuffer_);
+    return 1;
+  }
+
+  if( framebuffer_ != 0 && framebuffer_epoch_ == Column_Buffers::epoch()) {
+    glDeleteRenderbuffers( 2, renderbuffers_);
+    glDeleteFramebuffers( 1, &framebuffer_);
+  }
+  framebuffer_w_ = w();
+  framebuffer_h_ = h();
+  framebuffer_epoch_ = Column_Buffers::epoch();
+  remade = 1;
+  glGenFramebuffers( 1, &framebuffer_);
+  glBindFramebuffer( GL_FRAMEBUFFER, framebuffer_);
+  glGenRenderbuffers( 2, renderbuffers_);
+  glBindRenderbuffer( GL_RENDERBUFFER, renderbuffers_[ 0]);
+  glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, w(), h());
+  glFramebufferRenderbuffer(
+    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers_[ 0]);
+  glBindRenderbuffer( GL_RENDERBUFFER, renderbuffers_[ 1]);
+  glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w(), h());
+  glFramebufferRenderbuffer(
+    GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+    renderbuffers_[ 1]);
+  glBindRenderbuffer( GL_RENDERBUFFER, 0);
+  if( glCheckFramebufferStatus( GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    cerr << "Matrix_Window::bind_framebuffer: ERROR, incomplete framebuffer "
+         << "of " << w() << " by " << h() << endl;
+    glBindFramebuffer( GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers( 2, renderbuffers_);
+    glDeleteFramebuffers( 1, &framebuffer_);
+    framebuffer_ = 0;
+    return 0;
+  }
+  return 1;
+}
+
+//***************************************************************************
+// Matrix_Window::draw() -- Draw the cells that need it into the kept image
+// and copy that to the window.  Cells are clipped with the scissor test
+// because plots clear the whole viewport.  Damage from anything but
+// redraw_cell() draws every cell, and clears the gaps with the rest of the
+// image unless a plot accumulates frames.
+void Matrix_Window::draw()
+{
+  if( !valid()) valid( 1);
+  if( (int) dirty_.size() < nplots) dirty_.resize( nplots, 1);
+
+  int remade = 0;
+  int kept = bind_framebuffer( remade);
+  if( !kept || remade || ( damage() & ~FL_DAMAGE_USER1)) {
+    int accumulating = 0;
+    for( int i=0; i<nplots; i++)
+      if( pws[i]->cp->dont_clear->value()) accumulating = 1;
+    if( !accumulating || remade) {
+      glDisable( GL_SCISSOR_TEST);
+      glClearColor( 0.25, 0.25, 0.25, 0.0);
+      glClear( GL_COLOR_BUFFER_BIT);
+    }
+    for( int i=0; i<nplots; i++) dirty_[ i] = 1;
+  }
+
+  // GL counts rows from the bottom of the window
+  glEnable( GL_SCISSOR_TEST);
+  for( int i=0; i<nplots; i++) {
+    if( !dirty_[ i]) continue;
+    dirty_[ i] = 0;
+    int x0, y0;
+    cell_origin( i, x0, y0);
+    int y_gl = h() - y0 - cell_h_;
+    glScissor( x0, y_gl, cell_w_, cell_h_);
+    pws[i]->draw_cell( x0, y_gl);
+  }
+  glDisable( GL_SCISSOR_TEST);
+
+  if( kept) {
+    glBindFramebuffer( GL_FRAMEBUFFER, 0);
+    glBindFramebuffer( GL_READ_FRAMEBUFFER, framebuffer_);
+    glBlitFramebuffer(
+      0, 0, w(), h(), 0, 0, w(), h(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer( GL_FRAMEBUFFER, 0);
+  }
+}
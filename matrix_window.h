@@ -0,0 +1,118 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: matrix_window.h
+//
+// Class definitions:
+//   Matrix_Window -- One GL window that draws every plot as a cell
+//
+// Classes referenced:
+//   Plot_Window -- Draws each cell and handles its events
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Matrix view for viewpoints.  Instead of one window, context, and
+//   buffer swap per plot, the nrows x ncols array of plots is drawn as the
+//   cells of a single window, in a single context, with one swap per frame.
+//
+// General design philosophy:
+//   1) Plot windows still exist, with their control panels, state, and
+//      event handlers, but they are never shown.  Each is sized to its
+//      cell, and draws itself with its ordinary draw() method into the
+//      cell's viewport, scissored so that clearing stays inside the cell.
+//   2) Every plot draws from the same column buffers, index buffers,
+//      sprites, and shader, which now live in one context instead of being
+//      shared between many.
+//   3) Mouse events go to the plot in the cell under the mouse, or to the
+//      plot where a drag began, with coordinates relative to the cell, so
+//      brushing, panning, and zooming work as they do in separate windows.
+//   4) The window's image is kept in a framebuffer object of its own,
+//      since the back buffer holds nothing from the last frame.  Only the
+//      cells of plots that need to be drawn again are drawn into it, and
+//      the whole of it is copied to the back buffer, so one spinning or
+//      brushed plot doesn't redraw every other cell.  Exposing or resizing
+//      the window draws every cell.  Without framebuffer objects, every
+//      cell is drawn each time.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef MATRIX_WINDOW_H
+#define MATRIX_WINDOW_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Matrix_Window
+//
+// Class definitions:
+//   Matrix_Window -- One GL window that draws every plot as a cell
+//
+// Classes referenced:
+//   Plot_Window -- Draws each cell and handles its events
+//
+// Purpose: Derived class of Fl_Gl_Window that lays out, draws, and routes
+//   events to the plots of the matrix view.
+//
+// Functions:
+//   Matrix_Window( x, y, w, h) -- Constructor
+//
+//   redraw_cell( i) -- Draw plot i's cell with the next frame
+//
+//   draw() -- Draw the cells that need it
+//   bind_framebuffer( &remade) -- Bind the framebuffer the image is kept in
+//   handle( event) -- Pass events to the plot of a cell
+//   resize( x, y, w, h) -- Resize the window and its cells
+//   layout() -- Size each plot to its cell
+//   cell_at( x, y) -- Index of the plot at a window position, or -1
+//   cell_origin( i, &x, &y) -- Upper left corner of a plot's cell
+//   send( i, event) -- Pass an event to a plot, relative to its cell
+//
+// Static functions:
+//   arrange( argc, argv, no_border) -- Create, lay out, and show the window
+//     for the plots
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Matrix_Window : public Fl_Gl_Window
+{
+  protected:
+    // Pixels between cells
+    static const int gap_ = 2;
+
+    // Cell size, and the plots that receive drags and keys
+    int cell_w_, cell_h_;
+    int grab_, hover_;
+
+    // Framebuffer that keeps the image, its size and set of contexts, and
+    // the cells to draw into it with the next frame
+    GLuint framebuffer_, renderbuffers_[ 2];
+    int framebuffer_w_, framebuffer_h_, framebuffer_epoch_;
+    std::vector<int> dirty_;
+
+    void draw();
+    int bind_framebuffer( int &remade);
+    int handle( int event);
+    void layout();
+    int cell_at( int x, int y);
+    void cell_origin( int i, int &x, int &y);
+    int send( int i, int event);
+
+  public:
+    Matrix_Window( int x, int y, int w, int h);
+    void resize( int x, int y, int w, int h);
+    void redraw_cell( int i);
+
+    static void arrange( int argc, char **argv, int no_border);
+};
+
+#endif   // MATRIX_WINDOW_H
@@ -19,7 +19,14 @@
 // Compiler directives:
 //   May require D__WIN32__ for the C++ compiler
 //
-// Purpose: Source code for <Plot_Window.h>
+// Purpose: Source code for <Plot_Window.h>.  The points are drawn from
+//   vertex buffers.  The axes, grid, labels, and histograms are drawn from
+//   a display list rather than a vertex buffer and a glyph atlas.  They
+//   are a few thousand vertices drawn in immediate mode, the labels are
+//   drawn by gl_draw from FLTK's own glyph display lists, and FLTK has no
+//   way to render its fonts into a texture.  A display list keeps all of
+//   that on the GPU as it is, and works in the compatibility profile the
+//   rest of the drawing already needs.
 //
 // Author: Creon Levit    2005-2006
 // Modified: Nathan Schmidt  01-SEP-2008
@@ -37,8 +44,14 @@
 #include "plot_window.h"
 #include "control_panel_window.h"
 #include "sprite_textures.h"
+#include "symbol_atlas.h"
 #include "brush.h"
 #include "column_info.h"
+#include "brush_statistics.h"
+#include "column_profile.h"
+#include "selection_history.h"
+#include "selection_worker.h"
+#include "brush_algebra.h"
 
 // experimental
 #define ALPHA_TEXTURE
@@ -75,6 +88,17 @@ int Plot_Window::sprites_initialized = 0;
 void *Plot_Window::global_GLContext = NULL;
 int Plot_Window::indexVBOsinitialized = 0;
 int Plot_Window::indexVBOsfilled = 0;
+Column_Buffers::Ring Plot_Window::index_rings[NBRUSHES];
+
+// Record of the last gather of the selection
+blitz::Array<int,1> Plot_Window::gathered_selection;
+std::vector<int> Plot_Window::changed_points;
+std::vector<int> Plot_Window::changed_from;
+int Plot_Window::selection_delta_valid = 0;
+int Plot_Window::selection_generation = 0;
+
+// Match mode used by the most recent string search
+int Plot_Window::string_match_mode = Column_Info::MATCH_SUBSTRING;
 #define BUFFER_OFFSET(vbo_offset) ((char *)NULL + (vbo_offset))
 
 // Declarations for global methods defined and used by class Plot_Window.
@@ -122,17 +146,45 @@ void Plot_Window::initialize()
   do_reset_view_with_show = 0;
   show_center_glyph = 0;
   selection_changed = 0;
+  needs_redraw = 0;
+  draw_seconds = next_spin = spin_time = 0.0;
 
   VBOinitialized = 0;
   VBOfilled = false;
-
-  // Resize arrays
-  vertices.resize( npoints, 3);
+  for( int axis=0; axis<3; axis++) {
+    axis_buffers[axis] = 0;
+    axis_keys[axis] = Column_Buffers::private_key( index, axis);
+    axis_functions[axis] = Column_Buffers::FUNCTION_NONE;
+  }
+  axis_mix = 0;
+  axis_buffers_epoch = Column_Buffers::epoch();
+  axis_buffers_filled = false;
+  decoration_list = 0;
+  decoration_list_epoch = Column_Buffers::epoch();
+  decorations_changed = 1;
+  cell_x = cell_y = 0;
+
+  // Resize arrays.  Density levels, distinct positions, and decimated
+  // lines describe the old vertices.  The vertices themselves are
+  // allocated when extract_data_points() fills them, if it does.
+  density_renderer.data_changed();
+  point_collapser.data_changed();
+  line_decimator.data_changed();
+  vertices.free();
+  vertices_filled = 0;
+  vertices_deferred = 0;
+  vertex_source.clear();
+  for( int axis=0; axis<3; axis++) vertex_columns[axis].free();
   nbins[0] = nbins[1] = nbins[2] = nbins_default;
   counts.resize( nbins_max+2, 3);
   counts_selected.resize( nbins_max+2, 3);
 
-  if( can_do(FL_RGB|FL_DOUBLE|FL_ALPHA|FL_DEPTH|FL_STENCIL)) {
+  // Without a display, can_do() can't be asked.  Offscreen framebuffers
+  // have every plane.
+  if( headless_mode) {
+    mode( FL_RGB|FL_DOUBLE|FL_ALPHA|FL_DEPTH|FL_STENCIL);
+  }
+  else if( can_do(FL_RGB|FL_DOUBLE|FL_ALPHA|FL_DEPTH|FL_STENCIL)) {
     mode( FL_RGB|FL_DOUBLE|FL_ALPHA|FL_DEPTH|FL_STENCIL);
     cout << " mode: FL_RGB|FL_DOUBLE|FL_ALPHA|FL_DEPTH|FL_STENCIL" << endl;
   }
@@ -274,26 +326,26 @@ void Plot_Window::update_linked_transforms()
         p->cp->x_normalization_style->value() == style1) {
       p->xscale = xscale; 
       p->xcenter = xcenter;
-      p->needs_redraw = 1;
+      p->schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
     }
     else if( p->cp->varindex1->value() == axis2 && 
              p->cp->x_normalization_style->value() == style2) {
       p->xscale = yscale; 
       p->xcenter = ycenter;
-      p->needs_redraw = 1;
+      p->schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
     }
 
     if( p->cp->varindex2->value() == axis1 && 
         p->cp->y_normalization_style->value() == style1) {
       p->yscale = xscale; 
       p->ycenter = xcenter;
-      p->needs_redraw = 1;
+      p->schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
     }
     else if( p->cp->varindex2->value() == axis2 && 
              p->cp->y_normalization_style->value() == style2) {
       p->yscale = yscale; 
       p->ycenter = ycenter;
-      p->needs_redraw = 1;
+      p->schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
     }
 
     // This is needed to make sure the scale marks on the axis are 
@@ -309,12 +361,20 @@ int Plot_Window::handle( int event)
 {
   // Current plot window (button pushes, mouse drags, etc) must get redrawn 
   // before others so that selections get colored correctly.  Ugh.
+  // A drag being evaluated on the worker thread must be finished before 
+  // anything else touches the selection
+  if( ( event == FL_PUSH || event == FL_KEYDOWN) &&
+      selection_worker != NULL && selection_worker->active()) {
+    if( selection_worker->finish()) redraw_all_plots( index);
+  }
+
   switch( event) {
     active_plot = index;
 
     // Mouse button push
     case FL_PUSH:
       DEBUG(cout << "FL_PUSH at " << xprev << ", " << yprev << endl);
+      Point_Sampler::note_interaction();
 
       // Show the control panel associated with this plot window.
       cpt->value(cps[this->index]);  
@@ -344,7 +404,7 @@ int Plot_Window::handle( int event)
       else if( Fl::event_state(FL_BUTTON3) || 
                (Fl::event_state() == (FL_BUTTON1 | FL_ALT)) ) {
         show_center_glyph = 1;
-        needs_redraw = 1;
+        schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
       }
 
       // left button pushed => start new selection, or start translating 
@@ -392,6 +452,7 @@ int Plot_Window::handle( int event)
     // Mouse drag
     case FL_DRAG:
       DEBUG (printf ("FL_DRAG, event_state: %x\n", Fl::event_state()));
+      Point_Sampler::note_interaction();
       xcur = Fl::event_x();
       ycur = Fl::event_y();
 
@@ -410,7 +471,7 @@ int Plot_Window::handle( int event)
         DEBUG ( cout << "translating (xcenter, ycenter) = (" << xcenter << ", " << ycenter << ")" << endl);
         // redraw ();
         show_center_glyph = 1;
-        needs_redraw = 1;
+        schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
         update_linked_transforms ();
       }
 
@@ -428,7 +489,7 @@ int Plot_Window::handle( int event)
           DEBUG ( cout << "scaling (xscale, yscale) = (" << xscale << ", " << yscale << ")" << endl);
         }
         // redraw();
-        needs_redraw = 1;
+        schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
         update_linked_transforms ();
       }
 
@@ -460,6 +521,16 @@ int Plot_Window::handle( int event)
           if( defer_redraws_button->value()) {
             redraw_one_plot ();
           } 
+
+          // Publish the footprint to the worker thread and redraw only 
+          // this plot, so the box keeps up with the cursor.  The worker's
+          // results are installed and drawn as they arrive.
+          else if( async_selection && selection_worker != NULL) {
+            if( !selection_worker->active()) selection_worker->begin( this);
+            if( xdown!=xtracked || ydown!=ytracked)
+              selection_worker->publish( xdown, ydown, xtracked, ytracked);
+            redraw_one_plot ();
+          }
           else {
             handle_selection ();
             redraw_all_plots (index);
@@ -473,6 +544,7 @@ int Plot_Window::handle( int event)
     // Mouse button up
     case FL_RELEASE:   
       DEBUG (cout << "FL_RELEASE at " << Fl::event_x() << ", " << Fl::event_y() << endl);
+      Point_Sampler::end_interaction();
       if( show_center_glyph) {
         show_center_glyph = 0;
       }
@@ -480,9 +552,14 @@ int Plot_Window::handle( int event)
         handle_selection();
         redraw_all_plots(index);
       }
+      else if( selection_worker != NULL && selection_worker->active()) {
+        selection_worker->finish();
+        redraw_all_plots(index);
+      }
       else {
         redraw_one_plot();
       }
+      record_selection();
       return 1;
 
     // keypress, key is in Fl::event_key(), ascii in Fl::event_text().  Return 
@@ -507,6 +584,12 @@ int Plot_Window::handle( int event)
           delete_selection( (Fl_Widget *) NULL);
           return 1;
 
+        // Undo or (with shift) redo the last change to the selection
+        case 'z':
+          if( Fl::event_shift()) redo_selection( (Fl_Widget *) NULL);
+          else undo_selection( (Fl_Widget *) NULL);
+          return 1;
+
         // Invert or restore (uninvert) selected and nonselected
         case 'i':
           invert_selection();
@@ -557,17 +640,39 @@ int Plot_Window::handle( int event)
             label,
             "Search for a string in the %s-axis variable, '%s'",
             cAxis, Data_File_Manager::column_info[col].label.c_str());
-          make_find_window( label, buf);
-          if( buf[0]) {
-            select_on_string( buf, col);
+
+          // Save the selection so the search can be previewed and undone
+          blitz::Range NPTS( 0, npoints-1);
+          search_column = col;
+          search_newly_selected_save.resize( npoints);
+          search_newly_selected_save( NPTS) = newly_selected( NPTS);
+          search_selected_save.resize( npoints);
+          search_selected_save( NPTS) = selected( NPTS);
+
+          if( make_find_window( 
+                label, buf, &string_match_mode, 
+                preview_string_search, (void*) this) == 1 && buf[0]) {
+            newly_selected( NPTS) = search_newly_selected_save( NPTS);
+            selected( NPTS) = search_selected_save( NPTS);
+            select_on_string( buf, col, string_match_mode);
+          }
+          else {
+            // Search was cancelled, so undo any preview
+            newly_selected( NPTS) = search_newly_selected_save( NPTS);
+            selected( NPTS) = search_selected_save( NPTS);
+            color_array_from_selection();
+            redraw_all_plots( index);
           }
+          search_newly_selected_save.free();
+          search_selected_save.free();
+          record_selection();
           return 1;
         }
 
         // toggle grid
         case 'g':
           cp->show_grid->value(1-cp->show_grid->value());
-          needs_redraw = 1;
+          schedule_redraw( Frame_Scheduler::REDRAW_DECORATION);
           return 1;
 
       // Unrecognized key pressed: do nothing
@@ -595,6 +700,7 @@ int Plot_Window::handle( int event)
     // Mouse wheel, zoom in both the x and y axes
     case FL_MOUSEWHEEL:
       if(1) { 
+        Point_Sampler::note_interaction();
         float wheel_zoom_rate = 100.0;
         float wheel_size_rate = 5.0;
         float dy = Fl::event_dy();
@@ -610,7 +716,7 @@ int Plot_Window::handle( int event)
           xscale *= 1 - dy / wheel_zoom_rate;
           yscale *= 1 - dy / wheel_zoom_rate;
         }
-        needs_redraw = 1;
+        schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
         update_linked_transforms();
         // make sure grids & axis ticks get updated since we've changed the view.
         screen_to_world (-1, -1, wmin[0], wmin[1]);
@@ -635,17 +741,54 @@ void Plot_Window::reset_selection_box()
 }
 
 //***************************************************************************
-// Plot_Window::redraw_one_plot() -- Invoke member functions to compute 
-// histograms and redraw one plot.
+// Plot_Window::redraw_one_plot() -- Redraw one plot, with its histograms, 
+// after one of its settings has changed.
 void Plot_Window::redraw_one_plot ()
 {
   DEBUG( cout << "in redraw_one_plot" << endl ) ;
+  schedule_redraw( Frame_Scheduler::REDRAW_DECORATION);
+}
+
+//***************************************************************************
+// Plot_Window::schedule_redraw( reason) -- Record why this plot needs to be
+// drawn again and make sure the next frame will draw it.  See 
+// Frame_Scheduler for the reasons.  Any reason but the next frame of a
+// progressive drawing starts that drawing over.
+void Plot_Window::schedule_redraw( int reason)
+{
+  needs_redraw |= reason;
+  int changes = reason & ~Frame_Scheduler::REDRAW_PROGRESS;
+  if( changes & ~Frame_Scheduler::REDRAW_VIEW) decorations_changed = 1;
+  if( changes) progressive_renderer.restart();
+  Frame_Scheduler::wake();
+}
+
+//***************************************************************************
+// Plot_Window::render_offscreen() -- Compute histograms and draw the plot 
+// into the framebuffer bound in the current GL context.  Used for plots 
+// that are never shown, so draw() must set up the viewport every time.
+void Plot_Window::render_offscreen()
+{
   compute_histograms();
-  redraw();
-  //Fl::flush();
+  valid( 0);
+  draw();
+  glFinish();
   needs_redraw = 0;
 }
 
+//***************************************************************************
+// Plot_Window::draw_cell( x, y) -- Draw the plot into its cell of the 
+// matrix window, whose lower left corner is at (x, y).  The matrix window's
+// context is shared by every cell, so draw() must set up the viewport and 
+// projection every time.
+void Plot_Window::draw_cell( int x, int y)
+{
+  cell_x = x;
+  cell_y = y;
+  valid( 0);
+  draw();
+}
+
 //***************************************************************************
 // Plot_Window::reset_view() -- Reset pan, zoom, and angle.
 void Plot_Window::reset_view()
@@ -693,12 +836,13 @@ void Plot_Window::reset_view()
 
   // Reset selection box and flag window as needing redraw
   reset_selection_box ();
-  needs_redraw = 1;
+  schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
 
-  // Make sure the window is visible and resizable.  NOTE: For some reason, 
-  // it is necessary to turn this off when a new plot window array is 
-  // created or the windows will not be resizable!
-  if( do_reset_view_with_show & !visible()) {
+  // Make sure the window is visible and resizable, unless the matrix window
+  // draws it.  NOTE: For some reason, it is necessary to turn this off when
+  // a new plot window array is created or the windows will not be 
+  // resizable!
+  if( do_reset_view_with_show & !visible() && !headless_mode && !matrix_mode) {
     this->show();
     this->resizable( this);
   }
@@ -709,6 +853,7 @@ void Plot_Window::reset_view()
 void Plot_Window::draw() 
 {
   DEBUG (cout << "in draw: " << xcenter << " " << ycenter << " " << xscale << " " << yscale << " " << wmin[0] << " " << wmax[0] << endl);
+  double start_time = Point_Sampler::now();
 
   // the valid() property can avoid reinitializing matrix for 
   // each redraw:
@@ -717,7 +862,7 @@ void Plot_Window::draw()
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     glOrtho(-1, 1, -1, 1, 1000, -1000);
-    glViewport(0, 0, w(), h());
+    glViewport(cell_x, cell_y, w(), h());
     glDisable(GL_LIGHTING);
     glDisable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
@@ -737,10 +882,19 @@ void Plot_Window::draw()
   glMatrixMode(GL_MODELVIEW);
   glLoadIdentity();
   glTranslatef( xzoomcenter*xscale, yzoomcenter*yscale, zzoomcenter*zscale);
-  if( cp->spin->value())
-    angle += cp->rot_slider->value()/100.0;
-  else
+  // Spinning turns the plot by rot_slider degrees per second, however
+  // often it is drawn
+  if( cp->spin->value()) {
+    if( spin_time > 0.0)
+      angle +=
+        cp->rot_slider->value() *
+        min( start_time - spin_time, Frame_Scheduler::max_spin_step);
+    spin_time = start_time;
+  }
+  else {
     angle = cp->rot_slider->value();
+    spin_time = 0.0;
+  }
   glRotatef(angle, 0.0, 1.0, 0.1);
   glScalef (xscale, yscale, zscale);
   //magnification = ((xscale+yscale)/2.0) / initial_scale;
@@ -755,23 +909,46 @@ void Plot_Window::draw()
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
   }
 
-  if( use_VBOs) {
-    if( !VBOinitialized) initialize_VBO();
-    if( !VBOfilled) fill_VBO();
-    if( !indexVBOsinitialized) initialize_indexVBOs();
-    if( !indexVBOsfilled) fill_indexVBOs();
-  }
+  // Frame_Scheduler::draw_frame() usually uploaded what this plot draws
+  // from already, but not when the window was simply exposed
+  upload_buffers();
 
   draw_background ();
-  draw_data_points();
+
+  // Draw either the points or their density.  Points are drawn at
+  // xscale*(x-xcenter), so the view spans 1/xscale either side of xcenter.
+  // The styles before DENSITY_LOG draw points, perhaps collapsed.
+  int density_style = cp->density_menu->value();
+  if( density_style >= Control_Panel_Window::DENSITY_LOG) {
+    if( cp->show_points->value()) {
+      density_renderer.draw(
+        this, density_style,
+        xcenter - 1.0/xscale, xcenter + 1.0/xscale,
+        ycenter - 1.0/yscale, ycenter + 1.0/yscale);
+    }
+  }
+  else draw_data_points();
+
+  // Textures of density levels discarded since the last draw, and not
+  // reused by this one, are deleted while this plot's context is current
+  density_renderer.free_textures();
+
+  if( cp->show_contours->value()) draw_contours();
   if( selection_changed) {
     draw_selection_information();
   }
   draw_center_glyph();
-  draw_axes();
-  draw_grid();
-  draw_histograms ();
+  draw_decorations();
   draw_resize_knob();
+
+  // Fence the streamed buffers this plot drew from, so the next update of
+  // each can tell whether the GPU is done with it
+  if( use_VBOs) {
+    for( int i=0; i<NBRUSHES; i++) Column_Buffers::fence_ring( index_rings[i]);
+    Column_Buffers::fence_brush_ids();
+  }
+  draw_seconds =
+    max( Point_Sampler::now() - start_time, point_sampler.seconds());
 }
 
 //***************************************************************************
@@ -801,9 +978,8 @@ void Plot_Window::center_on_click( int x, int y)
     yscale /= 1.5;
     xscale /= 1.5;
   }
-  needs_redraw = 1;
+  schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
   update_linked_transforms ();
-  redraw_one_plot();
 }
 
 //***************************************************************************
@@ -822,7 +998,7 @@ void Plot_Window::draw_resize_knob()
 
   // Print a widget in lower-right to show where lower corner of the window is
   gl_font( FL_HELVETICA_BOLD, 11);
-  glWindowPos2i( (w()-(int)gl_width(buf1)) - 1, 3);
+  glWindowPos2i( cell_x + (w()-(int)gl_width(buf1)) - 1, cell_y + 3);
   gl_draw( (const char *) buf1);
   
   glDisable( GL_COLOR_LOGIC_OP);
@@ -862,7 +1038,11 @@ void Plot_Window::draw_grid()
   if( cp->show_grid->value()) {
     glDisable( GL_DEPTH_TEST);
     glBlendFunc(GL_ONE, GL_ZERO);
-    gl_font( FL_HELVETICA_BOLD, 10);
+
+    // FLTK draws text with fonts from the display, so there are no labels
+    // without one
+    const int show_labels = !headless_mode;
+    if( show_labels) gl_font( FL_HELVETICA_BOLD, 10);
     
     const int nticks = 10;
 
@@ -913,7 +1093,7 @@ void Plot_Window::draw_grid()
         DEBUG (printf("(%s)\n", temp));
         float wx, wy;
         screen_to_world (0, -1.15, wx, wy); // tweaked offsets
-        gl_draw( temp, x-gl_width(temp)/(w()*xscale), wy);        
+        if( show_labels) gl_draw( temp, x-gl_width(temp)/(w()*xscale), wy);
       }
       // lines of constant y, where y is nice
       for (double y=nicemin_y+d_y; y<=nicemax_y-0.9999*d_y; y+=d_y) // was: for (y=nicemin; y<nicemax+.5*d; y+=d)
@@ -928,7 +1108,7 @@ void Plot_Window::draw_grid()
         sprintf(temp2, format_str_y, y);
         float wx, wy;
         screen_to_world (+1.1, 0, wx, wy); // tweaked offsets
-        gl_draw( temp2, wx, y-0.5*gl_height()/((h()*yscale)));
+        if( show_labels) gl_draw( temp2, wx, y-0.5*gl_height()/((h()*yscale)));
       }
     }
   }
@@ -1004,7 +1184,10 @@ void Plot_Window::draw_axes()
     float c = initial_pscale;
     glScalef( c, c, c);
 
-    gl_font( FL_HELVETICA, 10);
+    // FLTK draws text with fonts from the display, so there are no labels
+    // without one
+    const int show_labels = !headless_mode;
+    if( show_labels) gl_font( FL_HELVETICA, 10);
     glBlendFunc( GL_ONE, GL_ZERO);
     if( cp->Bkg->value() <= 0.4)
       glColor4f( 0.7,0.7,0.0,0.0);
@@ -1033,7 +1216,7 @@ void Plot_Window::draw_axes()
       glEnd();
 
       // Draw axes labels.  Scope is restricted so we can reuse 'b'?
-      {
+      if( show_labels) {
         // offset for axis labels values. b<1 -> inwards, 
         // b>1 -> outwards, b==1 -> on axis.
         float b = 2; 
@@ -1093,16 +1276,20 @@ void Plot_Window::draw_axes()
 
         // build and draw strings corresponding to left and right bounds of X-axis
         char left[1024], right[1024];
-        interval_to_strings(cp->varindex1->value(), wmin[0], wmax[0], left, right);
-        gl_draw( left, -1.0-gl_width(left)/(w()), -(1+b*a));
-        gl_draw( right, +1.0-gl_width(right)/(w()), -(1+b*a));
+        if( show_labels) {
+          interval_to_strings(cp->varindex1->value(), wmin[0], wmax[0], left, right);
+          gl_draw( left, -1.0-gl_width(left)/(w()), -(1+b*a));
+          gl_draw( right, +1.0-gl_width(right)/(w()), -(1+b*a));
+        }
 
         b = 2.4;
 
         // build and draw strings corresponding to "left" and "right" bounds of Y-axis
-        interval_to_strings(cp->varindex2->value(), wmin[1], wmax[1], left, right);
-        gl_draw( left, -(1+b*a), -1.0f+a/4);
-        gl_draw( right, -(1+b*a), +1.0f+a/4);
+        if( show_labels) {
+          interval_to_strings(cp->varindex2->value(), wmin[1], wmax[1], left, right);
+          gl_draw( left, -(1+b*a), -1.0f+a/4);
+          gl_draw( right, -(1+b*a), +1.0f+a/4);
+        }
 
       }
 
@@ -1112,6 +1299,64 @@ void Plot_Window::draw_axes()
   }
 }
 
+//***************************************************************************
+// Plot_Window::draw_decorations() -- Draw the axes, grid, and histograms 
+// from a display list.  The list is compiled again only when something 
+// besides the view was changed by schedule_redraw, or the plot was panned, 
+// zoomed, or resized.  Rotating doesn't matter: the grid is drawn in the 
+// current modelview, and the axes and histograms load their own.  The list
+// belongs to the GL contexts FLTK shares between plots, so it lives until 
+// they are destroyed or release_buffers deletes it.  The labels' calls to
+// FLTK's glyph lists are compiled into it, which is why it isn't a vertex
+// buffer.
+void Plot_Window::draw_decorations()
+{
+  const float view[ ndecoration_view] = {
+    xscale, yscale, zscale, xcenter, ycenter, zcenter,
+    xzoomcenter, yzoomcenter, zzoomcenter, xhscale, yhscale,
+    wmin[0], wmin[1], wmax[0], wmax[1], (float) w(), (float) h()};
+
+  if( decoration_list_epoch != Column_Buffers::epoch()) {
+    decoration_list = 0;
+    decoration_list_epoch = Column_Buffers::epoch();
+  }
+  if( decoration_list == 0) {
+    decoration_list = glGenLists( 1);
+    decorations_changed = 1;
+  }
+
+  int same_view = 1;
+  for( int i=0; i<ndecoration_view; i++)
+    if( view[i] != decoration_view[i]) same_view = 0;
+
+  // Without a list, draw directly
+  if( decoration_list == 0) {
+    draw_axes();
+    draw_grid();
+    draw_histograms();
+    return;
+  }
+
+  // FLTK makes display lists of a font's glyphs the first time it is used,
+  // and lists can't be made while one is being compiled, so load the fonts
+  // of the labels first
+  if( decorations_changed || !same_view) {
+    if( !headless_mode) {
+      gl_font( FL_HELVETICA, 10);
+      gl_font( FL_HELVETICA_BOLD, 10);
+      gl_font( FL_HELVETICA_BOLD, 11);
+    }
+    glNewList( decoration_list, GL_COMPILE);
+    draw_axes();
+    draw_grid();
+    draw_histograms();
+    glEndList();
+    for( int i=0; i<ndecoration_view; i++) decoration_view[i] = view[i];
+    decorations_changed = 0;
+  }
+  glCallList( decoration_list);
+}
+
 //***************************************************************************
 // Plot_Window::draw_center_glyph() -- Draw a glyph in the center of the 
 // window, as an aid for positioning in preparation to zooming.
@@ -1160,7 +1405,7 @@ void Plot_Window::print_selection_stats ()
   // LR-centered, upper 95th percentile of the window
   snprintf( buf1, sizeof(buf1), "%8d (%5.2f%%) selected", nselected, 100.0*nselected/(float)npoints);
   gl_font( FL_HELVETICA_BOLD, 11);
-  glWindowPos2i( (w()-(int)gl_width(buf1))/2, 95*h()/100);
+  glWindowPos2i( cell_x + (w()-(int)gl_width(buf1))/2, cell_y + 95*h()/100);
   gl_draw( (const char *) buf1);
 
   gl_font( FL_HELVETICA, 10);
@@ -1193,8 +1438,6 @@ void Plot_Window::print_selection_stats ()
 // calling draw_selection_information().
 void Plot_Window::handle_selection ()
 {
-  blitz::Range NPTS( 0, npoints-1);  
-
   if (xdown==xtracked && ydown==ytracked) return;
 
   // Identify newly-selected points.
@@ -1210,20 +1453,24 @@ void Plot_Window::handle_selection ()
   footprint xxx = BRUSH_BOX;
   switch (xxx) {
   case BRUSH_BOX:
-    inside_footprint(NPTS) =
-      where( ( vertices( NPTS, 0)>fmaxf( xdown, xtracked) || 
-               vertices( NPTS, 0)<fminf( xdown, xtracked) ||
-               vertices( NPTS, 1)>fmaxf( ydown, ytracked) || 
-               vertices( NPTS, 1)<fminf( ydown, ytracked)),
-             0, 1);
+    {
+      float xmin = fminf( xdown, xtracked), xmax = fmaxf( xdown, xtracked);
+      float ymin = fminf( ydown, ytracked), ymax = fmaxf( ydown, ytracked);
+      for( int i=0; i<npoints; i++) {
+        float x = vertex_source.value( 0, i), y = vertex_source.value( 1, i);
+        inside_footprint( i) = !( x>xmax || x<xmin || y>ymax || y<ymin);
+      }
+    }
     break;
   case BRUSH_CIRCLE:
     {
       float xs = xscale*w(), ys=yscale*h();
       float dist2 = pow2((xtracked-xdown)*xs) + pow2((ytracked-ydown)*ys);
-      inside_footprint(NPTS) =
-        where( ( (pow2((vertices(NPTS,0)-xdown)*xs) + pow2((vertices(NPTS,1)-ydown)*ys)) > dist2),
-               0, 1);
+      for( int i=0; i<npoints; i++) {
+        float x = vertex_source.value( 0, i), y = vertex_source.value( 1, i);
+        inside_footprint( i) =
+          !( ( pow2((x-xdown)*xs) + pow2((y-ydown)*ys)) > dist2);
+      }
     }
     break;
   default:
@@ -1276,22 +1523,77 @@ void Plot_Window::update_selection_from_footprint()
 // using the properties of its corresponding brush.
 void Plot_Window::color_array_from_selection()
 {
+  // Density binning passes may be reading the gathered selection
+  for( int i=0; i<nplots; i++)
+    if( pws[i] != NULL) pws[i]->density_renderer.wait();
+
   // Loop: initialize brush counts to zero
   for( int i=0; i<NBRUSHES; i++) {
     brushes[i]->count = 0;
   }
 
+  // If there was no previous gather for these data, every point has 
+  // changed
+  int delta_valid = 1;
+  if( gathered_selection.rows() != npoints) {
+    gathered_selection.resize( npoints);
+    gathered_selection = -1;
+    delta_valid = 0;
+  }
+  changed_points.clear();
+  changed_from.clear();
+  int max_changes = npoints/4;
+
+  // A brush's index array only differs from its last gather after the 
+  // first point to join or leave the brush, so note where that is
+  int dirty_from[NBRUSHES];
+  for( int i=0; i<NBRUSHES; i++) dirty_from[i] = -1;
+
   // Loop: Examine successive points to fill the index arrays and their
-  // associated counts
+  // associated counts, and record the points whose brush has changed.
+  // Past a quarter of the points, consumers are better off starting over.
   int set, count=0;
   for( int i=0; i<npoints; i++) {
     set = selected(i);
     count = brushes[set]->count++;
     indices_selected( set, count) = i;
+    if( gathered_selection(i) != set) {
+      int from = gathered_selection(i);
+      if( dirty_from[set] < 0) dirty_from[set] = count;
+      if( from >= 0 && dirty_from[from] < 0)
+        dirty_from[from] = brushes[from]->count;
+      if( delta_valid) {
+        if( (int) changed_points.size() < max_changes) {
+          changed_points.push_back( i);
+          changed_from.push_back( gathered_selection(i));
+        }
+        else {
+          delta_valid = 0;
+          changed_points.clear();
+          changed_from.clear();
+        }
+      }
+      gathered_selection(i) = set;
+    }
   }
+  selection_delta_valid = delta_valid;
+  selection_generation++;
   nselected = npoints - brushes[0]->count;
   // assert(sum(number_selected(blitz::Range(0,nplots))) == (unsigned int)npoints);
-  indexVBOsfilled = 0;
+
+  // Each buffer of the index rings may be several gathers behind, so the
+  // rings keep the earliest change to each brush until it is filled
+  for( int i=0; i<NBRUSHES; i++) {
+    if( dirty_from[i] < 0) continue;
+    Column_Buffers::mark_ring( index_rings[i], dirty_from[i], npoints);
+    indexVBOsfilled = 0;
+  }
+
+  // Update anyone who tracks the selection incrementally
+  if( brush_statistics != NULL) brush_statistics->update_from_selection_delta();
+  if( column_profile != NULL) column_profile->update_from_selection_delta();
+  for( int i=0; i<nplots; i++)
+    if( pws[i] != NULL) pws[i]->density_renderer.update_from_selection_delta();
 }
 
 //***************************************************************************
@@ -1336,6 +1638,53 @@ void Plot_Window::draw_data_points()
   int z_bufferring_enabled = 0;
   int current_sprite = 0;
 
+  // If requested, draw each distinct position of each brush once, unless
+  // a brush with points is drawn as line strips.
+  int show_brush0 = 
+    show_deselected_button->value() && cp->show_deselected_points->value();
+  int collapse_style =
+    cp->density_menu->value() - Control_Panel_Window::DENSITY_COLLAPSED;
+  int collapsed = collapse_style >= 0;
+  for( int i=0; i<NBRUSHES && collapsed; i++)
+    if( ( i > 0 || show_brush0) && brushes[i]->count > 0 &&
+        brushes[i]->symbol_menu->value() == 1) collapsed = 0;
+  collapsed = collapsed && point_collapser.update( vertex_source, npoints);
+
+  // When zoomed in, draw only the points near the view.  While the user
+  // is interacting, draw a sample of those if they won't all fit in this
+  // plot's budget.  Line strips are always drawn in full, since either
+  // would connect the wrong points.  Collapsed points are always drawn in
+  // full too.
+  int culled = !collapsed && select_visible_points();
+  int ntotal = 0, ndrawn = 0;
+  for( int i=0; i<NBRUSHES && !collapsed; i++)
+    if( ( i > 0 || show_brush0) && brushes[i]->symbol_menu->value() != 1)
+      ntotal += culled ? point_sampler.total( i) : brushes[i]->count;
+  if( !collapsed)
+    point_sampler.begin_frame( this, cp->spin->value(), ntotal);
+
+  // Plots with more points than fit in one frame, and no line strips, can
+  // draw them over several frames into a framebuffer of their own.  A
+  // frame that starts over draws the background there, as draw() did in
+  // the window.
+  int progressive =
+    progressive_rendering && !collapsed && !headless_mode &&
+    !cp->spin->value() && cp->dont_clear->value() == 0 &&
+    !point_sampler.reduced() && ntotal > point_sampler.budget() &&
+    Progressive_Renderer::available() && point_sampler.ordered();
+  for( int i=0; i<NBRUSHES && progressive; i++)
+    if( ( i > 0 || show_brush0) && brushes[i]->count > 0 &&
+        brushes[i]->symbol_menu->value() == 1) progressive = 0;
+  progressive =
+    progressive &&
+    progressive_renderer.begin( w(), h(), ntotal, point_sampler.budget());
+  if( !progressive) progressive_renderer.restart();
+  int restarting = !progressive || progressive_renderer.restarting();
+  if( progressive) {
+    if( restarting) draw_background();
+    if( !progressive_renderer.complete()) point_sampler.time_frame();
+  }
+
   // Are we plotting in two dimensions or three?
   if( cp->varindex3->value() != nvars) {
     if (cp->z_bufferring_button->value()) {
@@ -1345,9 +1694,20 @@ void Plot_Window::draw_data_points()
     }
   }
 
-  // Tell the GPU where to find the vertices for this plot.
-  if (use_VBOs) {
+  // Tell the GPU where to find the vertices for this plot.  Collapsed
+  // points are drawn from client memory.
+  int shared_buffers =
+    !collapsed && use_VBOs && axis_buffers_filled &&
+    Column_Buffers::bind( axis_buffers, axis_functions, axis_mix);
+  if (shared_buffers) {
+    CHECK_GL_ERROR("binding shared column buffers");
+  }
+  else if (collapsed) {
+    if (use_VBOs) glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+  else if (use_VBOs) {
     // bind VBO for vertex data
+    if (!VBOinitialized) initialize_VBO();
     glBindBuffer(GL_ARRAY_BUFFER, index+1);
 
     // If the variables we are plotting were changed, then the vertex VBO must 
@@ -1358,6 +1718,7 @@ void Plot_Window::draw_data_points()
     glVertexPointer (3, GL_FLOAT, 0, BUFFER_OFFSET(0));
   }
   else {
+    fill_vertices();
     glVertexPointer (3, GL_FLOAT, 0, (GLfloat *)vertices.data()); 
   }
 
@@ -1374,8 +1735,10 @@ void Plot_Window::draw_data_points()
     
     case Control_Panel_Window::BLEND_BRUSHES_SEPARATELY:
       glEnable(GL_STENCIL_TEST);
-      clear_stencil_buffer();
-      clear_alpha_planes();
+      if( restarting) {
+        clear_stencil_buffer();
+        clear_alpha_planes();
+      }
       glBlendFunc(GL_SRC_ALPHA, GL_DST_ALPHA);
       break; 
     
@@ -1409,16 +1772,38 @@ void Plot_Window::draw_data_points()
     first_brush=NBRUSHES-1; brush_step=-1;
   }
 
+  // If nothing is left out, try to draw every brush in one call
+  int drawn_at_once =
+    shared_buffers && !culled && !point_sampler.reduced() && !progressive &&
+    draw_brushes_at_once(
+      blending_mode, show_brush0, z_bufferring_enabled, current_sprite);
+  if( drawn_at_once) ndrawn = ntotal;
+
   // Loop: Draw successive brished in reverse order    
-  for( int brush_num=0, brush_index=first_brush; brush_num<NBRUSHES; brush_num++, brush_index+=brush_step) {
+  int offset = 0;
+  for( int brush_num=0, brush_index=first_brush; brush_num<NBRUSHES && !drawn_at_once; brush_num++, brush_index+=brush_step) {
 
     // don't draw nonselected points (brush[0]) if we are hiding nonselected points in this plot
-    if (brush_index == 0 && (!show_deselected_button->value() || !cp->show_deselected_points->value())) {
+    if (brush_index == 0 && !show_brush0) {
       continue;
     }
 
     Brush *brush = brushes[brush_index];
     unsigned int count = brush->count;
+    if( collapsed) count = point_collapser.total( brush_index);
+    int sampled = 
+      !collapsed && ( culled || point_sampler.reduced()) &&
+      brush->symbol_menu->value() != 1;
+    if( sampled) count = point_sampler.prefix( brush_index);
+
+    // Drawn progressively, a brush draws its part of this frame's stretch
+    // of the points of all brushes
+    int first = 0;
+    if( progressive) {
+      int length = culled ? point_sampler.total( brush_index) : count;
+      count = progressive_renderer.segment( offset, length, first);
+      offset += length;
+    }
     
     // If some points were selected in this set, render them
     if(count > 0) {
@@ -1429,11 +1814,19 @@ void Plot_Window::draw_data_points()
         glStencilOp (GL_KEEP, GL_KEEP, GL_REPLACE);
       }
 
-      // Set the pointsize for this brush (hard limit from 1 to 100)
-      // note this is a combination of the brush's size and per-plot scaling
-      float size = brush->pointsize->value() * powf(2.0, cp->size->value());
-      if (cp->scale_points->value()) {
-        size = magnification*size;
+      // Set the pointsize and color for this brush (hard limit from 1 to 100)
+      float size;
+      GLfloat color[4];
+      brush_appearance( brush, size, color);
+
+      // Make up for the points left out of a sample: with overplotting,
+      // cover the same area; otherwise, build up the same opacity
+      if( sampled && point_sampler.reduced()) {
+        double factor = point_sampler.compensation();
+        if( blending_mode == Control_Panel_Window::BLEND_OVERPLOT)
+          size *= sqrt( factor);
+        else
+          color[3] = 1.0 - pow( 1.0 - color[3], factor);
       }
       size = min(max(size,1.0F),100.0F);
 
@@ -1445,39 +1838,76 @@ void Plot_Window::draw_data_points()
       current_sprite = brush->symbol_menu->value();
       assert ((current_sprite >= 0) && (current_sprite < NSYMBOLS));
       GLenum element_mode;
+      float point_size = size;
       switch (current_sprite) {
         case 0:
           element_mode = GL_POINTS;
           enable_regular_points();
-          glPointSize(size);
+          glPointSize(point_size);
           break;
         case 1:
           element_mode = GL_LINE_STRIP;
+          disable_sprites();
           glLineWidth(size);
           break;
         default:
           element_mode = GL_POINTS;
           enable_sprites(current_sprite);
-          glPointSize(size+2); // sprites cover fewer pixels, in general
+          point_size = size+2; // sprites cover fewer pixels, in general
+          glPointSize(point_size);
           break;
       }
 
       // set the color for this set of points
-      float lum0 = cp->lum->value();
-      float lum1 = pow2(brush->lum1->value()), lum2 = pow2(brush->lum2->value());
-      float alpha = brush->alpha->value();
-      // float alpha0 = brush->alpha0->value();
-      double r = lum0*lum2*(brush->color_chooser->r()+lum1);
-      double g = lum0*lum2*(brush->color_chooser->g()+lum1);
-      double b = lum0*lum2*(brush->color_chooser->b()+lum1);
-      double a = alpha;
-      // cout << "plot " << index << ", brush " << brush->index << ", (r,g,b,a) = (" << r << ", " << g << ", " << b << ", " << a << ")" << endl;
-      glColor4d(r,g,b,a);
-
-      // then render the points
-      if (use_VBOs) {
-        assert (VBOinitialized && VBOfilled && indexVBOsinitialized && indexVBOsfilled) ;
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, MAXPLOTS+1+brush_index); 
+      glColor4fv( color);
+
+      // Long line strips are drawn through the first, last, lowest, and
+      // highest point of each pixel column, unless the view is rotated
+      int nkept = 0;
+      if( current_sprite == 1 && !collapsed && angle == 0.0) {
+        blitz::Array<unsigned int, 1> strip =
+          indices_selected( brush_index, blitz::Range( 0, npoints-1));
+        nkept = line_decimator.update(
+          brush_index, vertex_source, strip.data(), (int) count,
+          xcenter - 1.0/xscale, xcenter + 1.0/xscale, w());
+      }
+
+      // then render the points.  Samples, culled points, points drawn
+      // progressively, and decimated lines come from client memory,
+      // whether or not VBOs are in use.
+      ndrawn += count;
+      if( collapsed) {
+        point_collapser.draw( brush_index, collapse_style, point_size, color);
+        CHECK_GL_ERROR("drawing collapsed points");
+      }
+      else if( nkept > 0) {
+        if (use_VBOs) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glDrawElements( GL_LINE_STRIP, (GLsizei)nkept, GL_UNSIGNED_INT, line_decimator.order( brush_index));
+        CHECK_GL_ERROR("drawing a decimated line strip");
+      }
+      else if( progressive) {
+        // Overplotting with alpha depends on the order of the points, so
+        // unless culled they keep the order of the data
+        const unsigned int *indices = point_sampler.order( brush_index);
+        blitz::Array<unsigned int, 1> tmpArray;
+        if( !culled && blending_mode == Control_Panel_Window::BLEND_OVERPLOT_WITH_ALPHA) {
+          tmpArray.reference( indices_selected( brush_index, blitz::Range( 0, npoints-1)));
+          indices = tmpArray.data();
+        }
+        if (use_VBOs) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glDrawElements( element_mode, (GLsizei)count, GL_UNSIGNED_INT, indices + first);
+        CHECK_GL_ERROR("drawing points progressively");
+      }
+      else if( sampled) {
+        if (use_VBOs) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glDrawElements( element_mode, (GLsizei)count, GL_UNSIGNED_INT, point_sampler.order( brush_index));
+        CHECK_GL_ERROR("drawing a sample or subset of points");
+      }
+      else if (use_VBOs) {
+        // Index VBOs are usually filled by upload_buffers() already
+        if (!indexVBOsfilled) fill_indexVBOs();
+        assert ((shared_buffers || (VBOinitialized && VBOfilled)) && indexVBOsinitialized && indexVBOsfilled) ;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Column_Buffers::ring_buffer( index_rings[brush_index])); 
         glDrawElements( element_mode, (GLsizei)count, GL_UNSIGNED_INT, BUFFER_OFFSET(0)); // would it bee faster to use glDrawRangeElements() ?
         // make sure we succeeded 
         CHECK_GL_ERROR("drawing points from VBO");
@@ -1491,7 +1921,12 @@ void Plot_Window::draw_data_points()
     }
   }
   
+  if( !collapsed) point_sampler.end_frame( ndrawn);
+
   // potentially turn off various gl state variables that are specific to this routine.
+  if (shared_buffers) {
+    Column_Buffers::unbind();
+  }
   if (z_bufferring_enabled) {
     glDisable( GL_DEPTH_TEST);
   }
@@ -1506,24 +1941,196 @@ void Plot_Window::draw_data_points()
 #ifdef ALPHA_TEXTURE
   glDisable(GL_ALPHA_TEST);
 #endif // ALPHA_TEXTURE
+
+  // Show the points drawn so far, and ask for more until all are drawn
+  if( progressive) {
+    progressive_renderer.end( cell_x, cell_y);
+    if( !progressive_renderer.complete())
+      schedule_redraw( Frame_Scheduler::REDRAW_PROGRESS);
+  }
+}
+
+//***************************************************************************
+// Plot_Window::brush_appearance( brush, size, color) -- Get the point size
+// and color of a brush in this plot.  The size combines the brush's size
+// and per-plot scaling, and is not yet limited.
+void Plot_Window::brush_appearance( Brush *brush, float &size, GLfloat color[4])
+{
+  size = brush->pointsize->value() * powf(2.0, cp->size->value());
+  if (cp->scale_points->value()) {
+    size = magnification*size;
+  }
+
+  float lum0 = cp->lum->value();
+  float lum1 = pow2(brush->lum1->value()), lum2 = pow2(brush->lum2->value());
+  // float alpha0 = brush->alpha0->value();
+  color[0] = lum0*lum2*(brush->color_chooser->r()+lum1);
+  color[1] = lum0*lum2*(brush->color_chooser->g()+lum1);
+  color[2] = lum0*lum2*(brush->color_chooser->b()+lum1);
+  color[3] = brush->alpha->value();
+}
+
+//***************************************************************************
+// Plot_Window::draw_brushes_at_once( blending_mode, show_brush0, 
+// z_buffering, sprite) -- Draw every point of every brush in one call from
+// the shared column buffers, with each point's brush choosing its color,
+// size, and symbol in the shader.  Line strips can't be drawn this way,
+// since one call has one primitive.  Brushes that overplot are ordered by
+// giving each brush its own depth.  Brushes blended separately first mark
+// the highest brush at each pixel in the depth buffer, then only that
+// brush's points are blended there, which is what the stencil does when
+// brushes are drawn one at a time.  Returns 0, having drawn nothing, if the
+// points must be drawn brush by brush.
+int Plot_Window::draw_brushes_at_once(
+  int blending_mode, int show_brush0, int z_buffering, int &sprite)
+{
+  if( gathered_selection.rows() != npoints) return 0;
+
+  // Alpha compositing depends on the order of the points, which this
+  // would change
+  if( blending_mode == Control_Panel_Window::BLEND_OVERPLOT_WITH_ALPHA)
+    return 0;
+  int depth =
+    blending_mode == Control_Panel_Window::BLEND_OVERPLOT ||
+    blending_mode == Control_Panel_Window::BLEND_BRUSHES_SEPARATELY;
+  if( depth) {
+    GLint depth_bits = 0;
+    glGetIntegerv( GL_DEPTH_BITS, &depth_bits);
+    if( z_buffering || depth_bits == 0) return 0;
+  }
+
+  // No brush with points to draw may use line strips.  Note the largest
+  // symbol, which is 0 if none are drawn as sprites.
+  GLint symbols[NBRUSHES];
+  int largest = -1;
+  for( int i=0; i<NBRUSHES; i++) {
+    symbols[i] = brushes[i]->symbol_menu->value();
+    if( brushes[i]->count == 0 || ( i == 0 && !show_brush0)) continue;
+    if( symbols[i] == 1) return 0;
+    largest = max( largest, (int) symbols[i]);
+  }
+  if( largest < 0) return 0;
+
+#ifdef ALPHA_TEXTURE
+  // Every brush must have the same alpha cutoff
+  for( int i=1; i<NBRUSHES; i++)
+    if( brushes[i]->cutoff->value() != brushes[0]->cutoff->value()) return 0;
+  glAlphaFunc(GL_GREATER, brushes[0]->cutoff->value());
+#endif //ALPHA_TEXTURE
+
+  // Fill the tables of colors and sizes.  Hidden brushes have size 0.
+  GLfloat colors[NBRUSHES][4], sizes[NBRUSHES];
+  for( int i=0; i<NBRUSHES; i++) {
+    brush_appearance( brushes[i], sizes[i], colors[i]);
+    sizes[i] = min(max(sizes[i],1.0F),100.0F);
+    if( symbols[i] > 0) sizes[i] += 2; // sprites cover fewer pixels, in general
+    if( i == 0 && !show_brush0) sizes[i] = 0;
+  }
+  if( !Column_Buffers::use_brushes( colors, sizes, symbols, depth)) return 0;
+
+  // If any brush uses a symbol, draw every point as a sprite.  Plain 
+  // points are square either way.
+  sprite = largest;
+  if( largest == 0) enable_regular_points();
+  else enable_sprites( largest);
+
+  // Stencil tests are replaced by depth tests
+  glDisable( GL_STENCIL_TEST);
+  if( depth) {
+    glClearDepth( 0.0);
+    glClear( GL_DEPTH_BUFFER_BIT);
+    glEnable( GL_DEPTH_TEST);
+    glDepthFunc( GL_GEQUAL);
+  }
+  if( blending_mode == Control_Panel_Window::BLEND_BRUSHES_SEPARATELY) {
+    glColorMask( GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDrawArrays( GL_POINTS, 0, npoints);
+    glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthFunc( GL_EQUAL);
+    glDepthMask( GL_FALSE);
+  }
+  glDrawArrays( GL_POINTS, 0, npoints);
+  CHECK_GL_ERROR("drawing all brushes at once");
+  if( depth) {
+    glDepthMask( GL_TRUE);
+    glDisable( GL_DEPTH_TEST);
+  }
+  return 1;
+}
+
+//***************************************************************************
+// Plot_Window::select_visible_points() -- If the view shows only a small 
+// part of the data, have point_sampler draw just the points in a box 
+// around it.  Candidates are the points whose x (or y) lies in the box,
+// found by binary search of the rank order of whichever axis leaves fewer
+// of them.  Returns 1 if points are being culled.
+int Plot_Window::select_visible_points()
+{
+  // The view must be an unrotated x-y projection, with ranks that order
+  // the vertices along at least one axis
+  int usable[2] = { rank_orders_vertices( 0), rank_orders_vertices( 1)};
+  if( angle != 0.0 || cp->spin->value() || !( usable[0] || usable[1])) {
+    point_sampler.use_all();
+    return 0;
+  }
+
+  // The view, padded by the radius of the largest point allowed.  The 
+  // lists cover a box with half the view's size again on each side, so 
+  // they last through small pans and zooms.
+  float xpad = 1.0 + 100.0/w(), ypad = 1.0 + 100.0/h();
+  float view[4] = {
+    xcenter - xpad/xscale, xcenter + xpad/xscale,
+    ycenter - ypad/yscale, ycenter + ypad/yscale};
+  if( point_sampler.visible( view[0], view[1], view[2], view[3])) return 1;
+  float box[4] = {
+    view[0] - 0.5*( view[1]-view[0]), view[1] + 0.5*( view[1]-view[0]),
+    view[2] - 0.5*( view[3]-view[2]), view[3] + 0.5*( view[3]-view[2])};
+
+  // Loop: Find the ranks whose coordinate lies in the box along each axis
+  int first[2] = { 0, 0}, last[2] = { npoints, npoints}, best = -1;
+  for( int axis=0; axis<2; axis++) {
+    if( !usable[axis]) continue;
+    const int *rank = ( axis == 0) ? x_rank.data() : y_rank.data();
+    int lo = 0, hi = npoints;
+    while( lo < hi) {
+      int mid = lo + ( hi-lo)/2;
+      if( vertex_source.value( axis, rank[mid]) < box[2*axis]) lo = mid+1;
+      else hi = mid;
+    }
+    first[axis] = lo;
+    hi = npoints;
+    while( lo < hi) {
+      int mid = lo + ( hi-lo)/2;
+      if( vertex_source.value( axis, rank[mid]) <= box[2*axis+1]) lo = mid+1;
+      else hi = mid;
+    }
+    last[axis] = lo;
+    if( best < 0 || last[axis]-first[axis] < last[best]-first[best])
+      best = axis;
+  }
+
+  // Unless most points are culled, the index VBOs are faster
+  if( last[best]-first[best] > npoints/4) {
+    point_sampler.use_all();
+    return 0;
+  }
+  const int *rank = ( best == 0) ? x_rank.data() : y_rank.data();
+  return point_sampler.use_box(
+    rank + first[best], last[best]-first[best], vertex_source, box);
 }
 
 //***************************************************************************
-// Plot_Window::compute_histogram( axis) -- If requested, compute equi-width 
-// histogram for axis 'axis'.
+// Plot_Window::compute_histogram( axis) -- If requested, compute histogram 
+// for axis 'axis', with equal-width, equal-depth, or adaptive bins.
 //
-// MCL XXX this should be split into two routines, one for computing the 
-// histogram for all the points, the other for selected points, and _neither_ 
-// of them needs to be called as often as they are.  The first only needs to 
-// be called in extract_and_redraw(), and the second only when the selection 
-// changes (but it must be called for all plots in that case), or when {x,y}bins 
-// changes (in that case, only for one plot).  The way it is, a lot of extra 
-// time is burned here if any histograms are being shown.
+// The counts come from histogram_engine[axis], which caches the histogram 
+// of all the points until the next extract, keeps the histograms of every
+// brush, and updates them from the selection delta while brushing.  So 
+// this is cheap to call on every redraw; all that is left here is 
+// normalizing the counts for the current brush.
 // Note - we could experiment with openGL histograms...but they seem to suck.
-//
-// MCL XXX also note that if we want to get rid of the vertices() instance 
-// variable to save memory, which should be doable since vertices are copied 
-// into VBOs, then we will have to do something else here.
+// The coordinates are read through vertex_source, so plots drawn from 
+// shared columns need no vertices() of their own.
 void Plot_Window::compute_histogram( int axis)
 {
   int marginal    = cp->show_histogram[axis]->menu()[Control_Panel_Window::HISTOGRAM_MARGINAL].value();
@@ -1535,31 +2142,46 @@ void Plot_Window::compute_histogram( int axis)
     return;
   }
 
-  // Get number of bins, initialize arrays, and set range
+  // Get the binning mode.  Adaptive modes treat the number of bins as a 
+  // maximum.
+  int mode = Histogram_Engine::BINS_EQUAL_WIDTH;
+  const Fl_Menu_Item *items = cp->show_histogram[axis]->menu();
+  if( items[Control_Panel_Window::HISTOGRAM_EQUAL_DEPTH].value())
+    mode = Histogram_Engine::BINS_EQUAL_DEPTH;
+  else if( items[Control_Panel_Window::HISTOGRAM_FREEDMAN_DIACONIS].value())
+    mode = Histogram_Engine::BINS_FREEDMAN_DIACONIS;
+  else if( items[Control_Panel_Window::HISTOGRAM_BAYESIAN_BLOCKS].value())
+    mode = Histogram_Engine::BINS_BAYESIAN_BLOCKS;
+
+  // The column's ranks also order the plotted coordinates, so adaptive 
+  // edges can be read from them
+  const int *order = NULL;
+  if( mode != Histogram_Engine::BINS_EQUAL_WIDTH && rank_orders_vertices( axis))
+    order = ( axis == 0) ? x_rank.data() : y_rank.data();
+
+  // Get number of bins and bring the cached counts up to date
   int nbins = (int) (exp2(cp->nbins_slider[axis]->value()));
   if( nbins <= 0) return;
+  histogram_engine[axis].update(
+    vertex_source, axis, weighted,
+    nbins, amin[axis], amax[axis], mode, order);
+  nbins = histogram_engine[axis].nbins();
   blitz::Range BINS( 0, nbins-1);
-  counts( BINS, axis) = 0.0;
 
-  counts_selected( BINS, axis) = 0.0;
-  // range is tweaked by (n+1)/n to get the "last" point into the correct bin.
-  float range = (amax[axis] - amin[axis]) * ((float)(npoints+1)/(float)npoints); 
-
-  // only count points that are being selected by the most recent brush
+  // only show points that are being selected by the most recent brush
   Brush *bp = dynamic_cast <Brush*> (brushes_tab->value());
   assert (bp);
   int brush_index = bp->index; 
 
-  // Loop: sum over successive points to load histogram arrays
-  for( int i=0; i<npoints; i++) {
-    float x = vertices( i, axis);
-    // MCL XXX presently, weighting is based on the z-axis variable.  Weighting variable should really be a pulldown of is own.
-    float weight = weighted?vertices(i,2):1.0;
-    int bin = (int)(floorf( nbins * ( ( x - amin[axis]) / range)));
-    if( bin < 0) bin = 0;
-    if( bin > nbins-1) bin = nbins-1;
-    counts( bin, axis) += weight;
-    if( selected( i) == brush_index) counts_selected( bin, axis)+=weight;
+  // Loop: copy counts for all points and for the current brush.  Bins of
+  // unequal width show counts per unit width.
+  for( int bin=0; bin<nbins; bin++) {
+    float width = 1.0;
+    if( mode != Histogram_Engine::BINS_EQUAL_WIDTH)
+      width = histogram_engine[axis].edge( bin+1) - histogram_engine[axis].edge( bin);
+    counts( bin, axis) = histogram_engine[axis].marginal( bin) / width;
+    counts_selected( bin, axis) = 
+      histogram_engine[axis].brush_count( brush_index, bin) / width;
   }
   float maxcount = max(max(counts(BINS,axis)), 1.0f);
   
@@ -1580,36 +2202,37 @@ void Plot_Window::compute_histograms()
 }
 
 //***************************************************************************
-// Plot_Window::draw_x_histogram( bin_counts, nbins) -- Draw x histogram
+// Plot_Window::draw_x_histogram( bin_counts, nbins) -- Draw x histogram, 
+// using the bin edges from the histogram engine.
 void Plot_Window::draw_x_histogram(
   const blitz::Array<float,1> bin_counts, const int nbins)
 {
-  float x = amin[0];
-  float xwidth = (amax[0]-amin[0]) / (float)(nbins);
   glBegin( GL_LINE_STRIP);
-  for( int bin=0; bin<nbins; bin++, x+=xwidth) {
+  for( int bin=0; bin<nbins; bin++) {
+    float x = histogram_engine[0].edge( bin);
+    float xnext = histogram_engine[0].edge( bin+1);
     glVertex2f( x, 0.0); // lower left corner
     glVertex2f( x, bin_counts( bin, 0));   // left edge
-    glVertex2f( x+xwidth, bin_counts( bin, 0));   // top edge
-    glVertex2f( x+xwidth,0.0);   // right edge 
+    glVertex2f( xnext, bin_counts( bin, 0));   // top edge
+    glVertex2f( xnext,0.0);   // right edge 
   }
   glEnd();
 }
 
 //***************************************************************************
-// Plot_Window::draw_y_histogram( bin_counts, nbins) -- Draw x histogram
+// Plot_Window::draw_y_histogram( bin_counts, nbins) -- Draw y histogram, 
+// using the bin edges from the histogram engine.
 void Plot_Window::draw_y_histogram(
   const blitz::Array<float,1> bin_counts, const int nbins)
 {
-  float y = amin[1];
-  float ywidth = (amax[1]-amin[1]) / (float)(nbins);
   glBegin( GL_LINE_STRIP);
   for( int bin=0; bin<nbins; bin++) {
+    float y = histogram_engine[1].edge( bin);
+    float ynext = histogram_engine[1].edge( bin+1);
     glVertex2f( 0.0, y);          
     glVertex2f(bin_counts(bin),y);   // bottom
-    glVertex2f(bin_counts(bin), y+ywidth);   // right edge
-    glVertex2f(0.0, y+ywidth);   // top edge 
-    y+=ywidth;
+    glVertex2f(bin_counts(bin), ynext);   // right edge
+    glVertex2f(0.0, ynext);   // top edge 
   }
   glEnd();
 }
@@ -1627,8 +2250,12 @@ void Plot_Window::draw_histograms()
   int y_selection   = cp->show_histogram[1]->menu()[Control_Panel_Window::HISTOGRAM_SELECTION].value();
   int y_conditional = cp->show_histogram[1]->menu()[Control_Panel_Window::HISTOGRAM_CONDITIONAL].value();
 
+  // smooth density estimates are drawn with the histograms
+  int x_kde = cp->show_histogram[0]->menu()[Control_Panel_Window::HISTOGRAM_KDE].value();
+  int y_kde = cp->show_histogram[1]->menu()[Control_Panel_Window::HISTOGRAM_KDE].value();
+
   // if no axis has any histograms enabled, return immediately
-  if (! (x_marginal || x_selection || x_conditional || y_marginal || y_selection || y_conditional)) {
+  if (! (x_marginal || x_selection || x_conditional || y_marginal || y_selection || y_conditional || x_kde || y_kde)) {
     return;
   }
 
@@ -1640,6 +2267,12 @@ void Plot_Window::draw_histograms()
   if (xbins <= 0 && ybins <= 0)
     return;
 
+  // adaptive binning may use fewer bins than the slider asks for
+  if( xbins > 0 && histogram_engine[0].nbins() > 0) 
+    xbins = histogram_engine[0].nbins();
+  if( ybins > 0 && histogram_engine[1].nbins() > 0) 
+    ybins = histogram_engine[1].nbins();
+
   // histograms base is this far from edge of window
   float hoffset = 0.1; 
 
@@ -1648,7 +2281,7 @@ void Plot_Window::draw_histograms()
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
   // x-axis histograms
-  if ((x_marginal || x_selection || x_conditional) && xbins > 0) {
+  if ((x_marginal || x_selection || x_conditional || x_kde) && xbins > 0) {
     blitz::Range BINS( 0, xbins-1);
     glLoadIdentity();
     glTranslatef( xzoomcenter*xscale, hoffset, 0);
@@ -1675,10 +2308,12 @@ void Plot_Window::draw_histograms()
       glColor4f( 0.5, 1.0, 1.0, 1.0);
       draw_x_histogram (scaled_bin_counts, xbins);
     }
+    // Draw smooth x-axis densities
+    if( x_kde) draw_density_curves( 0);
   }
 
   // y-axis histograms
-  if ((y_marginal || y_selection || y_conditional) && ybins > 0) {
+  if ((y_marginal || y_selection || y_conditional || y_kde) && ybins > 0) {
     blitz::Range BINS( 0, ybins-1);
     glLoadIdentity();
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -1705,11 +2340,84 @@ void Plot_Window::draw_histograms()
       glColor4f( 0.5, 1.0, 1.0, 1.0);
       draw_y_histogram (scaled_bin_counts, ybins);
     }
-
+    // Draw smooth y-axis densities
+    if( y_kde) draw_density_curves( 1);
   }
   glPopMatrix();
 }
 
+//***************************************************************************
+// Plot_Window::draw_density_curves( axis) -- Draw kernel density estimates
+// of all points, and of the current brush, along axis 'axis', in the 
+// coordinates set up for that axis's histograms.  Curves are scaled so the 
+// density of all points peaks at 1, like the histograms.
+void Plot_Window::draw_density_curves( const int axis)
+{
+  if( npoints <= 0 || !(amax[axis] > amin[axis])) return;
+  kernel_density[axis].update_1d(
+    vertex_source, axis, amin[axis], amax[axis]);
+
+  Brush *bp = dynamic_cast <Brush*> (brushes_tab->value());
+  assert (bp);
+  int ncurves = ( nselected > 0) ? 2 : 1;
+  int ngrid = kernel_density[axis].ngrid();
+  float step = (amax[axis]-amin[axis]) / (float)(ngrid-1);
+  float scale = 1.0;
+
+  // Loop: Draw the density of all points, then of the current brush
+  for( int icurve=0; icurve<ncurves; icurve++) {
+    const std::vector<double> &curve = 
+      kernel_density[axis].curve( icurve == 0 ? -1 : bp->index);
+    if( (int) curve.size() != ngrid) return;
+    if( icurve == 0) {
+      double peak = *std::max_element( curve.begin(), curve.end());
+      if( peak <= 0.0) return;
+      scale = 1.0 / peak;
+      glColor4f( 1.0, 0.75, 0.25, 1.0);
+    }
+    else glColor4f( 1.0, 1.0, 0.5, 1.0);
+
+    glBegin( GL_LINE_STRIP);
+    for( int k=0; k<ngrid; k++) {
+      float position = amin[axis] + k*step;
+      float height = scale * curve[k];
+      if( axis == 0) glVertex2f( position, height);
+      else glVertex2f( height, position);
+    }
+    glEnd();
+  }
+}
+
+//***************************************************************************
+// Plot_Window::draw_contours() -- Draw isodensity contours of a kernel 
+// density estimate of the x-y projection.  The contours enclose the densest
+// regions holding 25, 50, 75, and 90% of the points.
+void Plot_Window::draw_contours()
+{
+  if( npoints <= 1) return;
+  joint_density.update_2d(
+    vertex_source, amin[0], amax[0], amin[1], amax[1]);
+
+  static const double fraction_list[] = { 0.25, 0.5, 0.75, 0.9};
+  std::vector<double> fractions( fraction_list, fraction_list+4);
+  const std::vector< std::vector<float> > &segments =
+    joint_density.contours( fractions);
+
+  // Inner contours are brightest
+  glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glLineWidth( 1);
+  for( unsigned int level=0; level<segments.size(); level++) {
+    const std::vector<float> &s = segments[level];
+    glColor4f( 1.0, 1.0, 1.0, 1.0 - 0.2*level);
+    glBegin( GL_LINES);
+    for( unsigned int k=0; k+3<s.size(); k+=4) {
+      glVertex2f( s[k], s[k+1]);
+      glVertex2f( s[k+2], s[k+3]);
+    }
+    glEnd();
+  }
+}
+
 //***************************************************************************
 // Plot_Window::density_1D( a, axis) -- Compute marginal density estimate 
 // along axis using equi-width histogram.  Input array a is over-written.
@@ -1718,17 +2426,13 @@ void Plot_Window::density_1D( blitz::Array<float,1> a, const int axis)
   // need to compute (but not necessarily display) the x-axis histogram if 
   // its not already there.
   if (!cp->show_histogram[axis]->value()) compute_histogram(axis);
-  int nbins = (int)(exp2(cp->nbins_slider[axis]->value()));
+  if( histogram_engine[axis].nbins() <= 0) return;
 
   // Loop: For each point, find which bin its in (since that isn't saved in 
   // compute_histogram) and set the density estimate for the point 
   // equal to the bin count
-  // range is tweaked by (n+1)/n to get the "last" point into the correct bin.
-  float range = (amax[axis] - amin[axis]) * ((float)(npoints+1)/(float)npoints); 
   for( int i=0; i<npoints; i++) {
-    int bin = (int)(floorf( nbins * ( ( vertices(i,axis) - amin[axis]) / range)));
-    if( bin < 0) bin = 0;
-    if( bin > nbins-1) bin = nbins-1;
+    int bin = histogram_engine[axis].bin_of( vertex_source.value( axis, i));
     a(i) = counts( bin, axis)/(float)npoints;
   }
 }
@@ -1941,6 +2645,22 @@ int Plot_Window::normalize(
   }
 }
 
+//***************************************************************************
+// Plot_Window::rank_orders_vertices( axis) -- The ranks of a column also 
+// order the plotted coordinates of axis 0 (x) or 1 (y), unless the data 
+// were shuffled, offset, transformed, or logged with nonpositive values.
+int Plot_Window::rank_orders_vertices( int axis)
+{
+  blitz::Array<int,1> &rank = ( axis == 0) ? x_rank : y_rank;
+  int style = ( axis == 0) ? 
+    cp->x_normalization_style->value() : cp->y_normalization_style->value();
+  return 
+    rank.rows() == npoints && vertex_source.valid() &&
+    cp->no_transform->value() && (int) cp->offset[axis]->value() == 0 &&
+    style != Control_Panel_Window::NORMALIZATION_RANDOMIZE &&
+    !( style == Control_Panel_Window::NORMALIZATION_LOG10 && tmin[axis] <= 0.0);
+}
+
 //***************************************************************************
 // Plot_Window::compute_rank( var_index) -- Order data for normalization and 
 // for the generation of histograms
@@ -2001,6 +2721,15 @@ void Plot_Window::compute_rank( int var_index)
 // Also, offsets should get reset to zero when an axis is changed.
 int Plot_Window::extract_data_points ()
 {
+  // The selection worker may be reading this plot's vertices, and cached
+  // density levels and samples describe the old ones.  The histograms and
+  // density estimates are invalidated once the new columns are in place.
+  if( selection_worker != NULL) selection_worker->finish();
+  density_renderer.data_changed();
+  point_sampler.data_changed();
+  point_collapser.data_changed();
+  line_decimator.data_changed();
+
   // Get the labels for the plot's axes
   long axis0 = (long)(cp->varindex1->mvalue()->user_data());
   long axis1 = (long)(cp->varindex2->mvalue()->user_data());
@@ -2078,6 +2807,232 @@ int Plot_Window::extract_data_points ()
   }
   if (be_verbose) cout << endl;
 
+  // Name the contents of each axis so plots showing the same column share
+  // one GPU buffer.  Styles that leave the column as it is only change
+  // amin and amax.  Log10, squash, and the sum-vs-difference transform are
+  // applied by the vertex shader to the raw column, so changing them
+  // uploads nothing.  Rank-based styles are shared as computed here.
+  // Shuffled axes, and axes changed by the other transforms, belong to
+  // this plot alone.
+  int styles[3];
+  styles[0] = cp->x_normalization_style->value();
+  styles[1] = cp->y_normalization_style->value();
+  styles[2] = cp->z_normalization_style->value();
+  long axes[3] = { axis0, axis1, axis2};
+  int on_gpu[3];
+  for( int axis=0; axis<3; axis++)
+    on_gpu[axis] =
+      styles[axis] != Control_Panel_Window::NORMALIZATION_RANDOMIZE;
+
+  // The vertex shader flushes subnormal numbers to zero, so it would draw
+  // their logs at zero rather than below -38.  Log10 axes with subnormal
+  // values are normalized here instead.
+  for( int axis=0; axis<3; axis++) {
+    if( styles[axis] != Control_Panel_Window::NORMALIZATION_LOG10 ||
+        ( axis == 2 && axis2 == nvars)) continue;
+    blitz::Array<int,1> &rank =
+      ( axis == 0) ? x_rank : ( axis == 1) ? y_rank : z_rank;
+    float least = least_positive(
+      Data_File_Manager::column_info[ axes[axis]].points( NPTS), rank);
+    if( least > 0.0 && least < FLT_MIN) on_gpu[axis] = 0;
+  }
+  axis_mix = 0;
+  if( !cp->no_transform->value()) {
+    if( !cp->sum_vs_difference->value()) on_gpu[1] = 0;
+    else if( on_gpu[0] && on_gpu[1]) axis_mix = 1;
+    else on_gpu[0] = on_gpu[1] = 0;
+  }
+  for( int axis=0; axis<3; axis++) {
+    axis_functions[axis] = Column_Buffers::FUNCTION_NONE;
+    int style = styles[axis];
+    if( axis == 2 && axis2 == nvars) {
+      axis_keys[axis] = Column_Buffers::shared_key( -1, 0, 0);
+      continue;
+    }
+    if( !on_gpu[axis]) {
+      axis_keys[axis] = Column_Buffers::private_key( index, axis);
+      continue;
+    }
+    if( style == Control_Panel_Window::NORMALIZATION_LOG10)
+      axis_functions[axis] = Column_Buffers::FUNCTION_LOG10;
+    else if( style == Control_Panel_Window::NORMALIZATION_SQUASH)
+      axis_functions[axis] = Column_Buffers::FUNCTION_SQUASH;
+    if( style != Control_Panel_Window::NORMALIZATION_RANK &&
+        style != Control_Panel_Window::NORMALIZATION_PARTIAL_RANK &&
+        style != Control_Panel_Window::NORMALIZATION_GAUSSIANIZE)
+      style = Control_Panel_Window::NORMALIZATION_NONE;
+    axis_keys[axis] = Column_Buffers::shared_key(
+      (int) axes[axis], style, (int) cp->offset[axis]->value());
+  }
+  axis_buffers_filled = false;
+
+  // When the vertex shader draws every axis from a shared column with no
+  // normalization that needs the whole column, nothing here needs the
+  // normalized and transformed vertices, so only the bounds are worked
+  // out.  The selection, histograms, and other work on the CPU read the
+  // shared columns through the shader's functions instead, and the
+  // vertices are freed.
+  if( defer_vertices()) {
+    axis_bounds( 0, axis0);
+    axis_bounds( 1, axis1);
+    if( axis2 != nvars) axis_bounds( 2, axis2);
+    else {
+      amin[2] = -1.0;
+      amax[2] = +1.0;
+    }
+
+    // The sum-vs-difference transform turns the box of x and y values by
+    // 45 degrees.  Its bounds are those of the turned box, which may be a
+    // little larger than those of the points.
+    if( !cp->no_transform->value() && cp->sum_vs_difference->value()) {
+      float c = sqrt(2.0)/2.0;
+      wmin[0] = amin[0] = c * ( vmin[0] + vmin[1]);
+      wmax[0] = amax[0] = c * ( vmax[0] + vmax[1]);
+      wmin[1] = amin[1] = c * ( vmin[1] - vmax[0]);
+      wmax[1] = amax[1] = c * ( vmax[1] - vmin[0]);
+    }
+
+    const float *columns[3];
+    long strides[3];
+    for( int axis=0; axis<3; axis++) {
+      columns[axis] = NULL;
+      strides[axis] = 0;
+      vertex_columns[axis].free();
+      if( axis == 2 && axis2 == nvars) continue;
+      vertex_columns[axis].reference(
+        Data_File_Manager::column_info[ axes[axis]].points);
+      columns[axis] = vertex_columns[axis].data();
+      strides[axis] = vertex_columns[axis].stride(0);
+    }
+    vertex_source.use_columns( columns, strides, axis_functions, axis_mix);
+    vertices.free();
+    vertices_filled = 0;
+    vertices_deferred = 1;
+    VBOfilled = false;
+  }
+  else {
+    vertices_deferred = 0;
+    for( int axis=0; axis<3; axis++) vertex_columns[axis].free();
+    compute_vertices();
+  }
+
+  // Since we're showing new data, make sure none of it gets clipped.
+  // MCL XXX - this should be done on a per-axis basis and only when necessary
+  // and not at all when simply changeing an axis offset.
+  reset_view();
+
+  histogram_engine[0].invalidate();
+  histogram_engine[1].invalidate();
+  kernel_density[0].invalidate();
+  kernel_density[1].invalidate();
+  joint_density.invalidate();
+  schedule_redraw( Frame_Scheduler::REDRAW_DATA);
+  return 1;
+}
+
+//***************************************************************************
+// Plot_Window::defer_vertices() -- Can the CPU read this plot's vertices
+// from the shared columns, rather than fill vertices of its own?  It can
+// if every axis is drawn by the vertex shader from a shared, unshifted
+// column, so the only normalizations are those that set the bounds,
+// log10, and squash, and the only transform is sum-vs-difference.
+int Plot_Window::defer_vertices()
+{
+  if( !use_VBOs) return 0;
+  for( int axis=0; axis<3; axis++) {
+    const Column_Buffers::Key &key = axis_keys[axis];
+    if( key.owner >= 0 || key.offset != 0 ||
+        key.style != Control_Panel_Window::NORMALIZATION_NONE) return 0;
+  }
+  return 1;
+}
+
+//***************************************************************************
+// Plot_Window::axis_bounds( axis_index, column) -- Set amin and amax for
+// an axis drawn by the vertex shader from column, without normalizing it,
+// and vmin and vmax to the least and greatest values the shader will draw.
+// Log10 and squash are increasing, so their bounds follow from the
+// extremes of the column.
+void Plot_Window::axis_bounds( int axis_index, long column)
+{
+  blitz::Range NPTS( 0, npoints-1);
+  blitz::Array<float,1> a =
+    Data_File_Manager::column_info[ column].points( NPTS);
+  blitz::Array<int,1> &rank =
+    ( axis_index == 0) ? x_rank : ( axis_index == 1) ? y_rank : z_rank;
+  int style =
+    ( axis_index == 0) ? cp->x_normalization_style->value() :
+    ( axis_index == 1) ? cp->y_normalization_style->value() :
+    cp->z_normalization_style->value();
+  vmin[axis_index] = tmin[axis_index];
+  vmax[axis_index] = tmax[axis_index];
+
+  switch( style) {
+
+  // Logs of nonpositive numbers are zero, so the least value is the log
+  // of the least positive one or zero, whichever is less
+  case Control_Panel_Window::NORMALIZATION_LOG10:
+    if( tmin[axis_index] <= 0.0) {
+      cerr << "Warning: "
+           << "attempted to take logarithms of nonpositive "
+           << " numbers. Their logs were set to zero." 
+           << endl;
+    }
+    vmax[axis_index] = 0.0;
+    if( tmax[axis_index] > 0.0) vmax[axis_index] = log10( tmax[axis_index]);
+    if( tmin[axis_index] > 0.0) vmin[axis_index] = log10( tmin[axis_index]);
+    else {
+      float least = least_positive( a, rank);
+      vmin[axis_index] = 0.0;
+      if( least > 0.0) vmin[axis_index] = fminf( 0.0, log10( least));
+    }
+    amin[axis_index] = vmin[axis_index];
+    amax[axis_index] = vmax[axis_index];
+    return;
+
+  case Control_Panel_Window::NORMALIZATION_SQUASH:
+    vmin[axis_index] = tmin[axis_index] / ( 1 + fabsf( tmin[axis_index]));
+    vmax[axis_index] = tmax[axis_index] / ( 1 + fabsf( tmax[axis_index]));
+    amin[axis_index] = vmin[axis_index];
+    amax[axis_index] = vmax[axis_index];
+    return;
+
+  // The other styles only set amin and amax, and leave the column as it is
+  default:
+    (void) normalize( a, rank, style, axis_index);
+    return;
+  }
+}
+
+//***************************************************************************
+// Plot_Window::least_positive( a, rank) -- Least positive value of a, found
+// by a binary search of its ranks, or zero if none of it is positive.
+float Plot_Window::least_positive(
+  blitz::Array<float,1> a, blitz::Array<int,1> &rank)
+{
+  int lo = 0, hi = npoints;
+  while( lo < hi) {
+    int mid = lo + ( hi-lo)/2;
+    if( a( rank( mid)) > 0.0) hi = mid;
+    else lo = mid+1;
+  }
+  if( lo < npoints) return a( rank( lo));
+  return 0.0;
+}
+
+//***************************************************************************
+// Plot_Window::compute_vertices() -- Copy the columns of this plot's axes
+// into the vertices, allocating them if need be, normalize them, and apply
+// any 2D transform, setting the bounds of each axis.  Unless the vertices
+// are deferred, the CPU reads them from now on.
+void Plot_Window::compute_vertices()
+{
+  blitz::Range NPTS( 0, npoints-1);
+  if( vertices.rows() != npoints) vertices.resize( npoints, 3);
+  long axis0 = (long)(cp->varindex1->mvalue()->user_data());
+  long axis1 = (long)(cp->varindex2->mvalue()->user_data());
+  long axis2 = (long)(cp->varindex3->mvalue()->user_data());
+
   // OpenGL vertices, vertex arrays, and VBOs need to have their x, y, and z 
   // coordinates interleaved -- i.e. stored in adjacent memory locations:  
   // x[0],y[0],z[0],x[1],y[1],z[1],...  Unfortunately, this is not how the 
@@ -2149,14 +3104,34 @@ int Plot_Window::extract_data_points ()
 
   // Apply 2D data transformations, if any are active.
   (void) transform_2d();
+  vertices_filled = 1;
+  if( !vertices_deferred)
+    vertex_source.use_vertices(
+      vertices.data(), vertices.stride(0), vertices.stride(1));
+}
 
-  // Since we're showing new data, make sure none of it gets clipped.
-  // MCL XXX - this should be done on a per-axis basis and only when necessary
-  // and not at all when simply changeing an axis offset.
-  reset_view();
-
-  compute_histograms();
-  return 1;
+//***************************************************************************
+// Plot_Window::fill_vertices() -- Make sure the vertices hold this plot's
+// data as normalized and transformed, for drawing from this plot's own VBO
+// or from client arrays.  Deferred vertices are allocated and filled here,
+// keeping the bounds and view already set, and freed once copied.
+void Plot_Window::fill_vertices()
+{
+  if( vertices_filled) return;
+  float bounds[4][3];
+  for( int i=0; i<3; i++) {
+    bounds[0][i] = amin[i];
+    bounds[1][i] = amax[i];
+    bounds[2][i] = wmin[i];
+    bounds[3][i] = wmax[i];
+  }
+  compute_vertices();
+  for( int i=0; i<3; i++) {
+    amin[i] = bounds[0][i];
+    amax[i] = bounds[1][i];
+    wmin[i] = bounds[2][i];
+    wmax[i] = bounds[3][i];
+  }
 }
 
 //***************************************************************************
@@ -2199,11 +3174,12 @@ void Plot_Window::upper_triangle_incr( int &i, int &j, const int n)
 }
 
 //***************************************************************************
-// Plot_Window::redraw_all_plots( p) -- STATIC method that invokes methods to 
-// redraw all plots cylically, starting with plot p.  This is a static method 
-// used by class Plot_Window and by the npoints_changed method in the main 
-// routine.
-void Plot_Window::redraw_all_plots( int p)
+// Plot_Window::redraw_all_plots( p, reason) -- STATIC method that marks all 
+// plots as needing to be redrawn for reason, by default a change of the 
+// selection, and has the next frame draw them cylically, starting with plot 
+// p.  This is a static method used by class Plot_Window and by the 
+// npoints_changed method in the main routine.
+void Plot_Window::redraw_all_plots( int p, int reason)
 {
   DEBUG( cout << "in redraw_all_plots(" << p << ")" << endl ) ;
 
@@ -2211,22 +3187,10 @@ void Plot_Window::redraw_all_plots( int p)
   // since the draw() routine for a plot handles the selection region, and the 
   // active plot (the one where we are making the selection) must update the 
   // selected set and set arrays *before* all the other plots get redrawn.  
-  // Ugh.  Also, they are queued in reverse order, since is the order in which
-  // fltk will actually draw() them (most recently defined gets drawn first).
-  for( int i=0; i<nplots; i++) {
-    int j = (p+i)%nplots;
-    assert (j>=0);
-    assert (j<nplots);
-    pws[j]->compute_histograms();
-    pws[j]->redraw();
-    pws[j]->needs_redraw = 0;
-  }
-  
-  // R100_FIXES: Fix for WIN32 'slow-handler' bug.  If we could get rid of 
-  // this call to Fl::flush, the WIN32 version would be faster.
-  #ifdef __WIN32__
-    Fl::flush();
-  #endif // __WIN32__
+  // Ugh.
+  assert (p>=0);
+  for( int i=0; i<nplots; i++) pws[i]->schedule_redraw( reason);
+  Frame_Scheduler::wake( p % nplots);
 }
 
 //***************************************************************************
@@ -2259,6 +3223,13 @@ void Plot_Window::run_timing_test()
 // points.  This is a static method used only by class Plot_Window.
 void Plot_Window::delete_selection( Fl_Widget *o)
 {
+  // Make sure no background computations are reading the data
+  if( brush_statistics != NULL) brush_statistics->data_changed();
+  if( column_profile != NULL) column_profile->data_changed();
+  Column_Buffers::data_changed();
+  if( selection_worker != NULL) selection_worker->cancel();
+  if( brush_algebra != NULL) brush_algebra->data_changed();
+
   // blitz::Range NVARS(0,nvars-1);
   int ipoint=0;
   for( int n=0; n<npoints; n++) {
@@ -2288,8 +3259,10 @@ void Plot_Window::delete_selection( Fl_Widget *o)
   // got deleted and everyone's ranking must be recomputed
   if( ipoint != npoints)  {
       
-    // Update the number of points
+    // Update the number of points.  The selection history refers to the 
+    // old points, so it can't be used any more.
     npoints = ipoint;
+    if( selection_history != NULL) selection_history->clear();
 
     // Resize the current data buffer to conserve memory and because the
     // Data_File_Manager class uses it to recalculate NPOINTS.  Also reset
@@ -2345,6 +3318,7 @@ void Plot_Window::invert_selection ()
   // Recolor all points using the new selection and redraw
   pws[ 0]->color_array_from_selection();
   redraw_all_plots(0);
+  record_selection();
 }
 
 //***************************************************************************
@@ -2394,21 +3368,82 @@ void Plot_Window::clear_selections( Fl_Widget *o)
   initialize_selection();
   pws[0]->color_array_from_selection(); // So, I'm lazy.
   redraw_all_plots (0);
+  record_selection();
+}
+
+//***************************************************************************
+// Plot_Window::record_selection() -- STATIC method to push the current 
+// selection onto the selection history.  Call this when a brushing 
+// operation is complete.
+void Plot_Window::record_selection()
+{
+  if( selection_history != NULL) selection_history->push();
+}
+
+//***************************************************************************
+// Plot_Window::undo_selection( *o) -- STATIC method to restore the previous
+// selection from the selection history, then gather and redraw.
+void Plot_Window::undo_selection( Fl_Widget *o)
+{
+  if( selection_history == NULL || !selection_history->undo()) return;
+  pws[0]->color_array_from_selection();
+  redraw_all_plots( 0);
+}
+
+//***************************************************************************
+// Plot_Window::redo_selection( *o) -- STATIC method to restore the next
+// selection from the selection history, then gather and redraw.
+void Plot_Window::redo_selection( Fl_Widget *o)
+{
+  if( selection_history == NULL || !selection_history->redo()) return;
+  pws[0]->color_array_from_selection();
+  redraw_all_plots( 0);
 }
 
 //***************************************************************************
-// Plot_Window::select_on_string( *str, a_col) -- Search through all points, 
-// using given column, a_col, as the "key".  Flag as "inside the footprint" 
-// (i.e. painted by this "string search brush") only those points whose 
-// corresponding ascii value matches the given string.
-void Plot_Window::select_on_string( const char *str, int a_col)
+// Plot_Window::add_density_column( *o) -- STATIC callback to evaluate a 
+// kernel density estimate of the active plot's x-y projection at every 
+// point, and add the result as a new column that can be plotted, used for
+// coloring, or brushed.  Densities are per unit area of normalized data.
+void Plot_Window::add_density_column( Fl_Widget *o)
 {
-  if( Data_File_Manager::column_info[a_col].hasASCII && a_col>=0) {
-    for(int i=0;i<npoints;i++) {
-      const char *label_a = 
-        Data_File_Manager::column_info[a_col].ascii_value(
-          (int) Data_File_Manager::column_info[a_col].points(i)).c_str();
-      inside_footprint(i) = (label_a && strstr(label_a,str))?1:0;
+  if( active_plot < 0 || active_plot >= nplots || npoints <= 1) return;
+  Plot_Window *pw = pws[ active_plot];
+  if( pw == NULL || !pw->vertex_source.valid()) return;
+
+  pw->joint_density.update_2d(
+    pw->vertex_source, pw->amin[0], pw->amax[0], pw->amin[1], pw->amax[1]);
+  blitz::Array<float,1> values( npoints);
+  pw->joint_density.evaluate( pw->vertex_source, npoints, values.data());
+  pdfm->add_column( "density(" + pw->xlabel + "," + pw->ylabel + ")", values);
+}
+
+//***************************************************************************
+// Plot_Window::select_on_string( *str, a_col, match_mode) -- Search through 
+// all points, using given column, a_col, as the "key".  Flag as "inside the 
+// footprint" (i.e. painted by this "string search brush") only those points 
+// whose corresponding ascii value matches the given string.  Each distinct
+// ASCII value is matched once, then points are classified with a single
+// table lookup.  An invalid regular expression leaves the selection as it
+// is, but still shows it, since a preview may have just restored it.
+void Plot_Window::select_on_string( const char *str, int a_col, int match_mode)
+{
+  if( a_col>=0 && Data_File_Manager::column_info[a_col].hasASCII) {
+    std::vector<char> matches;
+    int nMatches = 
+      Data_File_Manager::column_info[a_col].match_ascii_values( 
+        str, match_mode, matches);
+    if( nMatches < 0) {
+      color_array_from_selection();
+      redraw_all_plots(index);
+      return;
+    }
+    int nValues = matches.size();
+    blitz::Array<float,1> column_points = 
+      Data_File_Manager::column_info[a_col].points;
+    for( int i=0; i<npoints; i++) {
+      int iValue = (int) column_points(i);
+      inside_footprint(i) = (0<=iValue && iValue<nValues) ? matches[iValue] : 0;
     }
   }
   else {
@@ -2418,6 +3453,22 @@ void Plot_Window::select_on_string( const char *str, int a_col)
   redraw_all_plots(index);
 }
 
+//***************************************************************************
+// Plot_Window::preview_string_search( *str, match_mode, *data) -- STATIC 
+// callback invoked by the find window as the user types.  Restore the 
+// selection state saved when the window was opened, then search again so 
+// the results of successive keystrokes don't accumulate, and a keystroke
+// that makes the pattern invalid shows the saved selection.
+void Plot_Window::preview_string_search( 
+  const char *str, int match_mode, void *data)
+{
+  Plot_Window *pw = (Plot_Window *) data;
+  blitz::Range NPTS( 0, npoints-1);
+  newly_selected( NPTS) = pw->search_newly_selected_save( NPTS);
+  selected( NPTS) = pw->search_selected_save( NPTS);
+  pw->select_on_string( str, pw->search_column, match_mode);
+}
+
 
 //***************************************************************************
 // Methods to enable drawing with points (as opposed to point sprites)
@@ -2546,22 +3597,31 @@ void Plot_Window::initialize_sprites()
 }
     
 //***************************************************************************
-// Plot_Window::enable_sprites() -- Invoke OpenGL routines to enable sprites
+// Plot_Window::enable_sprites() -- Invoke OpenGL routines to enable sprites.
+// When the shader is drawing, every symbol comes from the symbol atlas, 
+// otherwise each has a texture of its own, all made the first time.
 void Plot_Window::enable_sprites(int sprite)
 {
   glDisable( GL_POINT_SMOOTH);
+  assert ((sprite >= 0) && (sprite < NSYMBOLS));
+  if( Column_Buffers::use_symbol( sprite)) {
+    if( spriteData[ NSYMBOLS-1] == NULL) make_sprite_textures();
+    glEnable( GL_POINT_SPRITE);
+    glBindTexture( GL_TEXTURE_2D, Symbol_Atlas::texture( spriteData));
+    glTexEnvf( GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE );
+    return;
+  }
   if (!sprites_initialized)
     initialize_sprites();
   glEnable( GL_TEXTURE_2D);
   glEnable( GL_POINT_SPRITE);
-  assert ((sprite >= 0) && (sprite < NSYMBOLS));
   glBindTexture( GL_TEXTURE_2D, spriteTextureID[sprite]);
   glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
   glTexEnvf( GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE );
 }
 
 //***************************************************************************
-// Plot_Window::clear_alpha_planes() -- Those filthy alpha planes!  It seems 
+// Plot_Window::clear_alpha_planes() -- Those filthy alpha planes!  It seems
 // that no matter how hard you try, you just can't keep them clean!
 void Plot_Window::clear_alpha_planes()
 {
@@ -2591,6 +3651,7 @@ void Plot_Window::disable_sprites()
 {
   glDisable( GL_TEXTURE_2D);
   glDisable( GL_POINT_SPRITE);
+  Column_Buffers::use_symbol( 0);
 }
 
 
@@ -2623,24 +3684,155 @@ void Plot_Window::fill_VBO()
 {
   if (!VBOfilled) {
     glBindBuffer(GL_ARRAY_BUFFER, index+1);  
+
+    // Every vertex changes, so orphan the old storage rather than wait for
+    // draws that may still be reading it
+    glBufferData( GL_ARRAY_BUFFER, (GLsizeiptr) npoints*3*sizeof(GLfloat), (void *)NULL, GL_DYNAMIC_DRAW);
+    fill_vertices();
     void *vertexp = (void *)vertices.data();
-    glBufferSubData( GL_ARRAY_BUFFER, (GLintptr) 0, (GLsizeiptr) (npoints*3*sizeof(GLfloat)), vertexp);
+    Column_Buffers::upload( GL_ARRAY_BUFFER, (GLintptr) 0, (GLsizeiptr) (npoints*3*sizeof(GLfloat)), vertexp);
     CHECK_GL_ERROR("filling VBO");
     VBOfilled = true;
+
+    // Deferred vertices were only filled to be copied
+    if( vertices_deferred) {
+      vertices.free();
+      vertices_filled = 0;
+    }
+  }
+}
+
+//***************************************************************************
+// Plot_Window::fill_axis_buffers() -- Point each axis at the shared column
+// buffer named by its key, uploading it if no other plot has.  New buffers
+// are acquired before the old ones are released, so an axis that didn't
+// change keeps its buffer.  Once shared buffers are in use, this plot's
+// own VBO is freed.
+void Plot_Window::fill_axis_buffers()
+{
+  if( axis_buffers_filled) return;
+  GLuint old_buffers[3];
+  for( int axis=0; axis<3; axis++) {
+    old_buffers[axis] = axis_buffers[axis];
+    axis_buffers[axis] = Column_Buffers::find( axis_keys[axis], npoints);
+    if( axis_buffers[axis] != 0) continue;
+
+    // The vertices hold what the buffer should, unless the shader changes
+    // this axis or they haven't been filled.  If so, work out the column
+    // again.
+    if( vertices_filled &&
+        axis_functions[axis] == Column_Buffers::FUNCTION_NONE &&
+        ( axis == 2 || !axis_mix)) {
+      axis_buffers[axis] = Column_Buffers::acquire(
+        axis_keys[axis], vertices.data() + axis*vertices.stride(1),
+        vertices.stride(0), npoints);
+    }
+    else {
+      blitz::Array<float,1> values( npoints);
+      buffer_values( axis, values);
+      axis_buffers[axis] = Column_Buffers::acquire(
+        axis_keys[axis], values.data(), values.stride(0), npoints);
+    }
+  }
+  for( int axis=0; axis<3; axis++)
+    Column_Buffers::release( old_buffers[axis], axis_buffers_epoch);
+  axis_buffers_epoch = Column_Buffers::epoch();
+  CHECK_GL_ERROR("filling shared column buffers");
+  axis_buffers_filled = true;
+
+  if( VBOinitialized) {
+    GLuint vbo = index+1;
+    glDeleteBuffers( 1, &vbo);
+    VBOinitialized = 0;
+    VBOfilled = false;
+  }
+}
+
+//***************************************************************************
+// Plot_Window::upload_buffers() -- Upload whatever this plot draws from that
+// has changed: its axes, or its own VBO, and the index VBOs of the brushes.
+// A GL context must be current.
+void Plot_Window::upload_buffers()
+{
+  if( !use_VBOs) return;
+
+  // Vertices come from shared column buffers if the vertex shader is
+  // available, else from this plot's own VBO
+  if( Column_Buffers::available()) fill_axis_buffers();
+  else {
+    if( !VBOinitialized) initialize_VBO();
+    if( !VBOfilled) fill_VBO();
+  }
+  if( !indexVBOsinitialized) initialize_indexVBOs();
+  if( !indexVBOsfilled) fill_indexVBOs();
+}
+
+//***************************************************************************
+// Plot_Window::buffer_values( axis, a) -- Fill a with the column an axis's
+// shared buffer holds: the data with the axis's offset, normalized if the
+// style depends on the whole column, but before the shader's functions and
+// transform.  normalize() is only used for its values, so amin and amax
+// are kept.
+void Plot_Window::buffer_values( int axis, blitz::Array<float,1> a)
+{
+  blitz::Range NPTS( 0, npoints-1);
+  const Column_Buffers::Key &key = axis_keys[axis];
+
+  // Without a z-axis, z is zero.  The z-axis isn't offset (yet).
+  if( key.column < 0) {
+    a = 0.0;
+    return;
+  }
+  if( key.offset == 0 || axis == 2)
+    a = Data_File_Manager::column_info[ key.column].points( NPTS);
+  else
+    circular_shift(
+      a, Data_File_Manager::column_info[ key.column].points( NPTS),
+      key.offset);
+  if( key.style == Control_Panel_Window::NORMALIZATION_NONE) return;
+
+  blitz::Array<int,1> &rank =
+    ( axis == 0) ? x_rank : ( axis == 1) ? y_rank : z_rank;
+  float amin_save = amin[axis], amax_save = amax[axis];
+  (void) normalize( a, rank, key.style, axis);
+  amin[axis] = amin_save;
+  amax[axis] = amax_save;
+}
+
+//***************************************************************************
+// Plot_Window::release_buffers() -- Stop using shared column buffers, and
+// delete the decoration list, before this plot's window, and its context,
+// are destroyed.  The list outlives the context in the ones that share it,
+// so it is deleted while this one is still current.
+void Plot_Window::release_buffers()
+{
+  for( int axis=0; axis<3; axis++) {
+    Column_Buffers::release( axis_buffers[axis], axis_buffers_epoch);
+    axis_buffers[axis] = 0;
+  }
+  axis_buffers_filled = false;
+
+  if( decoration_list != 0 &&
+      decoration_list_epoch == Column_Buffers::epoch() &&
+      ( shown() || headless_mode)) {
+    if( shown()) make_current();
+    glDeleteLists( decoration_list, 1);
   }
+  decoration_list = 0;
+  decorations_changed = 1;
 }
 
 //***************************************************************************
-// Plot_Window::initialize_indexVBO() -- Initialize the 'index VBO' that
-// holds indices of selected (or non-selected) points.
+// Plot_Window::initialize_indexVBO() -- Initialize the ring of 'index VBOs'
+// that hold indices of selected (or non-selected) points.
 // MCL XXX index VBOs hould probably be handled by the Brush class.
 void Plot_Window::initialize_indexVBO(int set)
 {
-  // There is one shared set of index VBOs for all plots.
-  //  indexVBO bound to MAXPLOTS+1 holds indices of nonselected (brushes[0]) points
-  //  indexVBO bound to MAXPLOTS+2 holds indices of points selected by brushes[1], etc.
-  glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, MAXPLOTS+set+1);  // a safe place....
-  glBufferData( GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr) (npoints*sizeof(GLuint)), (void*) NULL, GL_DYNAMIC_DRAW);
+  // There is one shared ring of index VBOs for each brush, for all plots.
+  //  index_rings[0] holds indices of nonselected (brushes[0]) points
+  //  index_rings[1] holds indices of points selected by brushes[1], etc.
+  // Each buffer is filled from scratch the first time it is used.
+  Column_Buffers::reset_ring( index_rings[set]);
 }
 
 //***************************************************************************
@@ -2652,19 +3844,25 @@ void Plot_Window::initialize_indexVBOs()
       initialize_indexVBO(set);
     }
     indexVBOsinitialized = 1;
+    indexVBOsfilled = 0;
   }
 }
 
 //***************************************************************************
-// Plot_Window::fill_indexVBO() -- Fill the index VBO
+// Plot_Window::fill_indexVBO() -- Fill the next index VBO of a brush's
+// ring with the indices that changed since that buffer was last filled.
+// The ring orphans a buffer the GPU is still drawing from, rather than
+// let the copy wait, and then all of it is filled.
 void Plot_Window::fill_indexVBO(int set)
 {
-  if (brushes[set]->count > 0) {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, MAXPLOTS+set+1);
+  int from, to;
+  Column_Buffers::advance_ring( index_rings[set], GL_ELEMENT_ARRAY_BUFFER, npoints, sizeof(GLuint), from, to);
+  to = min( to, (int) brushes[set]->count);
+  if (from < to) {
     // Create an alias to slice
     blitz::Array<unsigned int, 1> tmpArray = indices_selected( set, blitz::Range(0,npoints-1));
     unsigned int *indices = (unsigned int *) (tmpArray.data());
-    glBufferSubData( GL_ELEMENT_ARRAY_BUFFER, (GLintptr) 0, (GLsizeiptr) (brushes[set]->count*sizeof(GLuint)), indices);
+    Column_Buffers::upload( GL_ELEMENT_ARRAY_BUFFER, (GLintptr) (from*sizeof(GLuint)), (GLsizeiptr) ((to-from)*sizeof(GLuint)), indices+from);
     // make sure we succeeded 
     CHECK_GL_ERROR("filling index VBO");
   }
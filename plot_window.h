@@ -40,9 +40,22 @@
 // Include globals
 #include "global_definitions_vp.h"
 
-// Declare class Control_Panel_Window so it can be used for definitions of
-// member variables of this class
+// Include associated headers
+#include "histogram_engine.h"
+#include "density_renderer.h"
+#include "kernel_density.h"
+#include "point_sampler.h"
+#include "point_collapser.h"
+#include "line_decimator.h"
+#include "progressive_renderer.h"
+#include "column_buffers.h"
+#include "vertex_source.h"
+#include "frame_scheduler.h"
+
+// Declare classes Control_Panel_Window and Brush so they can be used for 
+// definitions of member variables and arguments of this class
 class Control_Panel_Window;
+class Brush;
 
 //***************************************************************************
 // Class: Plot_Window
@@ -72,13 +85,22 @@ class Control_Panel_Window;
 //   initialize_indexVBO( int) -- Initialize one brush's index VBO
 //   initialize_indexVBOs() -- Initialize all index VBOs
 //   fill_indexVBOs() -- Fill all index VBOs with the indices of the vertices they should plot.
+//   fill_axis_buffers() -- Bind this plot's axes to shared column buffers
+//   upload_buffers() -- Upload whatever this plot draws from that changed
+//   buffer_values( axis, a) -- Recompute what an axis's column buffer holds
+//   release_buffers() -- Stop using shared buffers and display lists
 //
 //   draw() -- Draw plot
 //   draw_background() -- Draw background
 //   draw_grid() -- Draw grid
 //   draw_selection_information() -- Draw selection information
 //   void draw_axes() -- Draw axes
+//   draw_decorations() -- Draw axes, grid, and histograms from a display list
 //   draw_data_points() -- Draw data points
+//   brush_appearance( *brush, &size, color) -- Point size and color of a brush
+//   draw_brushes_at_once( blending_mode, show_brush0, z_buffering, &sprite) --
+//     Draw the points of every brush in one call
+//   select_visible_points() -- Cull points outside a zoomed-in view
 //   void draw_center_glyph() -- Draw a cross at the center of a zoom.  Stolen from flashearth.com
 //   void update_linked_transforms() -- Replicate scale and translatation for linked axes
 //   enable_sprites(int) -- Enable sprites
@@ -99,28 +121,46 @@ class Control_Panel_Window;
 //   draw_x_histogram( bin_counts, nbins);
 //   draw_y_histogram( bin_counts, nbins);
 //   draw_histograms() --
+//   draw_density_curves( axis) -- Draw smooth marginals for one axis
+//   draw_contours() -- Draw isodensity contours of the x-y projection
 //   density_1D( a, axis) --
 //
+//   select_on_string( str, col, match_mode) -- Select on ASCII values
+//   preview_string_search( str, match_mode, data) -- Preview string search
+//
 //   compute_histograms () -- Compute both histograms for marginals of 2D plot
 //   compute_rank(int var_index) create an array of indices that rank order a variable (basically a sort).
+//   rank_orders_vertices( axis) -- Does x_rank or y_rank order the vertices?
 //   normalize() -- Normalize data based on user-selected normalization scheme
 //
 //   extract_data_points() -- Extract data for these axes
+//   defer_vertices() -- Can the CPU read the shared columns, not vertices?
+//   axis_bounds( axis_index, column) -- Bounds of an axis the shader draws
+//   least_positive( a, rank) -- Least positive value of a ranked column
+//   compute_vertices() -- Copy, normalize, and transform the vertices
+//   fill_vertices() -- Fill the vertices for fixed function drawing
 //   transform_2d() -- Transform all (x,y) to (f(x,y), g(x,y))
 //   reset_selection_box() -- Reset selection box
-//   color_array_from_selection() -- Fill index arrays 
+//   color_array_from_selection() -- Fill index arrays and record changes
 //   reset_view() -- Reset plot
 //   redraw_one_plot() -- Redraw one plot
+//   schedule_redraw( reason) -- Have the next frame redraw this plot
+//   render_offscreen() -- Draw into the current framebuffer without a window
+//   draw_cell( x, y) -- Draw into a cell of the matrix window
 //   change_axes() -- Change axes of this plot
 //
 // Static functions:
 //   upper_triangle_incr( i, j, nvars) -- Traverse upper triangle
-//   redraw_all_plots( p) -- Redraw all plots
+//   redraw_all_plots( p, reason) -- Redraw all plots
 //   delete_selection( *o) -- Delete selcted points
 //   invert_selection() -- Invert selected and nonselcted points
 //   toggle_display_delected( *o) -- Toggle colors
 //   initialize_selection() -- Clear selection
 //   clear_selection( *o) -- Clear selection and redraw plots
+//   record_selection() -- Push the selection onto the history
+//   undo_selection( *o) -- Restore the previous selection from the history
+//   redo_selection( *o) -- Restore the next selection from the history
+//   add_density_column( *o) -- Add a column of density in the active plot
 //   initialize_sprites() -- initial setup of rgba used for selected 
 //     and deselected points when rendered as openGL point sprites.
 //
@@ -135,6 +175,9 @@ class Plot_Window : public Fl_Gl_Window
 #ifdef SERIALIZATION
     friend class boost::serialization::access;
 #endif //SERIALIZATION
+
+    // The matrix window draws plots and passes them events
+    friend class Matrix_Window;
     
     // Define state parameters for serialization
     int x_save, y_save, w_save, h_save;
@@ -173,17 +216,53 @@ class Plot_Window : public Fl_Gl_Window
     // have we initialized the shared openGL index vertex buffer objects?
     static int indexVBOsinitialized;
     void initialize_indexVBOs();
-    // and are they filled with the latest index data?
+    // and are they filled with the latest index data?  Each brush's
+    // indices are streamed through a ring of buffers, which tracks the
+    // span that changed.
     static int indexVBOsfilled;
+    static Column_Buffers::Ring index_rings[NBRUSHES];
     void fill_indexVBOs();
+
+    // Where possible, each axis is drawn from a column buffer shared with
+    // other plots instead of the VBO above.  The keys describe what the
+    // axes hold; the buffers hold it once axis_buffers_filled is set.  The
+    // shader then applies axis_functions and, if axis_mix is set, the
+    // sum-vs-difference transform.
+    GLuint axis_buffers[3];
+    Column_Buffers::Key axis_keys[3];
+    int axis_functions[3];
+    int axis_mix;
+    int axis_buffers_epoch;
+    bool axis_buffers_filled;
+    void fill_axis_buffers();
+    void buffer_values( int axis, blitz::Array<float,1> a);
+
+    // The axes, grid, and histograms are drawn from a display list, which
+    // is compiled again when decorations_changed is set or the view they
+    // were drawn for, decoration_view, has changed
+    static const int ndecoration_view = 17;
+    GLuint decoration_list;
+    int decoration_list_epoch;
+    int decorations_changed;
+    float decoration_view[ ndecoration_view];
+
+    // Lower left corner of the viewport, which is not the corner of the
+    // window when the plot is a cell of the matrix window
+    int cell_x, cell_y;
     
     // Draw routines
     void draw();
+    void draw_cell( int x, int y);
     void draw_background();
     void draw_grid();
     void draw_axes();
+    void draw_decorations();
     void draw_selection_information();
     void draw_data_points();
+    void brush_appearance( Brush *brush, float &size, GLfloat color[4]);
+    int draw_brushes_at_once(
+      int blending_mode, int show_brush0, int z_buffering, int &sprite);
+    int select_visible_points();
     void draw_center_glyph();
     void draw_resize_knob();
     void update_linked_transforms();
@@ -203,7 +282,15 @@ class Plot_Window : public Fl_Gl_Window
     void update_selection_from_footprint();
     void print_selection_stats();
     void interval_to_strings (const int column, const float x1, const float x2, char *buf1, char *buf2);
-    void select_on_string(const char *str,int col);
+    void select_on_string(const char *str,int col, int match_mode = 0);
+    static void preview_string_search( 
+      const char *str, int match_mode, void *data);
+
+    // State saved while the find window is open, so a search can be 
+    // previewed as the user types and undone if it is cancelled
+    int search_column;
+    blitz::Array<int,1> search_newly_selected_save, search_selected_save;
+    static int string_match_mode;
     void center_on_click(int x, int y);
 
     // Event parameters
@@ -220,6 +307,7 @@ class Plot_Window : public Fl_Gl_Window
     // Arrays and routines for histograms
     int nbins[3];
     blitz::Array<float,2> counts, counts_selected;
+    Histogram_Engine histogram_engine[2];
     float xhscale, yhscale;
     void compute_histogram( int);
     void draw_x_histogram(const blitz::Array<float,1>bin_counts, const int nbins);
@@ -227,6 +315,28 @@ class Plot_Window : public Fl_Gl_Window
     void draw_histograms();
     void density_1D (blitz::Array<float,1>a, const int axis);
 
+    // Smooth kernel density estimates of the marginals and of the x-y 
+    // projection, for curves, contours, and density columns
+    Kernel_Density kernel_density[2];
+    Kernel_Density joint_density;
+    void draw_density_curves( const int axis);
+    void draw_contours();
+
+    // Binned density, drawn in place of the points when requested
+    Density_Renderer density_renderer;
+
+    // Level of detail for drawing points while the user interacts
+    Point_Sampler point_sampler;
+
+    // Distinct positions, drawn in place of the points when requested
+    Point_Collapser point_collapser;
+
+    // Points of long line strips drawn for the current view
+    Line_Decimator line_decimator;
+
+    // Points accumulated over several frames when there are too many for one
+    Progressive_Renderer progressive_renderer;
+
     int show_center_glyph;
     int selection_changed;
 
@@ -245,18 +355,34 @@ class Plot_Window : public Fl_Gl_Window
     // Initialize and fill index VBO for this window
     void initialize_indexVBO(int);
     void fill_indexVBO(int);
+    void upload_buffers();
+    void release_buffers();
+    void render_offscreen();
 
     // true min and max of the data before normalization and transformation
     float tmin[3], tmax[3];
 
+    // min and max of the values drawn, while the vertices are deferred
+    float vmin[3], vmax[3];
+
     // min and max for normalized data's bounding box in x, y, and z;
     float amin[3], amax[3];
     // data values at edges of "window"
     // (the X and Y axes lines bound the left and bottom edges of this "window")
     float wmin[3], wmax[3];
 
-    // openGL vertices of points to be plotted
+    // openGL vertices of points to be plotted, and are they up to date?
+    // Plots drawn from shared columns defer them: the array is only filled
+    // while it is copied into a VBO if the shader isn't available.
     blitz::Array<float,2> vertices;
+    int vertices_filled, vertices_deferred;
+
+    // Where work on the CPU reads this plot's vertices: the array, or
+    // the shared columns if the vertices are deferred.  References to the
+    // columns keep them alive, as the array did, if they are replaced
+    // before this plot extracts them again.
+    Vertex_Source vertex_source;
+    blitz::Array<float,1> vertex_columns[3];
 
     // indices of points when ranked according to their x, y, or z coordinate 
     // respectively
@@ -268,6 +394,7 @@ class Plot_Window : public Fl_Gl_Window
 
     // Routines to compute histograms and normalize data
     void compute_rank(int var_index);
+    int rank_orders_vertices( int axis);
     void compute_histograms();
     int normalize( 
       blitz::Array<float,1> a, 
@@ -287,6 +414,11 @@ class Plot_Window : public Fl_Gl_Window
 
     // More plot routines
     int extract_data_points();
+    int defer_vertices();
+    void axis_bounds( int axis_index, long column);
+    float least_positive( blitz::Array<float,1> a, blitz::Array<int,1> &rank);
+    void compute_vertices();
+    void fill_vertices();
     int transform_2d();
 
     // Routines and variables to handle point colors and selection
@@ -297,19 +429,31 @@ class Plot_Window : public Fl_Gl_Window
     // Routines to redraw plots
     void reset_view();
     void redraw_one_plot();
+    void schedule_redraw( int reason);
     void change_axes( int nchange);
     float angle;
+
+    // Reasons this plot must be drawn again, see Frame_Scheduler
     int needs_redraw;
+
+    // Seconds the last draw took, when the next spin frame is due, and
+    // when the angle last changed, or zero when not spinning
+    double draw_seconds, next_spin, spin_time;
     unsigned do_reset_view_with_show;
     
     // Static methods moved here from vp.cpp
     static void upper_triangle_incr( int &i, int &j, const int nvars);
-    static void redraw_all_plots( int p);
+    static void redraw_all_plots(
+      int p, int reason = Frame_Scheduler::REDRAW_SELECTION);
     static void delete_selection( Fl_Widget *o);
     static void invert_selection();
     static void toggle_display_deselected( Fl_Widget *o);
     static void initialize_selection();
     static void clear_selections( Fl_Widget *o);
+    static void record_selection();
+    static void undo_selection( Fl_Widget *o);
+    static void redo_selection( Fl_Widget *o);
+    static void add_density_column( Fl_Widget *o);
     static void initialize_sprites();
     
     // Static variable to hold he initial fraction of the window to be used 
@@ -324,6 +468,17 @@ class Plot_Window : public Fl_Gl_Window
     // Indices of points for rendering, packed acording to selection state;
     static blitz::Array<unsigned int,2> indices_selected; 
 
+    // Record of the last gather, so that consumers can update incrementally.
+    // gathered_selection holds the brush of each point as of the last 
+    // gather.  changed_points and changed_from list the points whose brush
+    // changed during the last gather and their previous brushes.  If too 
+    // many changed, or there was no previous gather, selection_delta_valid
+    // is zero and the lists are empty.  selection_generation counts gathers.
+    static blitz::Array<int,1> gathered_selection;
+    static std::vector<int> changed_points, changed_from;
+    static int selection_delta_valid;
+    static int selection_generation;
+
     // point sprites-specific data
     static int sprites_initialized;
 
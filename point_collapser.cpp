@@ -0,0 +1,201 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: point_collapser.cpp
+//
+// Class definitions:
+//   Point_Collapser -- Draw each distinct position of a plot's points once
+//
+// Classes referenced:
+//   Plot_Window -- Source of the vertices and the gathered selection
+//
+// Required packages
+//    Blitz++ 0.9 -- Various math routines
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <point_collapser.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "point_collapser.h"
+#include "plot_window.h"
+
+//***************************************************************************
+// Point_Collapser::Point_Collapser() -- Constructor
+Point_Collapser::Point_Collapser() :
+  grouped_( 0), generation_( -1)
+{
+  starts_.assign( NBRUSHES*nclasses+1, 0);
+}
+
+//***************************************************************************
+// Point_Collapser::data_changed() -- Discard the positions, because the
+// plot's vertices have changed.  They are hashed again when next drawn.
+void Point_Collapser::data_changed()
+{
+  grouped_ = 0;
+  generation_ = -1;
+  positions_.clear();
+  group_.clear();
+}
+
+//***************************************************************************
+// Point_Collapser::update( vertices, n) -- Make sure the counts describe
+// the n points read from vertices, and the last gather.
+// Returns 0 if the plot should draw every point instead, because there is
+// no gather of these points or too few of them share a position.
+int Point_Collapser::update( const Vertex_Source &vertices, int n)
+{
+  if( Plot_Window::gathered_selection.rows() != n || n <= 0) return 0;
+  if( !grouped_) group( vertices, n);
+  if( group_.empty()) return 0;
+  if( generation_ != Plot_Window::selection_generation) collapse();
+  return 1;
+}
+
+//***************************************************************************
+// Point_Collapser::group( vertices, n) -- Hash each point by the bits of
+// its coordinates into an open addressed table of distinct positions.
+// Negative zero is made positive so that it matches zero.  Gives up, and
+// leaves group_ empty, once there are more than n/min_repeats positions.
+void Point_Collapser::group( const Vertex_Source &vertices, int n)
+{
+  grouped_ = 1;
+  generation_ = -1;
+  positions_.clear();
+  group_.resize( n);
+
+  int limit = n / min_repeats;
+  unsigned int nslots = 16;
+  while( nslots < 2*(unsigned int)limit) nslots *= 2;
+  std::vector<int> slots( nslots, -1);
+
+  int ngroups = 0;
+  for( int i=0; i<n; i++) {
+    float p[3];
+    unsigned int bits[3];
+    vertices.vertex( i, p);
+    for( int axis=0; axis<3; axis++) p[axis] += 0.0f;
+    memcpy( bits, p, sizeof( bits));
+    unsigned int h =
+      bits[0]*0x9E3779B1u ^ bits[1]*0x85EBCA77u ^ bits[2]*0xC2B2AE3Du;
+    h ^= h >> 15;
+    for( h&=nslots-1; ; h=(h+1)&(nslots-1)) {
+      int g = slots[h];
+      if( g < 0) {
+        if( ngroups >= limit) {
+          positions_.clear();
+          group_.clear();
+          return;
+        }
+        slots[h] = g = ngroups++;
+        positions_.insert( positions_.end(), p, p+3);
+      }
+      else if( memcmp( &(positions_[3*g]), p, sizeof( p)) != 0) continue;
+      group_[i] = g;
+      break;
+    }
+  }
+  if( be_verbose)
+    cout << "Point_Collapser::group: " << n << " points at " << ngroups
+         << " distinct positions" << endl;
+}
+
+//***************************************************************************
+// Point_Collapser::count_class( count) -- STATIC method to get the power of
+// two at or below count, limited to the number of classes.
+int Point_Collapser::count_class( int count)
+{
+  int k = 0;
+  while( count >>= 1) k++;
+  return min( k, nclasses-1);
+}
+
+//***************************************************************************
+// Point_Collapser::collapse() -- Count the points of each brush at each
+// position, then lay out one vertex for each pair with any points, by
+// brush and count class, with a counting sort.
+void Point_Collapser::collapse()
+{
+  const blitz::Array<int,1> &selection = Plot_Window::gathered_selection;
+  int n = group_.size(), ngroups = positions_.size()/3;
+  std::vector<int> counts( ngroups*NBRUSHES, 0);
+  for( int i=0; i<n; i++) counts[ group_[i]*NBRUSHES + selection( i)]++;
+
+  starts_.assign( NBRUSHES*nclasses+1, 0);
+  for( int g=0; g<ngroups; g++)
+    for( int b=0; b<NBRUSHES; b++)
+      if( counts[ g*NBRUSHES+b] > 0)
+        starts_[ b*nclasses + count_class( counts[ g*NBRUSHES+b]) + 1]++;
+  for( int k=0; k<NBRUSHES*nclasses; k++) starts_[k+1] += starts_[k];
+
+  int nvertices = starts_.back();
+  vertices_.resize( 3*nvertices);
+  counts_.resize( nvertices);
+  std::vector<int> next( starts_.begin(), starts_.end()-1);
+  for( int g=0; g<ngroups; g++) {
+    for( int b=0; b<NBRUSHES; b++) {
+      int count = counts[ g*NBRUSHES+b];
+      if( count == 0) continue;
+      int j = next[ b*nclasses + count_class( count)]++;
+      for( int axis=0; axis<3; axis++)
+        vertices_[3*j+axis] = positions_[3*g+axis];
+      counts_[j] = count;
+    }
+  }
+  generation_ = Plot_Window::selection_generation;
+}
+
+//***************************************************************************
+// Point_Collapser::draw( brush, style, size, color) -- Draw the distinct
+// positions of a brush with the current point or sprite state.  The
+// point size is size, or with STYLE_SIZE grows so that the area of the
+// vertex goes up by size squared each time the count doubles.  Color is
+// the brush's color, or with STYLE_ALPHA has the opacity of count points
+// drawn on top of each other.  Uses client arrays, so no array buffer
+// may be bound.
+void Point_Collapser::draw(
+  int brush, int style, float size, const GLfloat color[4])
+{
+  int first = starts_[ brush*nclasses], last = starts_[ (brush+1)*nclasses];
+  if( last <= first) return;
+  glVertexPointer( 3, GL_FLOAT, 0, &(vertices_[0]));
+
+  if( style == STYLE_SIZE) {
+    glColor4fv( color);
+    for( int k=0; k<nclasses; k++) {
+      int begin = starts_[ brush*nclasses+k];
+      int end = starts_[ brush*nclasses+k+1];
+      if( end <= begin) continue;
+      glPointSize( min( size*sqrtf( 1.0+k), 100.0F));
+      glDrawArrays( GL_POINTS, begin, end-begin);
+    }
+    glPointSize( size);
+  }
+  else if( style == STYLE_ALPHA) {
+    colors_.resize( 4*counts_.size());
+    for( int j=first; j<last; j++) {
+      for( int c=0; c<3; c++) colors_[4*j+c] = color[c];
+      colors_[4*j+3] = 1.0 - pow( 1.0 - color[3], (double) counts_[j]);
+    }
+    glEnableClientState( GL_COLOR_ARRAY);
+    glColorPointer( 4, GL_FLOAT, 0, &(colors_[0]));
+    glDrawArrays( GL_POINTS, first, last-first);
+    glDisableClientState( GL_COLOR_ARRAY);
+    glColor4fv( color);
+  }
+  else {
+    glColor4fv( color);
+    glDrawArrays( GL_POINTS, first, last-first);
+  }
+}
@@ -0,0 +1,128 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: point_collapser.h
+//
+// Class definitions:
+//   Point_Collapser -- Draw each distinct position of a plot's points once
+//
+// Classes referenced:
+//   Plot_Window -- Source of the vertices and the gathered selection
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Columns of integers or coarse codes put many points at exactly
+//   the same place, and each of them is drawn although only the last one
+//   shows.  When requested, a plot instead draws one vertex for each
+//   distinct position of each brush, so drawing costs follow the number of
+//   positions rather than the number of points, and the number of points
+//   at a position can be shown by the size or opacity of its vertex.
+//
+// General design philosophy:
+//   1) When the vertices change, each point is hashed by the bits of its
+//      x, y, and z into a table of distinct positions.  Hashing gives up
+//      as soon as there are too many positions for collapsing to be worth
+//      it, and the plot draws every point as before.
+//   2) After each gather, the points of each (position, brush) pair are
+//      counted in one pass over the points, and one vertex with its count
+//      is emitted for each pair that has any.  Vertices are laid out by
+//      brush and then by count class, the power of two below the count.
+//   3) Vertices are drawn from client memory with fixed function state,
+//      so blending, stencils, and sprites work as they do for points.
+//      Sizes are set per count class.  Opacities are set per vertex, as
+//      the opacity that count points drawn on top of each other build up.
+//   4) Line strips connect points in order, so plots that draw a brush as
+//      lines are never collapsed.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef POINT_COLLAPSER_H
+#define POINT_COLLAPSER_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "vertex_source.h"
+
+//***************************************************************************
+// Class: Point_Collapser
+//
+// Class definitions:
+//   Point_Collapser -- Draw each distinct position of a plot's points once
+//
+// Classes referenced:
+//   Plot_Window
+//
+// Purpose: Keep the distinct positions of one plot's vertices, count the
+//   points of each brush at each of them, and draw them.
+//
+// Functions:
+//   Point_Collapser() -- Constructor
+//
+//   update( vertices, n) -- Bring the counts up to date, if worthwhile
+//   total( brush) -- Number of distinct positions of a brush
+//   draw( brush, style, size, color) -- Draw the positions of a brush
+//   data_changed() -- Discard the positions because the vertices changed
+//
+//   group( vertices, n) -- Hash the points into distinct positions
+//   collapse() -- Count the points of each brush at each position
+//
+// Static functions:
+//   count_class( count) -- Power of two at or below a count
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Point_Collapser
+{
+  public:
+    // How to show the number of points at a position
+    enum collapse_styles { STYLE_PLAIN=0, STYLE_SIZE, STYLE_ALPHA};
+
+    // Average number of points per position below which collapsing isn't
+    // worth it, and number of count classes
+    static const int min_repeats = 2;
+    static const int nclasses = 32;
+
+  protected:
+    // Distinct positions, three floats each, and the position of each
+    // point.  Empty if the vertices weren't worth collapsing.
+    std::vector<float> positions_;
+    std::vector<int> group_;
+    int grouped_;
+
+    // Vertices and counts of each (position, brush) pair.  Those of brush
+    // b and count class k run from starts_[b*nclasses+k] up to
+    // starts_[b*nclasses+k+1].
+    std::vector<float> vertices_;
+    std::vector<float> counts_;
+    std::vector<int> starts_;
+    int generation_;
+
+    // Per-vertex colors for STYLE_ALPHA
+    std::vector<GLfloat> colors_;
+
+    void group( const Vertex_Source &vertices, int n);
+    void collapse();
+
+    static int count_class( int count);
+
+  public:
+    Point_Collapser();
+
+    int update( const Vertex_Source &vertices, int n);
+    int total( int brush)
+    { return starts_[ (brush+1)*nclasses] - starts_[ brush*nclasses];}
+    void draw( int brush, int style, float size, const GLfloat color[4]);
+    void data_changed();
+};
+
+#endif   // POINT_COLLAPSER_H
@@ -0,0 +1,407 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: point_sampler.cpp
+//
+// Class definitions:
+//   Point_Sampler -- Level of detail for drawing points while interacting
+//
+// Classes referenced:
+//   Plot_Window -- Source of the gathered selection, and the plot to redraw
+//   Worker_Pool -- Runs the sorting passes
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    OGLEXP 1.2.2 -- Access to OpenGL extension under Windows
+//    GSL 1.6 -- Gnu Scientific Library package for Windows
+//    Blitz++ 0.9 -- Various math routines
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <point_sampler.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "point_sampler.h"
+#include "plot_window.h"
+#include "worker_pool.h"
+#include "column_buffers.h"
+
+// Set static data members for class Point_Sampler::
+const double Point_Sampler::frame_time = 1.0/30.0;
+const double Point_Sampler::idle_delay = 0.3;
+std::vector<unsigned short> Point_Sampler::keys_;
+std::vector<unsigned int> Point_Sampler::order_;
+std::vector<int> Point_Sampler::bucket_start_;
+int Point_Sampler::order_generation_ = -1;
+double Point_Sampler::last_interaction_ = 0.0;
+
+//***************************************************************************
+// Point_Sampler::Point_Sampler() -- Constructor
+Point_Sampler::Point_Sampler() :
+  budget_( initial_budget), nkeys_drawn_( nkeys), timing_( 0),
+  start_time_( 0.0), seconds_( 0.0), pw_( NULL),
+  query_( 0), query_running_( 0), query_pending_( 0), query_ndrawn_( 0),
+  query_epoch_( -1),
+  use_box_( 0), box_generation_( -1)
+{}
+
+//***************************************************************************
+// Point_Sampler::~Point_Sampler() -- Destructor
+Point_Sampler::~Point_Sampler()
+{
+  Fl::remove_timeout( idle_cb, (void*) this);
+}
+
+//***************************************************************************
+// Point_Sampler::now() -- STATIC method to get the wall clock time in
+// seconds.
+double Point_Sampler::now()
+{
+  struct timeval tp;
+  (void) gettimeofday( &tp, (struct timezone *)0);
+  return (double)tp.tv_sec + 1.0E-6*(double)tp.tv_usec;
+}
+
+//***************************************************************************
+// Point_Sampler::timer_queries() -- STATIC method to check, once, for
+// timer queries, which need OpenGL 3.3 or ARB_timer_query.
+int Point_Sampler::timer_queries()
+{
+  static int result = -1;
+  if( result >= 0) return result;
+  const char *version = (const char *) glGetString( GL_VERSION);
+  const char *extensions = (const char *) glGetString( GL_EXTENSIONS);
+  if( version == NULL) return 0;
+  result =
+    atof( version) >= 3.3 ||
+    ( extensions != NULL &&
+      strstr( extensions, "GL_ARB_timer_query") != NULL);
+  return result;
+}
+
+//***************************************************************************
+// Point_Sampler::note_interaction() -- STATIC method to record input that
+// changes a view or the selection.  Plots draw samples until there has
+// been none for idle_delay seconds.
+void Point_Sampler::note_interaction()
+{
+  last_interaction_ = now();
+}
+
+//***************************************************************************
+// Point_Sampler::end_interaction() -- STATIC method to record that a drag
+// has ended, so the plots it redraws next show every point.
+void Point_Sampler::end_interaction()
+{
+  last_interaction_ = 0.0;
+}
+
+//***************************************************************************
+// Point_Sampler::begin_frame( *pw, spinning, total) -- Decide how many
+// keys' worth of points plot pw can draw this frame, given the total
+// number of points it would draw in full.  Frames are only reduced while
+// the user is interacting or the plot is spinning.
+void Point_Sampler::begin_frame( Plot_Window *pw, int spinning, int total)
+{
+  pw_ = pw;
+  nkeys_drawn_ = nkeys;
+  timing_ = 0;
+  if( !simplify_while_interacting) return;
+  if( !spinning && now() - last_interaction_ >= idle_delay) return;
+
+  // Draw whole keys so the sample is uniform within every brush
+  if( total > budget_ && ( use_box_ || update_order())) {
+    nkeys_drawn_ = (int) ceil( nkeys * budget_ / total);
+    nkeys_drawn_ = max( 1, min( nkeys_drawn_, (int) nkeys));
+  }
+  timing_ = 1;
+  start_timing();
+}
+
+//***************************************************************************
+// Point_Sampler::start_timing() -- Start timing a frame.  With timer
+// queries, the result of an earlier frame is read back if it is ready, and
+// a new query is only started once it has been, so no frame waits for the
+// GPU.  The query is made again if its context has gone.
+void Point_Sampler::start_timing()
+{
+  start_time_ = now();
+  if( !timer_queries() || query_running_) return;
+  collect();
+  if( query_pending_) return;
+  if( query_ == 0 || query_epoch_ != Column_Buffers::epoch() ||
+      !glIsQuery( query_)) {
+    glGenQueries( 1, &query_);
+    query_epoch_ = Column_Buffers::epoch();
+  }
+  glBeginQuery( GL_TIME_ELAPSED, query_);
+  query_running_ = 1;
+}
+
+//***************************************************************************
+// Point_Sampler::end_frame( ndrawn) -- On interactive frames, end the timer
+// query, whose result moves the budget once it is read back.  Without
+// timer queries, wait for the GPU and adjust the budget by the wall clock
+// now.  After a reduced frame, arm the timer that redraws the plot in full.
+void Point_Sampler::end_frame( int ndrawn)
+{
+  if( timing_) {
+    if( query_running_) {
+      glEndQuery( GL_TIME_ELAPSED);
+      query_running_ = 0;
+      query_pending_ = 1;
+      query_ndrawn_ = ndrawn;
+    }
+    else if( !timer_queries() && ndrawn > 0) {
+
+      // Wait for the GPU, or only the time to queue the points is measured
+      glFinish();
+      adjust( ndrawn, now() - start_time_);
+    }
+    timing_ = 0;
+  }
+  if( reduced()) {
+    Fl::remove_timeout( idle_cb, (void*) this);
+    Fl::add_timeout( idle_delay, idle_cb, (void*) this);
+  }
+}
+
+//***************************************************************************
+// Point_Sampler::collect() -- Read back the timer query of an earlier
+// frame if the GPU has finished it, and adjust the budget.  A query whose
+// context has gone is forgotten.
+void Point_Sampler::collect()
+{
+  if( !query_pending_) return;
+  if( query_epoch_ != Column_Buffers::epoch() || !glIsQuery( query_)) {
+    query_pending_ = 0;
+    return;
+  }
+  GLint available = 0;
+  glGetQueryObjectiv( query_, GL_QUERY_RESULT_AVAILABLE, &available);
+  if( !available) return;
+  GLuint64 nanoseconds = 0;
+  glGetQueryObjectui64v( query_, GL_QUERY_RESULT, &nanoseconds);
+  query_pending_ = 0;
+  adjust( query_ndrawn_, 1.0e-9 * nanoseconds);
+}
+
+//***************************************************************************
+// Point_Sampler::adjust( ndrawn, elapsed) -- Record that ndrawn points
+// took elapsed seconds, and move the budget toward the number of points
+// that fit in this plot's share of frame_time.
+void Point_Sampler::adjust( int ndrawn, double elapsed)
+{
+  seconds_ = elapsed;
+  if( elapsed <= 0.0 || ndrawn <= 0) return;
+  double target = ndrawn * ( frame_time / max( nplots, 1)) / elapsed;
+  budget_ = 0.5*budget_ + 0.5*target;
+  budget_ = min( max( budget_, (double) min_budget), 1.0e9);
+}
+
+//***************************************************************************
+// Point_Sampler::make_keys() -- STATIC method to draw a random key for
+// every point if the number of points has changed.
+void Point_Sampler::make_keys()
+{
+  if( (int) keys_.size() == npoints) return;
+  keys_.resize( npoints);
+  for( int i=0; i<npoints; i++)
+    keys_[i] = (unsigned short) gsl_rng_uniform_int( vp_gsl_rng, nkeys);
+  order_generation_ = -1;
+}
+
+//***************************************************************************
+// Point_Sampler::sort( pass, n, starts) -- STATIC method to sort n points,
+// or n candidates, into pass.order by brush and then key, using a
+// parallel counting sort with per-chunk counts.  Bucket boundaries are
+// returned in starts.
+void Point_Sampler::sort( Pass &pass, int n, std::vector<int> &starts)
+{
+  int nbuckets = NBRUSHES*nkeys;
+  pass.nchunks = 1;
+  if( worker_pool != NULL && n >= 1<<18)
+    pass.nchunks = 4 * ( worker_pool->nthreads() + 1);
+  pass.offsets.assign( pass.nchunks * nbuckets, 0);
+
+  // Count each chunk's points in each bucket
+  if( pass.nchunks > 1)
+    worker_pool->parallel_for( n, pass.nchunks, count_chunk, (void*) &pass);
+  else if( n > 0) count_chunk( 0, n, 0, (void*) &pass);
+
+  // Turn the counts into the position of each chunk's first point in each
+  // bucket, with buckets in order of brush and then key
+  starts.resize( nbuckets+1);
+  int position = 0;
+  for( int b=0; b<nbuckets; b++) {
+    starts[b] = position;
+    for( int c=0; c<pass.nchunks; c++) {
+      int count = pass.offsets[ c*nbuckets + b];
+      pass.offsets[ c*nbuckets + b] = position;
+      position += count;
+    }
+  }
+  starts[ nbuckets] = position;
+
+  // Place the points.  Chunks cover the same ranges in both passes.
+  if( pass.nchunks > 1)
+    worker_pool->parallel_for( n, pass.nchunks, place_chunk, (void*) &pass);
+  else if( n > 0) place_chunk( 0, n, 0, (void*) &pass);
+}
+
+//***************************************************************************
+// Point_Sampler::update_order() -- STATIC method to sort all the points of
+// each brush by key as of the last gather.  Returns 0 if there has been no
+// gather for these data.
+int Point_Sampler::update_order()
+{
+  int n = npoints;
+  if( n <= 0 || Plot_Window::gathered_selection.rows() != n) return 0;
+  make_keys();
+  if( order_generation_ == Plot_Window::selection_generation &&
+      (int) order_.size() == n) return 1;
+
+  Pass pass;
+  pass.codes = Plot_Window::gathered_selection.data();
+  pass.candidates = NULL;
+  pass.vertices = NULL;
+  order_.resize( n);
+  pass.order = &(order_[0]);
+  sort( pass, n, bucket_start_);
+  order_generation_ = Plot_Window::selection_generation;
+  return 1;
+}
+
+//***************************************************************************
+// Point_Sampler::visible( xmin, xmax, ymin, ymax) -- Are the box lists up
+// to date and do they cover this view?  The box must also not be much
+// larger than the view, or zooming in wouldn't make frames cheaper.
+int Point_Sampler::visible( float xmin, float xmax, float ymin, float ymax)
+{
+  if( !use_box_ || box_generation_ != Plot_Window::selection_generation)
+    return 0;
+  if( xmin < box_[0] || xmax > box_[1] || ymin < box_[2] || ymax > box_[3])
+    return 0;
+  return ( box_[1] - box_[0]) <= 4*( xmax - xmin) &&
+         ( box_[3] - box_[2]) <= 4*( ymax - ymin);
+}
+
+//***************************************************************************
+// Point_Sampler::use_box( candidates, n, vertices, box) -- Sort the points
+// among n candidates whose (x,y), read from vertices, lies in box = {xmin,
+// xmax, ymin, ymax} into this plot's own lists, and draw from them until
+// use_all() is called.  Returns 0 if there has been no gather for these
+// data.
+int Point_Sampler::use_box(
+  const int *candidates, int n, const Vertex_Source &vertices,
+  const float box[4])
+{
+  use_box_ = 0;
+  box_generation_ = -1;
+  if( npoints <= 0 || Plot_Window::gathered_selection.rows() != npoints)
+    return 0;
+  make_keys();
+
+  Pass pass;
+  pass.codes = Plot_Window::gathered_selection.data();
+  pass.candidates = candidates;
+  pass.vertices = &vertices;
+  for( int k=0; k<4; k++) pass.box[k] = box_[k] = box[k];
+  box_order_.resize( max( n, 1));
+  pass.order = &(box_order_[0]);
+  sort( pass, n, box_start_);
+  box_generation_ = Plot_Window::selection_generation;
+  use_box_ = 1;
+  return 1;
+}
+
+//***************************************************************************
+// Point_Sampler::use_all() -- Draw from the lists of all points, and free
+// the box lists.
+void Point_Sampler::use_all()
+{
+  if( !use_box_) return;
+  use_box_ = 0;
+  box_generation_ = -1;
+  std::vector<unsigned int>().swap( box_order_);
+}
+
+//***************************************************************************
+// Point_Sampler::data_changed() -- Discard the box lists because the
+// vertices have changed.
+void Point_Sampler::data_changed()
+{
+  use_all();
+}
+
+//***************************************************************************
+// Point_Sampler::count_chunk( begin, end, ichunk, *data) -- STATIC body of
+// the counting pass over points, or candidates, begin to end.
+void Point_Sampler::count_chunk( int begin, int end, int ichunk, void *data)
+{
+  Pass *pass = (Pass *) data;
+  const int *codes = pass->codes;
+  const unsigned short *keys = &(keys_[0]);
+  int *counts = &(pass->offsets[ ichunk*NBRUSHES*nkeys]);
+  if( pass->candidates == NULL) {
+    for( int i=begin; i<end; i++) counts[ codes[i]*nkeys + keys[i]]++;
+    return;
+  }
+  const float *box = pass->box;
+  for( int j=begin; j<end; j++) {
+    int i = pass->candidates[j];
+    float x = pass->vertices->value( 0, i), y = pass->vertices->value( 1, i);
+    if( x >= box[0] && x <= box[1] && y >= box[2] && y <= box[3])
+      counts[ codes[i]*nkeys + keys[i]]++;
+  }
+}
+
+//***************************************************************************
+// Point_Sampler::place_chunk( begin, end, ichunk, *data) -- STATIC body of
+// the placing pass over points, or candidates, begin to end.  Within a 
+// bucket, points stay in the order they were given.
+void Point_Sampler::place_chunk( int begin, int end, int ichunk, void *data)
+{
+  Pass *pass = (Pass *) data;
+  const int *codes = pass->codes;
+  const unsigned short *keys = &(keys_[0]);
+  unsigned int *order = pass->order;
+  int *offsets = &(pass->offsets[ ichunk*NBRUSHES*nkeys]);
+  if( pass->candidates == NULL) {
+    for( int i=begin; i<end; i++)
+      order[ offsets[ codes[i]*nkeys + keys[i]]++] = i;
+    return;
+  }
+  const float *box = pass->box;
+  for( int j=begin; j<end; j++) {
+    int i = pass->candidates[j];
+    float x = pass->vertices->value( 0, i), y = pass->vertices->value( 1, i);
+    if( x >= box[0] && x <= box[1] && y >= box[2] && y <= box[3])
+      order[ offsets[ codes[i]*nkeys + keys[i]]++] = i;
+  }
+}
+
+//***************************************************************************
+// Point_Sampler::idle_cb( *data) -- STATIC callback to redraw a plot in full
+// once there has been no input for idle_delay seconds.  A plot that is
+// still spinning draws another sample and arms the timer again.
+void Point_Sampler::idle_cb( void *data)
+{
+  Point_Sampler *s = (Point_Sampler *) data;
+  double wait = idle_delay - ( now() - last_interaction_);
+  if( wait > 0.001) {
+    Fl::repeat_timeout( wait, idle_cb, data);
+    return;
+  }
+  if( s->pw_ != NULL) s->pw_->schedule_redraw( Frame_Scheduler::REDRAW_VIEW);
+}
@@ -0,0 +1,225 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: point_sampler.h
+//
+// Class definitions:
+//   Point_Sampler -- Choose which points a plot draws: a sample of them
+//     while the user interacts, and only the visible ones when zoomed in
+//
+// Classes referenced:
+//   Plot_Window -- Source of the gathered selection, and the plot to redraw
+//   Worker_Pool -- Runs the sorting passes
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Keep plots responsive while the user pans, zooms, spins, or
+//   brushes by drawing only a random sample of each brush's points, sized
+//   to fit a time budget, then redrawing every point once input stops.
+//
+// General design philosophy:
+//   1) Every point gets a fixed random key.  After each gather, the points
+//      of each brush are sorted by key in one parallel counting sort, so a
+//      prefix of a brush's list that ends on a key boundary is a uniform
+//      random sample of that brush.  Keys are only drawn again when the
+//      number of points changes, so the sample is stable from frame to
+//      frame and the display doesn't shimmer.
+//   2) Each plot has its own budget of points per frame.  The time to draw
+//      the points is measured on interactive frames, and the budget moves
+//      toward what fits in that plot's share of the frame time.  The GPU
+//      time comes from a timer query read back on a later frame, so timing
+//      never waits for the GPU.  Without timer queries, the frame waits
+//      for the GPU and is timed by the wall clock.
+//   3) All brushes are drawn with the same fraction of their points, and
+//      the caller raises alpha or point size to make up for the points
+//      left out.
+//   4) A reduced frame arms a timer.  Once there has been no input for a
+//      short while, the plot is redrawn with every point.
+//   5) When a plot is zoomed in, the caller finds the points in a box
+//      around the view from the rank order of one axis, and they are
+//      sorted by brush and key the same way into lists for that plot
+//      alone.  Samples are then prefixes of those lists, so the cost of a
+//      frame follows the number of visible points.  The box has a margin,
+//      so the lists are only rebuilt when a pan or zoom leaves it.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef POINT_SAMPLER_H
+#define POINT_SAMPLER_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "vertex_source.h"
+
+// Declare class Plot_Window so it can be used for arguments
+class Plot_Window;
+
+//***************************************************************************
+// Class: Point_Sampler
+//
+// Class definitions:
+//   Point_Sampler -- Level of detail for drawing points while interacting
+//
+// Classes referenced:
+//   Plot_Window, Worker_Pool
+//
+// Purpose: Decide how many points one plot can draw per interactive frame,
+//   and supply the sample order of every brush's points, either all of
+//   them or those in a box around the plot's view.
+//
+// Functions:
+//   Point_Sampler() -- Constructor
+//   ~Point_Sampler() -- Destructor
+//
+//   begin_frame( *pw, spinning, total) -- Choose the fraction for a frame
+//   end_frame( ndrawn) -- Stop timing the frame, arm the timer
+//   time_frame() -- Time a frame that isn't interactive
+//   start_timing() -- Start the clock or the timer query for a frame
+//   collect() -- Read back the timer query of an earlier frame
+//   adjust( ndrawn, elapsed) -- Move the budget toward the frame's share
+//   budget() -- Number of points this plot can draw per frame
+//   seconds() -- Time the points of the last timed frame took
+//   ordered() -- Make sure the lists in use are sorted
+//   reduced() -- Is this frame drawing a sample?
+//   compensation() -- Factor by which the sample is sparser than the data
+//   prefix( brush) -- Number of points of a brush to draw
+//   order( brush) -- Indices of a brush's points in sample order
+//   total( brush) -- Number of points of a brush in the lists
+//
+//   visible( xmin, xmax, ymin, ymax) -- Do the box lists cover a view?
+//   use_box( candidates, n, vertices, box) -- Build lists for a box
+//   use_all() -- Go back to the lists of all points
+//   data_changed() -- Discard the box lists because the vertices changed
+//   starts() -- Bucket boundaries of the lists in use
+//
+// Static functions:
+//   note_interaction() -- Record user input that changes the view
+//   end_interaction() -- Record the end of a drag
+//   now() -- Wall clock time in seconds
+//   timer_queries() -- Can the GPU time of a frame be measured?
+//   make_keys() -- Draw keys if the number of points has changed
+//   update_order() -- Sort the points of each brush by key
+//   sort( pass, n, starts) -- Counting sort by brush and key
+//   count_chunk( begin, end, ichunk, *data) -- Body of the counting pass
+//   place_chunk( begin, end, ichunk, *data) -- Body of the placing pass
+//   idle_cb( *data) -- Redraw in full once input stops
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Point_Sampler
+{
+  public:
+    // Number of keys, smallest and starting budgets of points per frame,
+    // and largest factor made up for by alpha or size
+    static const int nkeys = 1024;
+    static const int min_budget = 20000;
+    static const int initial_budget = 500000;
+    static const int max_compensation = 8;
+
+    // Seconds allowed to draw the points of all plots in one frame, and
+    // seconds without input before plots are redrawn in full
+    static const double frame_time;
+    static const double idle_delay;
+
+  protected:
+    // This plot's budget, and the frame being drawn
+    double budget_;
+    int nkeys_drawn_;
+    int timing_;
+    double start_time_;
+    double seconds_;
+    Plot_Window *pw_;
+
+    // Timer query, whether it is running or waiting to be read back, the
+    // points drawn while it ran, and the set of contexts it belongs to
+    GLuint query_;
+    int query_running_, query_pending_;
+    int query_ndrawn_;
+    int query_epoch_;
+
+    // Lists of the points in a box around this plot's view, laid out like
+    // the shared lists, and what they were made from
+    int use_box_;
+    std::vector<unsigned int> box_order_;
+    std::vector<int> box_start_;
+    float box_[4];
+    int box_generation_;
+
+    // Keys, and the indices of the points sorted by brush and then key.
+    // The points of brush b with key k are order_[bucket_start_[b*nkeys+k]]
+    // up to order_[bucket_start_[b*nkeys+k+1]].
+    static std::vector<unsigned short> keys_;
+    static std::vector<unsigned int> order_;
+    static std::vector<int> bucket_start_;
+    static int order_generation_;
+    static double last_interaction_;
+
+    // Arguments and per-chunk counts for the parallel passes.  With
+    // candidates, only those inside the box are sorted.
+    struct Pass {
+      const int *codes;
+      int nchunks;
+      std::vector<int> offsets;
+      const int *candidates;
+      const Vertex_Source *vertices;
+      float box[4];
+      unsigned int *order;
+    };
+
+    const std::vector<int> &starts()
+    { return use_box_ ? box_start_ : bucket_start_;}
+    void start_timing();
+    void collect();
+    void adjust( int ndrawn, double elapsed);
+    static void make_keys();
+    static void sort( Pass &pass, int n, std::vector<int> &starts);
+    static int update_order();
+    static void count_chunk( int begin, int end, int ichunk, void *data);
+    static void place_chunk( int begin, int end, int ichunk, void *data);
+    static void idle_cb( void *data);
+
+  public:
+    Point_Sampler();
+    ~Point_Sampler();
+
+    void begin_frame( Plot_Window *pw, int spinning, int total);
+    void end_frame( int ndrawn);
+    void time_frame() { timing_ = 1; start_timing();}
+    int budget() { return (int) budget_;}
+    double seconds() { return seconds_;}
+    int ordered() { return use_box_ || update_order();}
+    int reduced() { return nkeys_drawn_ < nkeys;}
+    double compensation()
+    { return min( (double) nkeys / nkeys_drawn_, (double) max_compensation);}
+    int prefix( int brush)
+    { return starts()[ brush*nkeys + nkeys_drawn_] - starts()[ brush*nkeys];}
+    const unsigned int *order( int brush)
+    { return use_box_ ? &(box_order_[ box_start_[ brush*nkeys]]) :
+                        &(order_[ bucket_start_[ brush*nkeys]]);}
+    int total( int brush)
+    { return starts()[ (brush+1)*nkeys] - starts()[ brush*nkeys];}
+
+    int visible( float xmin, float xmax, float ymin, float ymax);
+    int use_box(
+      const int *candidates, int n, const Vertex_Source &vertices,
+      const float box[4]);
+    void use_all();
+    void data_changed();
+
+    static void note_interaction();
+    static void end_interaction();
+    static double now();
+    static int timer_queries();
+};
+
+#endif   // POINT_SAMPLER_H
@@ -0,0 +1,207 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: progressive_renderer.cpp
+//
+// Class definitions:
+//   Progressive_Renderer -- Draw a plot's points over several frames
+//
+// Classes referenced:
+//   Plot_Window -- Draws each frame's share of the points
+//   Column_Buffers -- Tells when GL contexts were made again
+//
+// Required packages
+//    OGLEXP 1.2.2 -- Access to OpenGL extension under Windows
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <progressive_renderer.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "progressive_renderer.h"
+#include "column_buffers.h"
+
+//***************************************************************************
+// Progressive_Renderer::Progressive_Renderer() -- Constructor
+Progressive_Renderer::Progressive_Renderer() :
+  framebuffer_( 0), width_( 0), height_( 0), epoch_( -1),
+  total_( 0), done_( 0), first_( 0), last_( 0),
+  restart_( 1), restarting_( 0),
+  previous_framebuffer_( 0), scissor_( GL_FALSE)
+{
+  renderbuffers_[0] = renderbuffers_[1] = 0;
+  for( int i=0; i<4; i++) viewport_[i] = 0;
+}
+
+//***************************************************************************
+// Progressive_Renderer::available() -- STATIC method to check, once, for
+// framebuffer objects that can be copied to the window, which need OpenGL
+// 3.0 or ARB_framebuffer_object.
+int Progressive_Renderer::available()
+{
+  static int result = -1;
+  if( result >= 0) return result;
+  const char *version = (const char *) glGetString( GL_VERSION);
+  const char *extensions = (const char *) glGetString( GL_EXTENSIONS);
+  if( version == NULL) return 0;
+  result =
+    atof( version) >= 3.0 ||
+    ( extensions != NULL &&
+      strstr( extensions, "GL_ARB_framebuffer_object") != NULL);
+  return result;
+}
+
+//***************************************************************************
+// Progressive_Renderer::make_framebuffer( width, height) -- Make a
+// framebuffer of a size, with the planes a plot window has, in place of
+// the old one.  The old one is only deleted if its context still exists.
+// Returns 0, leaving no framebuffer, if it can't be completed.
+int Progressive_Renderer::make_framebuffer( int width, int height)
+{
+  if( framebuffer_ != 0 && epoch_ == Column_Buffers::epoch()) {
+    glDeleteRenderbuffers( 2, renderbuffers_);
+    glDeleteFramebuffers( 1, &framebuffer_);
+  }
+  framebuffer_ = 0;
+  width_ = width;
+  height_ = height;
+  epoch_ = Column_Buffers::epoch();
+  if( width <= 0 || height <= 0) return 0;
+
+  GLint previous = 0;
+  glGetIntegerv( GL_FRAMEBUFFER_BINDING, &previous);
+  glGenFramebuffers( 1, &framebuffer_);
+  glBindFramebuffer( GL_FRAMEBUFFER, framebuffer_);
+  glGenRenderbuffers( 2, renderbuffers_);
+  glBindRenderbuffer( GL_RENDERBUFFER, renderbuffers_[ 0]);
+  glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glFramebufferRenderbuffer(
+    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers_[ 0]);
+  glBindRenderbuffer( GL_RENDERBUFFER, renderbuffers_[ 1]);
+  glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  glFramebufferRenderbuffer(
+    GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+    renderbuffers_[ 1]);
+  glBindRenderbuffer( GL_RENDERBUFFER, 0);
+
+  int complete =
+    glCheckFramebufferStatus( GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+  glBindFramebuffer( GL_FRAMEBUFFER, previous);
+  if( !complete) {
+    cerr << "Progressive_Renderer::make_framebuffer: ERROR, incomplete "
+         << "framebuffer of " << width << " by " << height << endl;
+    glDeleteRenderbuffers( 2, renderbuffers_);
+    glDeleteFramebuffers( 1, &framebuffer_);
+    framebuffer_ = 0;
+    return 0;
+  }
+  return 1;
+}
+
+//***************************************************************************
+// Progressive_Renderer::begin( width, height, total, chunk) -- Bind the
+// framebuffer of a plot of a size, with its own viewport and no scissor
+// test, to draw up to chunk more of the total points.  If this frame
+// starts over, the framebuffer is cleared the way a plot window is.
+// Returns 0, having changed nothing, if there is no framebuffer.
+int Progressive_Renderer::begin( int width, int height, int total, int chunk)
+{
+  int remade =
+    epoch_ != Column_Buffers::epoch() || width != width_ || height != height_;
+  if( remade && !make_framebuffer( width, height)) return 0;
+  if( framebuffer_ == 0) return 0;
+
+  restarting_ = restart_ || remade || total != total_;
+  if( restarting_) {
+    restart_ = 0;
+    total_ = total;
+    done_ = 0;
+  }
+  first_ = done_;
+  last_ = min( total_, done_ + max( chunk, 1));
+
+  glGetIntegerv( GL_FRAMEBUFFER_BINDING, &previous_framebuffer_);
+  glGetIntegerv( GL_VIEWPORT, viewport_);
+  scissor_ = glIsEnabled( GL_SCISSOR_TEST);
+  glDisable( GL_SCISSOR_TEST);
+  glBindFramebuffer( GL_FRAMEBUFFER, framebuffer_);
+  glViewport( 0, 0, width_, height_);
+  if( restarting_) {
+    glClearColor( 0.0, 0.0, 0.0, 0.0);
+    glClearDepth( 0.0);
+    glClearStencil( 0);
+    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+  }
+  return 1;
+}
+
+//***************************************************************************
+// Progressive_Renderer::segment( offset, count, first) -- Get the number
+// of points this frame draws of a brush whose count points start at offset
+// in the sequence, and in first, the position of the first of them in the
+// brush's list.
+int Progressive_Renderer::segment( int offset, int count, int &first)
+{
+  int begin = max( offset, first_), end = min( offset+count, last_);
+  first = begin - offset;
+  return max( end - begin, 0);
+}
+
+//***************************************************************************
+// Progressive_Renderer::end( x, y) -- Put back the framebuffer, viewport,
+// and scissor test, and copy the points drawn so far to the plot's corner
+// at x, y.  Until every point is drawn, a bar along the bottom of the plot
+// shows how many have been.  The caller asks for the next frame.
+void Progressive_Renderer::end( int x, int y)
+{
+  glBindFramebuffer( GL_FRAMEBUFFER, previous_framebuffer_);
+  glViewport( viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+  if( scissor_) glEnable( GL_SCISSOR_TEST);
+  glBindFramebuffer( GL_READ_FRAMEBUFFER, framebuffer_);
+  glBlitFramebuffer(
+    0, 0, width_, height_, x, y, x+width_, y+height_,
+    GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  glBindFramebuffer( GL_FRAMEBUFFER, previous_framebuffer_);
+
+  done_ = last_;
+  if( !complete()) draw_progress();
+}
+
+//***************************************************************************
+// Progressive_Renderer::draw_progress() -- Draw the fraction of the points
+// drawn so far as a bar along the bottom of the plot's viewport.
+void Progressive_Renderer::draw_progress()
+{
+  float right = -1.0 + 2.0 * done_ / max( total_, 1);
+  float top = -1.0 + 2.0 * bar_height / max( height_, 1);
+
+  glMatrixMode( GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity();
+  glMatrixMode( GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+  glDisable( GL_DEPTH_TEST);
+  glBlendFunc( GL_ONE, GL_ZERO);
+  glColor4f( 0.6, 0.6, 0.6, 1.0);
+  glBegin( GL_QUADS);
+  glVertex2f( -1.0, -1.0);
+  glVertex2f( right, -1.0);
+  glVertex2f( right, top);
+  glVertex2f( -1.0, top);
+  glEnd();
+  glPopMatrix();
+  glMatrixMode( GL_PROJECTION);
+  glPopMatrix();
+  glMatrixMode( GL_MODELVIEW);
+}
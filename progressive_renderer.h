@@ -0,0 +1,122 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: progressive_renderer.h
+//
+// Class definitions:
+//   Progressive_Renderer -- Draw a plot's points over several frames
+//
+// Classes referenced:
+//   Plot_Window -- Draws each frame's share of the points
+//   Column_Buffers -- Tells when GL contexts were made again
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: A plot with more points than it can draw in one frame blocks
+//   the interface for as long as the drawing takes.  Such a plot instead
+//   draws as many points per frame as fit in its budget, adds them to the
+//   points of earlier frames, and shows the result with a progress bar
+//   until every point has been drawn.  Events are handled between frames.
+//
+// General design philosophy:
+//   1) Frames accumulate in a framebuffer object of the plot's own, with
+//      the color, depth, and stencil planes of a plot window, which is
+//      copied to the window after each frame.  The window's back buffer
+//      can't be used, since its contents are undefined after a swap.
+//   2) The points of the brushes drawn, in the order they would be drawn
+//      in one frame, form one sequence, and each frame draws the next
+//      stretch of it.  Each brush's points come in sample order, so early
+//      frames show a uniform sample of every brush, and the finished
+//      image is the one a single frame would have drawn.
+//   3) The stretch drawn per frame is the plot's Point_Sampler budget,
+//      and progressive frames are timed like interactive ones.
+//   4) Any reason to redraw the plot other than the next stretch, and any
+//      change of size, total, or GL context, starts over.  A finished
+//      plot is redrawn by copying the framebuffer, which is cheap.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef PROGRESSIVE_RENDERER_H
+#define PROGRESSIVE_RENDERER_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Progressive_Renderer
+//
+// Class definitions:
+//   Progressive_Renderer -- Draw a plot's points over several frames
+//
+// Classes referenced:
+//   Plot_Window, Column_Buffers
+//
+// Purpose: Keep the framebuffer one plot accumulates in, and which stretch
+//   of its points the current frame draws.
+//
+// Functions:
+//   Progressive_Renderer() -- Constructor
+//
+//   restart() -- Start over with the next frame
+//   begin( width, height, total, chunk) -- Bind the framebuffer for a frame
+//   restarting() -- Does this frame start over?
+//   segment( offset, count, &first) -- This frame's share of a brush
+//   end( x, y) -- Copy the framebuffer to the window, show progress
+//   complete() -- Have all the points been drawn?
+//
+//   make_framebuffer( width, height) -- Make a framebuffer of a size
+//   draw_progress() -- Draw the progress bar
+//
+// Static functions:
+//   available() -- Can framebuffers be copied to windows?
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Progressive_Renderer
+{
+  public:
+    // Height of the progress bar in pixels
+    static const int bar_height = 3;
+
+  protected:
+    // The framebuffer, its size, and the set of contexts it belongs to
+    GLuint framebuffer_, renderbuffers_[ 2];
+    int width_, height_;
+    int epoch_;
+
+    // Points in the sequence, points drawn by earlier frames, and the
+    // stretch drawn by this one
+    int total_, done_;
+    int first_, last_;
+    int restart_, restarting_;
+
+    // State to put back once the frame is done
+    GLint previous_framebuffer_;
+    GLint viewport_[ 4];
+    GLboolean scissor_;
+
+    int make_framebuffer( int width, int height);
+    void draw_progress();
+
+  public:
+    Progressive_Renderer();
+
+    void restart() { restart_ = 1;}
+    int begin( int width, int height, int total, int chunk);
+    int restarting() { return restarting_;}
+    int segment( int offset, int count, int &first);
+    void end( int x, int y);
+    int complete() { return done_ >= total_;}
+
+    static int available();
+};
+
+#endif   // PROGRESSIVE_RENDERER_H
@@ -0,0 +1,253 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: selection_history.cpp
+//
+// Class definitions:
+//   Selection_History -- Compressed history of selections for undo/redo
+//
+// Classes referenced: none
+//
+// Required packages
+//    Blitz++ 0.9 -- Various math routines
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <selection_history.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "selection_history.h"
+#include "plot_window.h"
+
+//***************************************************************************
+// Selection_History::Selection_History() -- Constructor
+Selection_History::Selection_History() :
+  current_( 0), bytes_( 0), last_generation_( -1)
+{}
+
+//***************************************************************************
+// Selection_History::~Selection_History() -- Destructor
+Selection_History::~Selection_History()
+{
+  clear();
+}
+
+//***************************************************************************
+// Selection_History::clear() -- Discard all steps and the last recorded
+// state.  The next push will record its changes relative to an empty
+// selection.
+void Selection_History::clear()
+{
+  for( unsigned int i=0; i<steps_.size(); i++) delete steps_[i];
+  steps_.clear();
+  current_ = 0;
+  bytes_ = 0;
+  last_.clear();
+  last_generation_ = -1;
+}
+
+//***************************************************************************
+// Selection_History::encode( delta) -- Compare the global selected array
+// with the last recorded state, store the differences in delta, and bring
+// the last recorded state up to date.  Returns the number of points that
+// changed.
+int Selection_History::encode( Delta *delta)
+{
+  delta->containers.clear();
+  delta->words.clear();
+  const int *codes = selected.data();
+  unsigned char *last = &(last_[0]);
+  int nchanged = 0;
+
+  // Loop: Examine successive chunks, gathering the offsets of changed
+  // points, and counting their runs, separately for each XOR value
+  std::vector<unsigned short> offsets[ 8];
+  int nruns[ 8];
+  for( int base=0; base<npoints; base+=chunk_size) {
+    int end = base + chunk_size;
+    if( end > npoints) end = npoints;
+    for( int v=0; v<8; v++) {
+      offsets[v].clear();
+      nruns[v] = 0;
+    }
+    for( int i=base; i<end; i++) {
+      unsigned char x = (unsigned char) (last[i] ^ codes[i]) & 7;
+      if( x) {
+        unsigned short offset = (unsigned short) (i-base);
+        if( offsets[x].empty() || offsets[x].back() != offset-1) nruns[x]++;
+        offsets[x].push_back( offset);
+        last[i] ^= x;
+      }
+    }
+
+    // Store each nonzero XOR value in whichever form is smallest
+    for( int v=1; v<8; v++) {
+      int count = offsets[v].size();
+      if( count == 0) continue;
+      nchanged += count;
+      Container c;
+      c.chunk = base >> chunk_bits;
+      c.code_xor = (unsigned char) v;
+      c.first = delta->words.size();
+      if( 2*nruns[v] < count && 2*nruns[v] < dense_words) {
+        c.form = RUNS;
+        for( int j=0; j<count; ) {
+          int k = j+1;
+          while( k < count && offsets[v][k] == offsets[v][k-1]+1) k++;
+          delta->words.push_back( offsets[v][j]);
+          delta->words.push_back( (unsigned short) (k-j-1));
+          j = k;
+        }
+      }
+      else if( count > dense_words) {
+        c.form = DENSE;
+        delta->words.resize( c.first + dense_words, 0);
+        unsigned short *bits = &(delta->words[ c.first]);
+        for( int j=0; j<count; j++)
+          bits[ offsets[v][j] >> 4] |= 1u << (offsets[v][j] & 15);
+      }
+      else {
+        c.form = SPARSE;
+        delta->words.insert(
+          delta->words.end(), offsets[v].begin(), offsets[v].end());
+      }
+      c.length = delta->words.size() - c.first;
+      delta->containers.push_back( c);
+    }
+  }
+
+  // Keep only the memory the step needs
+  std::vector<Container>( delta->containers).swap( delta->containers);
+  std::vector<unsigned short>( delta->words).swap( delta->words);
+  delta->bytes =
+    sizeof( Delta) + delta->containers.size()*sizeof( Container) +
+    delta->words.size()*sizeof( unsigned short);
+  return nchanged;
+}
+
+//***************************************************************************
+// Selection_History::apply( delta) -- XOR a delta into the last recorded
+// state.  This moves one step forward or back, depending on where we are.
+void Selection_History::apply( const Delta *delta)
+{
+  unsigned char *last = &(last_[0]);
+  for( unsigned int k=0; k<delta->containers.size(); k++) {
+    const Container &c = delta->containers[k];
+    unsigned char *chunk = last + (c.chunk << chunk_bits);
+    const unsigned short *words = &(delta->words[ c.first]);
+    if( c.form == DENSE) {
+      for( int w=0; w<c.length; w++) {
+        unsigned int word = words[w];
+        for( int b=0; word != 0; b++, word >>= 1)
+          if( word & 1) chunk[ (w << 4) + b] ^= c.code_xor;
+      }
+    }
+    else if( c.form == RUNS) {
+      for( int j=0; j<c.length; j+=2) {
+        unsigned char *p = chunk + words[j];
+        for( int n=0; n<=words[j+1]; n++) p[n] ^= c.code_xor;
+      }
+    }
+    else {
+      for( int j=0; j<c.length; j++) chunk[ words[j]] ^= c.code_xor;
+    }
+  }
+}
+
+//***************************************************************************
+// Selection_History::restore() -- Copy the last recorded state into the
+// global selection arrays.
+void Selection_History::restore()
+{
+  int *codes = selected.data();
+  for( int i=0; i<npoints; i++) codes[i] = last_[i];
+  previously_selected = selected;
+  newly_selected = 0;
+  selection_is_inverted = false;
+}
+
+//***************************************************************************
+// Selection_History::enforce_limits() -- Discard the oldest steps until
+// the number of steps and the memory they use are within limits.  Always
+// keep the newest step.
+void Selection_History::enforce_limits()
+{
+  while( steps_.size() > 1 && current_ > 0 &&
+         ( (int) steps_.size() > max_steps || bytes_ > max_bytes)) {
+    bytes_ -= steps_.front()->bytes;
+    delete steps_.front();
+    steps_.pop_front();
+    current_--;
+  }
+}
+
+//***************************************************************************
+// Selection_History::push() -- Record the current selection as a new step,
+// discarding any steps that could have been redone.  Does nothing if the
+// selection has not changed since the last step was recorded.
+void Selection_History::push()
+{
+  if( last_generation_ == Plot_Window::selection_generation &&
+      (int) last_.size() == npoints) return;
+  if( (int) last_.size() != npoints) {
+    clear();
+    last_.assign( npoints, 0);
+  }
+  last_generation_ = Plot_Window::selection_generation;
+
+  Delta *delta = new Delta;
+  if( encode( delta) == 0) {
+    delete delta;
+    return;
+  }
+
+  while( (int) steps_.size() > current_) {
+    bytes_ -= steps_.back()->bytes;
+    delete steps_.back();
+    steps_.pop_back();
+  }
+  steps_.push_back( delta);
+  bytes_ += delta->bytes;
+  current_++;
+  enforce_limits();
+}
+
+//***************************************************************************
+// Selection_History::undo() -- Record any pending changes, then step back
+// and restore the selection.  Returns 1 if the selection was changed.  The
+// caller must gather the index arrays and redraw.
+int Selection_History::undo()
+{
+  push();
+  if( current_ <= 0) return 0;
+  current_--;
+  apply( steps_[ current_]);
+  restore();
+  return 1;
+}
+
+//***************************************************************************
+// Selection_History::redo() -- Record any pending changes, which discards
+// the steps that could have been redone, then step forward and restore the
+// selection.  Returns 1 if the selection was changed.  The caller must 
+// gather the index arrays and redraw.
+int Selection_History::redo()
+{
+  push();
+  if( (int) last_.size() != npoints || current_ >= (int) steps_.size())
+    return 0;
+  apply( steps_[ current_]);
+  current_++;
+  restore();
+  return 1;
+}
@@ -0,0 +1,139 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: selection_history.h
+//
+// Class definitions:
+//   Selection_History -- Compressed history of selections for undo/redo
+//
+// Classes referenced: none
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Record successive states of the global selected array so the
+//   user can undo and redo brushing operations.
+//
+// General design philosophy:
+//   1) Each step is stored as the XOR of the brush codes before and after
+//      the step.  Since XOR is its own inverse, the same delta moves the
+//      selection forward (redo) or backward (undo), and no full snapshots
+//      are needed.
+//   2) Deltas are compressed in the style of roaring bitmaps.  Points are
+//      split into chunks of 65536.  For each chunk and each nonzero XOR
+//      value, the changed points are stored as a sorted list of 16-bit
+//      offsets (sparse), as runs of consecutive offsets, or as an 8 KB
+//      bitmap (dense), whichever is smallest.  Unchanged chunks cost
+//      nothing.  Whole-range operations such as clearing, inverting, or
+//      selecting everything are one run per chunk, about 20 bytes, so a
+//      step over 10^8 points costs some 30 KB.  A brush that picks points
+//      scattered through the file costs at most one bit per point per
+//      distinct XOR value, so at 10^8 points max_bytes holds about twenty
+//      such steps at worst.
+//   3) The only full-size buffer is a one byte per point copy of the last
+//      recorded state, used to compute the next delta.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef SELECTION_HISTORY_H
+#define SELECTION_HISTORY_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Selection_History
+//
+// Class definitions:
+//   Selection_History -- Compressed history of selections for undo/redo
+//
+// Classes referenced: none
+//
+// Purpose: Maintain a bounded stack of compressed selection deltas.
+//
+// Functions:
+//   Selection_History() -- Constructor
+//   ~Selection_History() -- Destructor
+//
+//   push() -- Record the current selection as a new step
+//   undo() -- Step back, returns 1 if selected was changed
+//   redo() -- Step forward, returns 1 if selected was changed
+//   clear() -- Discard all history (e.g., when the data change)
+//   can_undo() -- Is there a step to undo?
+//   can_redo() -- Is there a step to redo?
+//   memory_used() -- Bytes used by stored deltas
+//
+//   encode( delta) -- Compare selected with last_ to build a delta
+//   apply( delta) -- XOR a delta into last_
+//   restore() -- Copy last_ into selected
+//   enforce_limits() -- Discard old steps to respect the limits
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Selection_History
+{
+  protected:
+    // Points whose brush codes differ by a given XOR value within one chunk.
+    // Its words, words [first,first+length) of its delta, are offsets for
+    // the sparse form, pairs of the first offset and length-1 for runs, or
+    // 16-bit words of a bitmap for the dense form.
+    enum Form { SPARSE = 0, RUNS, DENSE};
+    struct Container {
+      int chunk;
+      unsigned char code_xor;
+      unsigned char form;
+      int first;
+      int length;
+    };
+
+    // One step of history
+    struct Delta {
+      std::vector<Container> containers;
+      std::vector<unsigned short> words;
+      long bytes;
+    };
+
+    // Stored steps.  Steps [0,current_) can be undone, the rest redone.
+    std::deque<Delta*> steps_;
+    int current_;
+    long bytes_;
+
+    // Last recorded state, and the selection generation it corresponds to
+    std::vector<unsigned char> last_;
+    int last_generation_;
+
+    int encode( Delta *delta);
+    void apply( const Delta *delta);
+    void restore();
+    void enforce_limits();
+
+  public:
+    Selection_History();
+    ~Selection_History();
+
+    void push();
+    int undo();
+    int redo();
+    void clear();
+    int can_undo() { return current_ > 0;}
+    int can_redo() { return current_ < (int) steps_.size();}
+    long memory_used() { return bytes_;}
+
+    // Chunk size, and the number of 16-bit words in a chunk's bitmap
+    static const int chunk_bits = 16;
+    static const int chunk_size = 1 << chunk_bits;
+    static const int dense_words = chunk_size/16;
+
+    // Limits on the number of steps and the memory they may use
+    static const int max_steps = 512;
+    static const long max_bytes = 256L*1024L*1024L;
+};
+
+#endif   // SELECTION_HISTORY_H
@@ -0,0 +1,287 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: selection_worker.cpp
+//
+// Class definitions:
+//   Selection_Worker -- Evaluate brush footprints on a worker thread
+//
+// Classes referenced:
+//   Plot_Window -- Source of footprints and consumer of results
+//   Worker_Pool -- Runs the evaluation
+//   Brush -- Selection mode of the current brush
+//
+// Required packages
+//    FLTK 1.1.6 -- Fast Light Toolkit graphics package
+//    Blitz++ 0.9 -- Various math routines
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <selection_worker.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "selection_worker.h"
+#include "worker_pool.h"
+#include "plot_window.h"
+#include "brush.h"
+
+// Set static data members for class Selection_Worker::
+const double Selection_Worker::poll_interval = 0.005;
+
+//***************************************************************************
+// Selection_Worker::Selection_Worker() -- Constructor
+Selection_Worker::Selection_Worker() :
+  pw_( NULL), npoints_( 0), previously_( NULL), brush_index_( 0), paint_( 0),
+  mask_( 0), request_generation_( 0), running_( 0), ready_( 0),
+  cancel_( 0), polling_( 0)
+{
+  pthread_mutex_init( &mutex_, NULL);
+  pthread_cond_init( &cond_, NULL);
+}
+
+//***************************************************************************
+// Selection_Worker::~Selection_Worker() -- Destructor
+Selection_Worker::~Selection_Worker()
+{
+  cancel();
+  pthread_cond_destroy( &cond_);
+  pthread_mutex_destroy( &mutex_);
+}
+
+//***************************************************************************
+// Selection_Worker::begin( *pw) -- Start handling a drag in plot window pw.
+// Capture the brush mode and the arrays the worker will read, and seed the
+// private buffers from the current selection.
+void Selection_Worker::begin( Plot_Window *pw)
+{
+  finish();
+
+  Brush *bp = dynamic_cast <Brush*> (brushes_tab->value());
+  assert( bp);
+  brush_index_ = bp->index;
+  paint_ = bp->paint->value();
+  mask_ = mask_out_deselected->value();
+
+  pw_ = pw;
+  npoints_ = npoints;
+  vertices_ = pw->vertex_source;
+  previously_ = previously_selected.data();
+
+  selected_.assign( selected.data(), selected.data() + npoints_);
+  newly_.assign( newly_selected.data(), newly_selected.data() + npoints_);
+  inside_.assign( npoints_, 0);
+  out_inside_.resize( npoints_);
+  out_newly_.resize( npoints_);
+  out_selected_.resize( npoints_);
+
+  pending_.clear();
+  request_generation_ = 0;
+  ready_ = 0;
+}
+
+//***************************************************************************
+// Selection_Worker::publish( xdown, ydown, xtracked, ytracked) -- Post the
+// newest footprint and make sure the worker and the polling timeout are
+// running.  Returns immediately, unless there is no worker pool, as in the
+// processes forked to render headless, in which case the footprint is
+// evaluated and installed before returning.
+void Selection_Worker::publish(
+  float xdown, float ydown, float xtracked, float ytracked)
+{
+  if( pw_ == NULL) return;
+
+  Box box;
+  box.xmin = fminf( xdown, xtracked);
+  box.xmax = fmaxf( xdown, xtracked);
+  box.ymin = fminf( ydown, ytracked);
+  box.ymax = fmaxf( ydown, ytracked);
+
+  int start = 0;
+  pthread_mutex_lock( &mutex_);
+  if( !paint_) pending_.clear();
+  pending_.push_back( box);
+  request_generation_++;
+  if( !running_) {
+    running_ = 1;
+    start = 1;
+  }
+  pthread_mutex_unlock( &mutex_);
+
+  // Without a worker pool, evaluate the footprint right here
+  if( worker_pool == NULL) {
+    if( start) run_job( (void*) this);
+    if( install()) Plot_Window::redraw_all_plots( pw_->index);
+    return;
+  }
+
+  if( start) worker_pool->submit( run_job, (void*) this);
+  if( !polling_) {
+    polling_ = 1;
+    Fl::add_timeout( poll_interval, timeout_cb, (void*) this);
+  }
+}
+
+//***************************************************************************
+// Selection_Worker::evaluate( boxes, generation) -- Run one pass over all
+// points, applying the footprint and brush mode in the same way as
+// Plot_Window::update_selection_from_footprint().  Returns 0 if the pass
+// was abandoned because a newer footprint arrived or we were cancelled.
+int Selection_Worker::evaluate( const std::vector<Box> &boxes, int generation)
+{
+  int nboxes = boxes.size();
+  const Box &last = boxes[ nboxes-1];
+  int *inside = &(inside_[0]);
+  int *newly = &(newly_[0]);
+  int *sel = &(selected_[0]);
+
+  // Loop: Examine successive chunks, checking for newer work in between
+  for( int base=0; base<npoints_; base+=chunk_size) {
+    if( cancel_) return 0;
+    if( !paint_ && request_generation_ != generation) return 0;
+    int end = base + chunk_size;
+    if( end > npoints_) end = npoints_;
+
+    for( int i=base; i<end; i++) {
+      float x = vertices_.value( 0, i);
+      float y = vertices_.value( 1, i);
+      int in = ( x>=last.xmin && x<=last.xmax && y>=last.ymin && y<=last.ymax);
+      inside[i] = in;
+      if( paint_) {
+        for( int k=0; k<nboxes-1 && !in; k++)
+          in = ( x>=boxes[k].xmin && x<=boxes[k].xmax &&
+                 y>=boxes[k].ymin && y<=boxes[k].ymax);
+        newly[i] |= in;
+      }
+      else newly[i] = in;
+
+      if( mask_ && brush_index_>0)
+        sel[i] = ( newly[i] && sel[i]) ? brush_index_ : previously_[i];
+      else if( mask_ && brush_index_==0)
+        sel[i] = !newly[i] ? brush_index_ : previously_[i];
+      else
+        sel[i] = newly[i] ? brush_index_ : previously_[i];
+    }
+  }
+  return 1;
+}
+
+//***************************************************************************
+// Selection_Worker::run_job( *data) -- STATIC body of the worker job.  Keep
+// taking footprints until there are none left.  Each completed pass is
+// copied to the output buffers for the main thread to pick up.
+void Selection_Worker::run_job( void *data)
+{
+  Selection_Worker *w = (Selection_Worker *) data;
+  std::vector<Box> boxes;
+
+  pthread_mutex_lock( &w->mutex_);
+  while( !w->cancel_ && !w->pending_.empty()) {
+    boxes.swap( w->pending_);
+    w->pending_.clear();
+    int generation = w->request_generation_;
+    pthread_mutex_unlock( &w->mutex_);
+
+    int completed = w->evaluate( boxes, generation);
+
+    pthread_mutex_lock( &w->mutex_);
+    if( completed && !w->cancel_) {
+      w->out_inside_ = w->inside_;
+      w->out_newly_ = w->newly_;
+      w->out_selected_ = w->selected_;
+      w->ready_ = 1;
+    }
+  }
+  w->running_ = 0;
+  pthread_cond_broadcast( &w->cond_);
+  pthread_mutex_unlock( &w->mutex_);
+}
+
+//***************************************************************************
+// Selection_Worker::install() -- If a completed result is waiting, copy it
+// into the global selection arrays and gather.  Returns 1 if the selection
+// was changed.  Main thread only.
+int Selection_Worker::install()
+{
+  pthread_mutex_lock( &mutex_);
+  if( !ready_ || npoints_ != npoints || selected.rows() < npoints_) {
+    pthread_mutex_unlock( &mutex_);
+    return 0;
+  }
+  std::copy( out_inside_.begin(), out_inside_.end(), inside_footprint.data());
+  std::copy( out_newly_.begin(), out_newly_.end(), newly_selected.data());
+  std::copy( out_selected_.begin(), out_selected_.end(), selected.data());
+  ready_ = 0;
+  pthread_mutex_unlock( &mutex_);
+
+  pw_->color_array_from_selection();
+  return 1;
+}
+
+//***************************************************************************
+// Selection_Worker::timeout_cb( *data) -- STATIC callback to install
+// results as they arrive.  Stops itself when the worker is idle and
+// everything has been installed.
+void Selection_Worker::timeout_cb( void *data)
+{
+  Selection_Worker *w = (Selection_Worker *) data;
+  if( w->pw_ == NULL) {
+    w->polling_ = 0;
+    return;
+  }
+  if( w->install()) Plot_Window::redraw_all_plots( w->pw_->index);
+
+  pthread_mutex_lock( &w->mutex_);
+  int busy = w->running_ || w->ready_;
+  pthread_mutex_unlock( &w->mutex_);
+  if( busy) Fl::repeat_timeout( poll_interval, timeout_cb, data);
+  else w->polling_ = 0;
+}
+
+//***************************************************************************
+// Selection_Worker::finish() -- Wait for the worker to take care of every
+// footprint that was published, install the final result, and end the
+// drag.  Returns 1 if the selection was changed, in which case the caller
+// should redraw.
+int Selection_Worker::finish()
+{
+  if( pw_ == NULL) return 0;
+  pthread_mutex_lock( &mutex_);
+  while( running_) pthread_cond_wait( &cond_, &mutex_);
+  pthread_mutex_unlock( &mutex_);
+
+  int changed = install();
+  Fl::remove_timeout( timeout_cb, (void*) this);
+  polling_ = 0;
+  pw_ = NULL;
+  return changed;
+}
+
+//***************************************************************************
+// Selection_Worker::cancel() -- Stop the worker, wait for it, and discard
+// its results.  Used before the data or the selection arrays change.
+void Selection_Worker::cancel()
+{
+  if( pw_ == NULL) return;
+  cancel_ = 1;
+  pthread_mutex_lock( &mutex_);
+  pending_.clear();
+  while( running_) pthread_cond_wait( &cond_, &mutex_);
+  ready_ = 0;
+  pthread_mutex_unlock( &mutex_);
+  cancel_ = 0;
+
+  Fl::remove_timeout( timeout_cb, (void*) this);
+  polling_ = 0;
+  pw_ = NULL;
+}
@@ -0,0 +1,136 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: selection_worker.h
+//
+// Class definitions:
+//   Selection_Worker -- Evaluate brush footprints on a worker thread
+//
+// Classes referenced:
+//   Plot_Window -- Source of footprints and consumer of results
+//   Worker_Pool -- Runs the evaluation
+//
+// Required packages
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Keep box selection responsive while dragging by moving the
+//   evaluation of the footprint off the FLTK event loop.
+//
+// General design philosophy:
+//   1) Each FL_DRAG publishes the newest footprint and returns, so the
+//      selection box tracks the cursor at full frame rate.
+//   2) Latest wins.  A pass that sees a newer footprint abandons its work
+//      at the next chunk boundary and starts over.  In paint mode every
+//      footprint matters, so footprints that arrive during a pass are
+//      instead batched into the next one.
+//   3) The worker writes only to private buffers.  When a pass completes
+//      they are copied to an output buffer, and a timeout on the main
+//      thread installs the most recent completed result in the global
+//      selection arrays, gathers, and redraws.
+//   4) The worker reads the plot's vertices and previously_selected, so
+//      anything that changes them must call finish() or cancel() first.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef SELECTION_WORKER_H
+#define SELECTION_WORKER_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "vertex_source.h"
+
+//***************************************************************************
+// Class: Selection_Worker
+//
+// Class definitions:
+//   Selection_Worker -- Evaluate brush footprints on a worker thread
+//
+// Classes referenced:
+//   Plot_Window, Worker_Pool
+//
+// Purpose: Latest-wins asynchronous evaluation of box selections.
+//
+// Functions:
+//   Selection_Worker() -- Constructor
+//   ~Selection_Worker() -- Destructor
+//
+//   begin( *pw) -- Start a drag in plot window pw
+//   publish( xdown, ydown, xtracked, ytracked) -- Post a new footprint
+//   finish() -- Wait for the worker and install its final result
+//   cancel() -- Stop the worker and discard its results
+//   active() -- Is a drag being handled asynchronously?
+//
+//   install() -- Copy the latest result into the global selection arrays
+//   evaluate( boxes, generation) -- Run one pass over all points
+//
+// Static functions:
+//   run_job( *data) -- Body of the worker job
+//   timeout_cb( *data) -- Periodic callback while the worker is busy
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Selection_Worker
+{
+  protected:
+    // Footprint of a box brush, in world coordinates
+    struct Box {
+      float xmin, xmax, ymin, ymax;
+    };
+
+    // Plot window and selection mode captured when the drag began
+    Plot_Window *pw_;
+    int npoints_;
+    Vertex_Source vertices_;
+    const int *previously_;
+    int brush_index_;
+    int paint_, mask_;
+
+    // Footprints waiting for the worker, and a counter that changes with
+    // every new footprint.  Protected by mutex_.
+    std::vector<Box> pending_;
+    volatile int request_generation_;
+    int running_;
+    int ready_;
+    volatile int cancel_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+
+    // Private working buffers, and the latest completed result
+    std::vector<int> inside_, newly_, selected_;
+    std::vector<int> out_inside_, out_newly_, out_selected_;
+    int polling_;
+
+    int install();
+    int evaluate( const std::vector<Box> &boxes, int generation);
+
+    static void run_job( void *data);
+    static void timeout_cb( void *data);
+
+  public:
+    Selection_Worker();
+    ~Selection_Worker();
+
+    void begin( Plot_Window *pw);
+    void publish( float xdown, float ydown, float xtracked, float ytracked);
+    int finish();
+    void cancel();
+    int active() { return pw_ != NULL;}
+
+    // Number of points examined between checks for a newer footprint
+    static const int chunk_size = 65536;
+
+    // Interval between checks for a completed result, in seconds
+    static const double poll_interval;
+};
+
+#endif   // SELECTION_WORKER_H
@@ -0,0 +1,159 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: symbol_atlas.cpp
+//
+// Class definitions:
+//   Symbol_Atlas -- One texture that holds every point symbol
+//
+// Classes referenced:
+//   Column_Buffers -- Its shaders draw the symbols from the atlas
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <symbol_atlas.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "symbol_atlas.h"
+#include "column_buffers.h"
+
+// Set static data members for class Symbol_Atlas::
+GLuint Symbol_Atlas::texture_ = 0;
+int Symbol_Atlas::epoch_ = -1;
+
+// Distance from each texel of a cell to the nearest texel whose inside
+// flag is want, found by propagating nearest texels forward and then
+// backward across the cell (dead reckoning).  Used by distance_field().
+static void nearest_distance(
+  const std::vector<int> &inside, int want, std::vector<float> &distance)
+{
+  const int n = Symbol_Atlas::cell;
+  std::vector<int> nx( n*n, -1), ny( n*n, -1);
+  distance.assign( n*n, 2.0*n);
+  for( int i=0; i<n*n; i++) {
+    if( inside[i] != want) continue;
+    distance[i] = 0.0;
+    nx[i] = i % n;
+    ny[i] = i / n;
+  }
+
+  static const int neighbors[2][4][2] = {
+    { {-1,-1}, { 0,-1}, { 1,-1}, {-1, 0}},
+    { { 1, 0}, {-1, 1}, { 0, 1}, { 1, 1}}};
+  for( int pass=0; pass<2; pass++) {
+    for( int k=0; k<n*n; k++) {
+      int i = ( pass == 0) ? k : n*n-1-k;
+      int x = i % n, y = i / n;
+      for( int j=0; j<4; j++) {
+        int qx = x + neighbors[pass][j][0], qy = y + neighbors[pass][j][1];
+        if( qx < 0 || qx >= n || qy < 0 || qy >= n) continue;
+        int q = qy*n + qx;
+        if( nx[q] < 0) continue;
+        float dx = x - nx[q], dy = y - ny[q];
+        float d = sqrt( dx*dx + dy*dy);
+        if( d < distance[i]) {
+          distance[i] = d;
+          nx[i] = nx[q];
+          ny[i] = ny[q];
+        }
+      }
+    }
+  }
+}
+
+//***************************************************************************
+// Symbol_Atlas::texture( data) -- STATIC method to get the name of the
+// atlas, making it from the NSYMBOLS RGB images in data if this is the
+// first time in this set of GL contexts.  Returns 0 if it can't be made.
+GLuint Symbol_Atlas::texture( GLubyte *const data[ NSYMBOLS])
+{
+  if( epoch_ != Column_Buffers::epoch()) {
+    texture_ = 0;
+    epoch_ = Column_Buffers::epoch();
+  }
+  if( texture_ != 0) return texture_;
+
+  // Loop: Fill a cell for each symbol that is drawn as a sprite
+  const int side = columns*cell;
+  std::vector<GLubyte> texels( side*side*4, 0);
+  for( int symbol=2; symbol<NSYMBOLS && symbol<columns*columns; symbol++) {
+    GLubyte *corner =
+      &texels[ 4*( (symbol/columns)*cell*side + (symbol%columns)*cell)];
+    distance_field( data[symbol], corner);
+  }
+
+  // Mipmaps are made by the driver as the atlas is loaded
+  glGenTextures( 1, &texture_);
+  glBindTexture( GL_TEXTURE_2D, texture_);
+  glTexParameteri( GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexImage2D(
+    GL_TEXTURE_2D, 0, GL_RGBA, side, side, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+    &texels[0]);
+  if( glGetError() != GL_NO_ERROR) {
+    cerr << "Symbol_Atlas::texture: can't load the symbol atlas" << endl;
+    glDeleteTextures( 1, &texture_);
+    texture_ = 0;
+  }
+  return texture_;
+}
+
+//***************************************************************************
+// Symbol_Atlas::hard_edged( rgb) -- STATIC method to decide whether a
+// symbol's image is mostly dark or bright, with grey only along its edges,
+// rather than shaded.
+int Symbol_Atlas::hard_edged( const GLubyte *rgb)
+{
+  int bright = 0, grey = 0;
+  for( int i=0; i<cell*cell; i++) {
+    if( rgb[3*i] > 223) bright++;
+    else if( rgb[3*i] >= 32) grey++;
+  }
+  return grey < bright;
+}
+
+//***************************************************************************
+// Symbol_Atlas::distance_field( rgb, texels) -- STATIC method to fill the
+// cell whose upper left texel is texels from a symbol's RGB image.  The
+// distance field is 0.5 on the edges of the symbol, where the image crosses
+// half brightness, and rises to 1 or falls to 0 spread texels inside or
+// outside them.
+void Symbol_Atlas::distance_field( const GLubyte *rgb, GLubyte *texels)
+{
+  const int n = cell, side = columns*cell;
+  std::vector<int> inside( n*n);
+  for( int i=0; i<n*n; i++) inside[i] = rgb[3*i] >= 128;
+  std::vector<float> to_inside, to_outside;
+  nearest_distance( inside, 1, to_inside);
+  nearest_distance( inside, 0, to_outside);
+
+  GLubyte hard = hard_edged( rgb) ? 255 : 0;
+  for( int y=0; y<n; y++) {
+    for( int x=0; x<n; x++) {
+      int i = y*n + x;
+      float d = inside[i] ? to_outside[i] - 0.5 : 0.5 - to_inside[i];
+      float a = 0.5 + 0.5 * d / spread;
+      a = a < 0.0 ? 0.0 : ( a > 1.0 ? 1.0 : a);
+      GLubyte *texel = texels + 4*( y*side + x);
+      texel[0] = rgb[3*i];
+      texel[1] = hard;
+      texel[2] = 0;
+      texel[3] = (GLubyte) ( 255.0*a + 0.5);
+    }
+  }
+}
@@ -0,0 +1,90 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: symbol_atlas.h
+//
+// Class definitions:
+//   Symbol_Atlas -- One texture that holds every point symbol
+//
+// Classes referenced:
+//   Column_Buffers -- Its shaders draw the symbols from the atlas
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Replace the texture per symbol, each built with
+//   gluBuild2DMipmaps when sprites are first drawn, with a single atlas.
+//   The shader picks each brush's symbol from the atlas, so no texture is
+//   switched between brushes and brushes with different symbols can be
+//   drawn in one call.
+//
+// General design philosophy:
+//   1) The atlas is a grid of columns x columns cells, one per symbol,
+//      each the size of the images in Sprite_Textures.  Symbols 0 and 1,
+//      plain points and line strips, leave their cells empty.
+//   2) Each texel holds the symbol's luminance in red, whether the symbol
+//      has hard edges in green, and a signed distance field of its edges in
+//      alpha.  The shader draws hard-edged symbols from the distance field,
+//      so their edges stay sharp at any point size.  Soft symbols, such as
+//      the Gaussian blob, are drawn from their luminance as before.
+//   3) Cells are powers of two in size and aligned, so the driver can make
+//      mipmaps of the whole atlas without mixing symbols until the smallest
+//      levels.
+//   4) The atlas lives in the GL contexts FLTK shares between plots, and
+//      is made again after they have all been destroyed.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef SYMBOL_ATLAS_H
+#define SYMBOL_ATLAS_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+//***************************************************************************
+// Class: Symbol_Atlas
+//
+// Class definitions:
+//   Symbol_Atlas -- One texture that holds every point symbol
+//
+// Classes referenced:
+//   Column_Buffers -- Supplies the epoch of the GL contexts
+//
+// Purpose: Static methods that make the atlas texture the first time it is
+//   needed.
+//
+// Functions:
+//   texture( data) -- Name of the atlas, made from the images in data
+//
+//   hard_edged( *rgb) -- Is a symbol's image hard-edged?
+//   distance_field( *rgb, *texels) -- Fill a cell with a symbol
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Symbol_Atlas
+{
+  public:
+    // Cells per row and column, texels per side of a cell, and texels on
+    // either side of an edge covered by the distance field
+    static const int columns = 8;
+    static const int cell = 64;
+    static const int spread = 8;
+
+    static GLuint texture( GLubyte *const data[ NSYMBOLS]);
+
+  protected:
+    static GLuint texture_;
+    static int epoch_;
+
+    static int hard_edged( const GLubyte *rgb);
+    static void distance_field( const GLubyte *rgb, GLubyte *texels);
+};
+
+#endif   // SYMBOL_ATLAS_H
@@ -0,0 +1,92 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: vertex_source.cpp
+//
+// Class definitions:
+//   Vertex_Source -- Where work on the CPU reads a plot's vertices from
+//
+// Classes referenced: none
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <vertex_source.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "vertex_source.h"
+
+//***************************************************************************
+// Vertex_Source::Vertex_Source() -- Constructor
+Vertex_Source::Vertex_Source()
+{
+  clear();
+}
+
+//***************************************************************************
+// Vertex_Source::clear() -- Read nothing until told where to read.
+void Vertex_Source::clear()
+{
+  for( int axis=0; axis<3; axis++) {
+    axes_[axis] = NULL;
+    strides_[axis] = 0;
+    functions_[axis] = Column_Buffers::FUNCTION_NONE;
+  }
+  mix_ = 0;
+}
+
+//***************************************************************************
+// Vertex_Source::use_vertices( vertices, vertex_stride, coord_stride) --
+// Read an array of vertices, with vertex_stride floats from one vertex to
+// the next and coord_stride from one coordinate to the next.
+void Vertex_Source::use_vertices(
+  const float *vertices, long vertex_stride, long coord_stride)
+{
+  for( int axis=0; axis<3; axis++) {
+    axes_[axis] = vertices + axis*coord_stride;
+    strides_[axis] = vertex_stride;
+    functions_[axis] = Column_Buffers::FUNCTION_NONE;
+  }
+  mix_ = 0;
+}
+
+//***************************************************************************
+// Vertex_Source::use_columns( columns, strides, functions, mix) -- Read
+// each axis from a column with its own stride, or as zero if the column
+// is NULL, through the function Column_Buffers names for it.  If mix is
+// set, x and y are turned to sum-vs-difference.
+void Vertex_Source::use_columns(
+  const float *columns[3], const long strides[3], const int functions[3],
+  int mix)
+{
+  for( int axis=0; axis<3; axis++) {
+    axes_[axis] = columns[axis];
+    strides_[axis] = strides[axis];
+    functions_[axis] = functions[axis];
+  }
+  mix_ = mix;
+}
+
+//***************************************************************************
+// Vertex_Source::operator==( other) -- Do two sources read the same
+// vertices?  Engines that cache results use this to tell when the data
+// under them changed.
+int Vertex_Source::operator==( const Vertex_Source &other) const
+{
+  for( int axis=0; axis<3; axis++)
+    if( axes_[axis] != other.axes_[axis] ||
+        strides_[axis] != other.strides_[axis] ||
+        functions_[axis] != other.functions_[axis]) return 0;
+  return mix_ == other.mix_;
+}
@@ -0,0 +1,145 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: vertex_source.h
+//
+// Class definitions:
+//   Vertex_Source -- Where work on the CPU reads a plot's vertices from
+//
+// Classes referenced:
+//   Plot_Window -- Chooses where its vertices are read from
+//
+// Required packages: none
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Let the selection, histograms, density estimates, and the other
+//   work done on the CPU read a plot's vertices without the plot keeping a
+//   copy of them.  A plot whose axes are all drawn by the vertex shader
+//   from shared columns reads those columns, applying the same function
+//   to each axis, and the same sum-vs-difference transform, as the shader.
+//   Other plots read their own array of vertices.
+//
+// General design philosophy:
+//   1) Each axis is a pointer and a stride, so the same reads serve three
+//      columns or one interleaved array.  An axis without a pointer, such
+//      as the z-axis of a 2D plot, reads as zero.
+//   2) Reading a coordinate is inline and has no side effects, so the
+//      worker threads can share one source.
+//   3) The functions match Plot_Window::normalize() and
+//      Plot_Window::transform_2d(), so a vertex read here is the vertex
+//      the CPU would have stored.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef VERTEX_SOURCE_H
+#define VERTEX_SOURCE_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "column_buffers.h"
+
+//***************************************************************************
+// Class: Vertex_Source
+//
+// Class definitions:
+//   Vertex_Source -- Where work on the CPU reads a plot's vertices from
+//
+// Classes referenced:
+//   Column_Buffers -- Names the functions applied to each axis
+//
+// Purpose: Read the coordinates of a plot's points.
+//
+// Functions:
+//   Vertex_Source() -- Constructor
+//
+//   use_vertices( *vertices, vertex_stride, coord_stride) -- Read an
+//     array of vertices
+//   use_columns( *columns[], strides[], functions[], mix) -- Read columns
+//     through the shader's functions and transform
+//   clear() -- Read nothing
+//   valid() -- Is there anything to read?
+//   operator==( other) -- Do two sources read the same vertices?
+//   value( axis, i) -- Coordinate axis of point i
+//   vertex( i, p) -- All three coordinates of point i
+//
+//   apply( axis, i) -- Column axis of point i, through its function
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Vertex_Source
+{
+  protected:
+    const float *axes_[3];
+    long strides_[3];
+    int functions_[3];
+    int mix_;
+
+    inline float apply( int axis, long i) const;
+
+  public:
+    Vertex_Source();
+
+    void use_vertices(
+      const float *vertices, long vertex_stride, long coord_stride);
+    void use_columns(
+      const float *columns[3], const long strides[3], const int functions[3],
+      int mix);
+    void clear();
+    int valid() const { return axes_[0] != NULL;}
+    int operator==( const Vertex_Source &other) const;
+    int operator!=( const Vertex_Source &other) const
+    { return !( *this == other);}
+    inline float value( int axis, long i) const;
+    inline void vertex( long i, float p[3]) const;
+};
+
+//***************************************************************************
+// Vertex_Source::apply( axis, i) -- Read column axis of point i, and apply
+// its function as normalize() would.
+inline float Vertex_Source::apply( int axis, long i) const
+{
+  if( axes_[axis] == NULL) return 0.0;
+  float a = axes_[axis][ i*strides_[axis]];
+  switch( functions_[axis]) {
+  case Column_Buffers::FUNCTION_LOG10:
+    return a > 0.0 ? (float) log10( a) : 0.0;
+  case Column_Buffers::FUNCTION_SQUASH:
+    return a / ( 1 + fabsf( a));
+  default:
+    return a;
+  }
+}
+
+//***************************************************************************
+// Vertex_Source::value( axis, i) -- Read coordinate axis of point i, turned
+// to sum-vs-difference as transform_2d() would if mix is set.
+inline float Vertex_Source::value( int axis, long i) const
+{
+  if( !mix_ || axis == 2) return apply( axis, i);
+  float x = apply( 0, i), y = apply( 1, i);
+  if( axis == 0) return (sqrt(2.0)/2.0) * ( x + y);
+  return (sqrt(2.0)/2.0) * ( y - x);
+}
+
+//***************************************************************************
+// Vertex_Source::vertex( i, p) -- Read all three coordinates of point i.
+inline void Vertex_Source::vertex( long i, float p[3]) const
+{
+  for( int axis=0; axis<3; axis++) p[axis] = apply( axis, i);
+  if( mix_) {
+    float x = p[0], y = p[1];
+    p[0] = (sqrt(2.0)/2.0) * ( x + y);
+    p[1] = (sqrt(2.0)/2.0) * ( y - x);
+  }
+}
+
+#endif   // VERTEX_SOURCE_H
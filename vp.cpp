@@ -47,6 +47,8 @@
 //
 // Functions:
 //   usage() -- Print help information
+//   screen_width() -- Width of the screen, or of a nominal one if headless
+//   screen_height() -- Height of the screen, or of a nominal one if headless
 //   make_help_about_window( *o) -- Draw the 'About' window
 //   create_main_control_panel( main_x, main_y, main_w, main_h, cWindowLabel) 
 //     -- Create the main control panel window.
@@ -75,7 +77,6 @@
 //   read_data( *o, *u) -- Read data widget
 //   load_state( *o) -- Load saved state
 //   save_state( *o) -- Save current state
-//   redraw_if_changing( *dummy) -- Redraw changing plots
 //   reset_selection_arrays() -- Reset selection arrays
 //
 // Author: Creon Levit    2005-2006
@@ -97,10 +98,23 @@
 #include "control_panel_window.h"
 #include "brush.h"
 #include "unescape.h"
+#include "worker_pool.h"
+#include "brush_statistics.h"
+#include "column_profile.h"
+#include "column_buffers.h"
+#include "frame_scheduler.h"
+#include "selection_history.h"
+#include "selection_worker.h"
+#include "brush_algebra.h"
+#include "headless_renderer.h"
+#include "matrix_window.h"
 
 // Define and initialize number of screens
 static int number_of_screens = 0;
 
+// Size of the nominal screen on which plots are laid out in headless mode
+static const int headless_screen_w = 1600, headless_screen_h = 1200;
+
 // Approximate values of window manager borders & desktop borders (stay out of
 // these). The "*_frame" constants keep windows from crowding the coresponding 
 // screen edge.  The "*_safe" constants keep windows from overlapping each 
@@ -187,9 +201,14 @@ Fl_Input* maxpoints_input;
 Fl_Input* maxvars_input;
 Fl_Input* bad_value_proxy_input;
 Fl_Check_Button* use_VBOs_Button;
+Fl_Check_Button* asyncSelectionButton;
+Fl_Check_Button* simplifyButton;
+Fl_Check_Button* progressiveButton;
 
 // Function definitions for the main method
 void usage();
+int screen_width();
+int screen_height();
 void make_help_about_window( Fl_Widget *o);
 void create_main_control_panel(
   int main_x, int main_y, int main_w, int main_h, const char* cWindowLabel);
@@ -218,7 +237,6 @@ void read_data( Fl_Widget* o, void* user_data);
 int load_initial_state( string configFileSpec);
 int load_state( Fl_Widget* o);
 int save_state( Fl_Widget* o);
-void redraw_if_changing( void *dummy);
 void reset_selection_arrays();
 
 //***************************************************************************
@@ -249,6 +267,10 @@ void usage()
        << "Interpret CHAR as a field separator, default is" << endl
        << "                              "
        << "whitespace." << endl;
+  cerr << "  -a, --all_pairs             "
+       << "With --headless, render every pair of columns" << endl
+       << "                              "
+       << "using the settings of the first plot." << endl;
   cerr << "  -f, --format={ascii,binary,fits} " << endl
        << "                              "
        << "Input file format, default=ascii.  NOTE: for ASCII" << endl
@@ -256,6 +278,12 @@ void usage()
        << "files, the data block is assumed to begin with an" << endl
        << "                              "
        << "uncommented line that contains column labels" << endl;
+  cerr << "  -H, --headless=DIRECTORY    "
+       << "Render the plots to PNG files in DIRECTORY" << endl
+       << "                              "
+       << "without a display, then exit.  Needs a build" << endl
+       << "                              "
+       << "made with \"make HEADLESS=1\"." << endl;
   cerr << "  -i, --input_file=FILENAME   "
        << "Read input data from FILENAME." << endl;
   cerr << "  -I, --stdin                 "
@@ -291,6 +319,8 @@ void usage()
        << "Skip NLINES at start of input file, default=0." << endl;
   cerr << "  -t, --trivial_columns=(T,F) "
        << "Remove columns with a single value, default=TRUE." << endl;
+  cerr << "  -T, --matrix                "
+       << "Draw all plots as the cells of one window." << endl;
   cerr << "  -v, --nvars=NVARS           "
        << "Input has NVARS values per point (only for row" << endl
        << "                              "
@@ -307,6 +337,24 @@ void usage()
   exit( -1);
 }
 
+//***************************************************************************
+// screen_width() -- Width of the screen.  Without a display there is no 
+// screen to ask, so plots are laid out on a nominal one.
+int screen_width()
+{
+  if( headless_mode) return headless_screen_w;
+  return Fl::w();
+}
+
+//***************************************************************************
+// screen_height() -- Height of the screen, or of the nominal screen used 
+// in headless mode.
+int screen_height()
+{
+  if( headless_mode) return headless_screen_h;
+  return Fl::h();
+}
+
 //***************************************************************************
 // make_help_about_window( *o) -- Create the 'Help|About' window.
 void make_help_about_window( Fl_Widget *o)
@@ -354,7 +402,7 @@ void create_main_control_panel(
   Fl_Tooltip::hoverdelay(1.0);
   Fl_Tooltip::size(12);
 
-  int clipped_h = min( main_h, Fl::h() - (top_frame + bottom_frame));
+  int clipped_h = min( main_h, screen_height() - (top_frame + bottom_frame));
   main_control_panel = new Fl_Window( main_x, main_y, main_w, clipped_h, cWindowLabel);
   main_control_panel->resizable( main_control_panel);
 
@@ -640,6 +688,8 @@ void manage_plot_window_array( Fl_Widget *o, void* user_data)
     // could fail.
     if( thisOperation == NEW_DATA) {
       for( int i=0; i<nplots; i++) pws[i]->hide();
+      if( matrix_window != NULL) matrix_window->hide();
+      Column_Buffers::reset();
       nplots_old = 0;
     }
   }
@@ -748,11 +798,11 @@ void manage_plot_window_array( Fl_Widget *o, void* user_data)
     int scaled_main_w = w_save+6;
     if( laptop_mode) scaled_main_w = (int) (laptop_scale*main_w);
     int pw_w =
-      ( ( number_of_screens*Fl::w() - 
+      ( ( number_of_screens*screen_width() - 
           (scaled_main_w+left_frame+right_frame+right_safe+left_safe+20)) / ncols) -
       (left_frame + right_frame);
     int pw_h = 
-      ( (Fl::h() - (top_safe+bottom_safe))/ nrows) - 
+      ( (screen_height() - (top_safe+bottom_safe))/ nrows) - 
       (top_frame + bottom_frame);
 
     // Calculate default plot window positions
@@ -918,8 +968,9 @@ void manage_plot_window_array( Fl_Widget *o, void* user_data)
 
     // Make sure the window has been shown and check again to make absolutely 
     // sure it is resizable.  NOTE: pws[i]->show() with no arguments is not 
-    // sufficient when windows are created.
-    if( !pws[i]->shown()) {
+    // sufficient when windows are created.  Headless plots, and plots drawn
+    // by the matrix window, are never shown.
+    if( !pws[i]->shown() && !headless_mode && !matrix_mode) {
       DEBUG(cout << "showing plot window " << i << endl);
         pws[i]->show( global_argc, global_argv);
     }
@@ -934,9 +985,16 @@ void manage_plot_window_array( Fl_Widget *o, void* user_data)
   
   // Invoke Fl_Gl_Window::hide() (rather than the destructor, which may
   // produce strange behavior) to rid of any superfluous plot windows
-  // along with their contexts.
+  // along with their contexts.  Their shared column buffers are freed
+  // by the plots that remain.
   if( nplots < nplots_old)
-    for( int i=nplots; i<nplots_old; i++) pws[i]->hide();
+    for( int i=nplots; i<nplots_old; i++) {
+      pws[i]->release_buffers();
+      pws[i]->hide();
+    }
+
+  // In matrix mode, fit the matrix window to the new array of plots
+  Matrix_Window::arrange( global_argc, global_argv, borderless);
   
   // Create a master control panel to encompass all the tabs
   create_broadcast_group ();
@@ -1041,12 +1099,30 @@ void make_main_menu_bar()
     (Fl_Callback *) manage_plot_window_array);
 
   // Add Tools menu items
+  main_menu_bar->add( 
+    "Tools/Undo Selection     ", FL_CTRL+'z', 
+    (Fl_Callback *) Plot_Window::undo_selection);
+  main_menu_bar->add( 
+    "Tools/Redo Selection     ", FL_CTRL+FL_SHIFT+'z', 
+    (Fl_Callback *) Plot_Window::redo_selection);
+  main_menu_bar->add( 
+    "Tools/Combine Brushes    ", 0, 
+    (Fl_Callback *) Brush_Algebra::static_make_window, 0, FL_MENU_DIVIDER);
   main_menu_bar->add( 
     "Tools/Edit Column Labels ", 0, 
     (Fl_Callback *) dfm.edit_column_info);
   main_menu_bar->add( 
     "Tools/Statistics         ", 0, 
-    (Fl_Callback *) make_statistics_window, 0, FL_MENU_DIVIDER);
+    (Fl_Callback *) make_statistics_window);
+  main_menu_bar->add( 
+    "Tools/Add Density Column ", 0, 
+    (Fl_Callback *) Plot_Window::add_density_column);
+  main_menu_bar->add( 
+    "Tools/Live Statistics    ", 0, 
+    (Fl_Callback *) Brush_Statistics::static_make_window);
+  main_menu_bar->add( 
+    "Tools/Column Profiles    ", 0, 
+    (Fl_Callback *) Column_Profile::static_make_window, 0, FL_MENU_DIVIDER);
   main_menu_bar->add( 
     "Tools/Options...         ", 0, 
     // (Fl_Callback *) make_options_window, 0, FL_MENU_INACTIVE);
@@ -1223,7 +1299,7 @@ void make_options_window( Fl_Widget *o)
    
   // Create Tools|Options window
   Fl::scheme( "plastic");  // optional
-  options_window = new Fl_Window( 300, 250, "Options");
+  options_window = new Fl_Window( 300, 325, "Options");
   options_window->begin();
   options_window->selection_color( FL_BLUE);
   options_window->labelsize( 10);
@@ -1317,11 +1393,38 @@ void make_options_window( Fl_Widget *o)
     o->value( laptop_mode == true);
     o->tooltip( "Tiny control panel and fonts for small laptop screens");
   }
+
+  // Asynchronous selection checkbox
+  {
+    Fl_Check_Button* o = asyncSelectionButton = 
+      new Fl_Check_Button( 10, 210, 250, 20, " Select in Background Thread");
+    o->down_box( FL_DOWN_BOX);
+    o->value( async_selection == true);
+    o->tooltip( "Evaluate selections on a worker thread while dragging");
+  }
+
+  // Level of detail checkbox
+  {
+    Fl_Check_Button* o = simplifyButton = 
+      new Fl_Check_Button( 10, 235, 250, 20, " Simplify Plots While Interacting");
+    o->down_box( FL_DOWN_BOX);
+    o->value( simplify_while_interacting == true);
+    o->tooltip( "Draw a sample of the points while panning, zooming, spinning, or brushing");
+  }
+
+  // Progressive rendering checkbox
+  {
+    Fl_Check_Button* o = progressiveButton = 
+      new Fl_Check_Button( 10, 260, 250, 20, " Draw Large Plots Progressively");
+    o->down_box( FL_DOWN_BOX);
+    o->value( progressive_rendering == true);
+    o->tooltip( "Draw plots with too many points for one frame over several frames");
+  }
   
   // Invoke a multi-purpose callback function to process window
-  Fl_Button* ok_button = new Fl_Button( 150, 220, 40, 25, "&OK");
+  Fl_Button* ok_button = new Fl_Button( 150, 295, 40, 25, "&OK");
   ok_button->callback( (Fl_Callback*) cb_options_window, ok_button);
-  Fl_Button* cancel = new Fl_Button( 200, 220, 60, 25, "&Cancel");
+  Fl_Button* cancel = new Fl_Button( 200, 295, 60, 25, "&Cancel");
   cancel->callback( (Fl_Callback*) cb_options_window, cancel);
 
   // Done creating the 'Help|Options' window
@@ -1359,6 +1462,18 @@ void cb_options_window( Fl_Widget *o, void* user_data)
     // prefs_.set( "use_VBOs_mode", i_use_VBOs_mode);
     use_VBOs = ( i_use_VBOs_mode != 0);
 
+    int i_async_selection = asyncSelectionButton->value();
+    prefs_.set( "async_selection", i_async_selection);
+    async_selection = ( i_async_selection != 0);
+
+    int i_simplify = simplifyButton->value();
+    prefs_.set( "simplify_while_interacting", i_simplify);
+    simplify_while_interacting = ( i_simplify != 0);
+
+    int i_progressive = progressiveButton->value();
+    prefs_.set( "progressive_rendering", i_progressive);
+    progressive_rendering = ( i_progressive != 0);
+
     int maxpoints_value = (int) strtof( maxpoints_input->value(), NULL);
     dfm.maxpoints( maxpoints_value);
 
@@ -1553,7 +1668,7 @@ void change_all_axes( Fl_Widget *o)
            cps[i]->lock_axis2_button->value()))
       pws[i]->change_axes( 0);
   }
-  Plot_Window::redraw_all_plots(0);
+  Plot_Window::redraw_all_plots( 0, Frame_Scheduler::REDRAW_DATA);
 }
 
 //***************************************************************************
@@ -1563,7 +1678,7 @@ void change_all_axes( Fl_Widget *o)
 void npoints_changed( Fl_Widget *o) 
 {
   npoints = int( ( (Fl_Slider *)o)->value());
-  Plot_Window::redraw_all_plots( 0);
+  Plot_Window::redraw_all_plots( 0, Frame_Scheduler::REDRAW_DATA);
 }
 
 //***************************************************************************
@@ -2165,24 +2280,6 @@ int save_state( Fl_Widget* o)
   return 1;
 }
 
-//***************************************************************************
-// redraw_if_changing( dummy) -- Callback function for use by FLTK 
-// Fl::add_idle.  When an idle callback occurs, redraw any plot that is 
-// spinning or otherwise needs to be redrawn.
-void redraw_if_changing( void *dummy)
-{
-  // DEBUG( cout << "in redraw_if_changing" << endl) ;
-  for( int i=0; i<nplots; i++) {
-    // DEBUG ( cout << "  i=" << i << ", needs_redraw=" << pws[i]->needs_redraw << endl );
-    if( cps[i]->spin->value() || pws[i]->needs_redraw) {
-      pws[i]->redraw();
-      pws[i]->needs_redraw = 0;
-    }
-  }
-  Fl::repeat_timeout(0.01, redraw_if_changing);
-  return;
-}
-
 //***************************************************************************
 // reset_selection_arrays() -- Reset selection arrays to 'unselected'.
 void reset_selection_arrays()
@@ -2269,6 +2366,9 @@ int main( int argc, char **argv)
     { "stdin", no_argument, 0, 'I'},
 		// Apple OS X "provides" this next argument when any program invoked by clicking on its icon
     { "psn_", required_argument, 0, 'p'}, 
+    { "headless", required_argument, 0, 'H'},
+    { "all_pairs", no_argument, 0, 'a'},
+    { "matrix", no_argument, 0, 'T'},
     { 0, 0, 0, 0}
   };
 
@@ -2288,6 +2388,15 @@ int main( int argc, char **argv)
   int i_laptop_mode;
   prefs_.get( "laptop_mode", i_laptop_mode, 0);
   laptop_mode = ( i_laptop_mode != 0);
+  int i_async_selection;
+  prefs_.get( "async_selection", i_async_selection, 1);
+  async_selection = ( i_async_selection != 0);
+  int i_simplify;
+  prefs_.get( "simplify_while_interacting", i_simplify, 1);
+  simplify_while_interacting = ( i_simplify != 0);
+  int i_progressive;
+  prefs_.get( "progressive_rendering", i_progressive, 1);
+  progressive_rendering = ( i_progressive != 0);
 
   // Initialize the data file manager, just in case, even though this should
   // already have been done by the constructor, then set global pointer for 
@@ -2302,11 +2411,13 @@ int main( int argc, char **argv)
   int c;
   string inFileSpec = "";
   string configFileSpec = "";
+  string headlessDirectory = "";
+  int headless_pairs = 0;
   char delimiter_char_ = ' ';
   while( 
     ( c = getopt_long_only( 
         argc, argv, 
-        "f:n:v:s:t:o:P:r:c:m:i:C:M:d:bBhlLxOVIp", long_options, NULL)) != -1) {
+        "f:n:v:s:t:o:P:r:c:m:i:C:M:d:H:abBhlLxOVIpT", long_options, NULL)) != -1) {
   
     // Examine command-line options and extract any optional arguments
     switch( c) {
@@ -2490,6 +2601,22 @@ int main( int argc, char **argv)
         exit (0);
         break;
 
+     // render plots to PNG files without a display, and exit
+      case 'H':
+        headless_mode = true;
+        headlessDirectory.append( optarg);
+        break;
+
+     // in headless mode, render every pair of columns
+      case 'a':
+        headless_pairs = 1;
+        break;
+
+     // draw all plots as the cells of one window
+      case 'T':
+        matrix_mode = true;
+        break;
+
      // read from stdin instead of from a file.
       case 'I':
         read_from_stdin = true;
@@ -2546,6 +2673,15 @@ int main( int argc, char **argv)
   // gsl_rng_env_setup();   // Not needed
   vp_gsl_rng = gsl_rng_alloc( gsl_rng_mt19937);
 
+  // Start the pool of worker threads and create the objects that maintain 
+  // live statistics, selection history, and other selection tools
+  worker_pool = new Worker_Pool();
+  brush_statistics = new Brush_Statistics();
+  column_profile = new Column_Profile();
+  selection_history = new Selection_History();
+  selection_worker = new Selection_Worker();
+  brush_algebra = new Brush_Algebra();
+
   // Restrict format and restrict and initialize the number of plots.  NOTE: 
   // nplots will later be reset by manage_plot_window_array( NULL) 
   assert( nrows*ncols <= MAXPLOTS);
@@ -2570,15 +2706,14 @@ int main( int argc, char **argv)
   // Determine the number of screens.  NOTE screen_count requires OpenGL 1.7, 
   // which was not available under most Windows OS as of 10-APR-2006.
   #ifndef __WIN32__
-    if( number_of_screens <= 0)
+    if( number_of_screens <= 0 && !headless_mode)
       number_of_screens = Fl::screen_count();
-  #else 
-    if( number_of_screens <= 0)
-      number_of_screens = 1;
   #endif   // __WIN32__
+  if( number_of_screens <= 0)
+    number_of_screens = 1;
 
   // Set the main control panel size and position.
-  const int main_x = number_of_screens*Fl::w() - (main_w + left_frame + right_frame + right_safe);
+  const int main_x = number_of_screens*screen_width() - (main_w + left_frame + right_frame + right_safe);
   const int main_y = top_frame+top_safe;
 
   // Create the main control panel window
@@ -2599,7 +2734,7 @@ int main( int argc, char **argv)
     Plot_Window::initialize_selection();
 
   // Now we can show the main control panel and all its subpanels
-  main_control_panel->show();
+  if( !headless_mode) main_control_panel->show();
 
   // This should be moved to create_main_control_panel?
   main_scroll->add( main_scroll_group);
@@ -2608,13 +2743,13 @@ int main( int argc, char **argv)
   // Get screen sizes for laptop mode and use it if requested
   laptop_main_w = (int) (laptop_scale*main_w);
   laptop_main_h = (int) (laptop_scale*main_h);
-  if( laptop_mode) change_screen_mode();
+  if( laptop_mode && !headless_mode) change_screen_mode();
   
   // Step 5: Register functions to call on a reglar basis, when no other
-  // events (mouse, etc.) are waiting to be processed.
+  // events (mouse, etc.) are waiting to be processed.  Plots are drawn by
+  // the frame scheduler when they change, so start with one frame.
   // Do not use Fl::add_idle().  It causes causes a busy-wait loop.
-  // use Fl:add_timeout() instead.
-  Fl::add_timeout( 0.01, redraw_if_changing);
+  Frame_Scheduler::wake();
 
   // For some reason, add_timout doesn't seem to work.  But add_check 
   // seems to avoid the problem with the busy-wait loop
@@ -2624,8 +2759,23 @@ int main( int argc, char **argv)
   // Load initial configuration if one was specified
   if( configFileSpec.length() > 0) load_initial_state( configFileSpec);
 
-  // Enter the main event loop
-  int result = Fl::run();
+  // In headless mode, render the plots to files instead of entering the
+  // main event loop
+  int result;
+  if( headless_mode) {
+    int render_style = Headless_Renderer::RENDER_PLOTS;
+    if( headless_pairs) render_style = Headless_Renderer::RENDER_PAIRS;
+    result = Headless_Renderer::render( headlessDirectory, render_style);
+  }
+  else result = Fl::run();
+
+  // Stop background computations and the worker threads
+  delete brush_algebra;
+  delete selection_worker;
+  delete selection_history;
+  delete column_profile;
+  delete brush_statistics;
+  delete worker_pool;
 
   // Free the gsl random number generator
   gsl_rng_free( vp_gsl_rng);
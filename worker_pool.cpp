@@ -0,0 +1,220 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: worker_pool.cpp
+//
+// Class definitions:
+//   Worker_Pool -- Pool of worker threads
+//
+// Classes referenced: none
+//
+// Required packages
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Source code for <worker_pool.h>
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+// Include globals
+#include "global_definitions_vp.h"
+
+// Include associated headers and source code
+#include "worker_pool.h"
+
+//***************************************************************************
+// Worker_Pool::Worker_Pool( nthreads) -- Constructor.  Start nthreads worker
+// threads, or one fewer than the number of processors if nthreads is zero.
+Worker_Pool::Worker_Pool( int nthreads) : shutdown_( 0), nbusy_( 0)
+{
+  if( nthreads <= 0) nthreads = number_of_processors() - 1;
+  if( nthreads < 1) nthreads = 1;
+
+  pthread_mutex_init( &mutex_, NULL);
+  pthread_cond_init( &work_cond_, NULL);
+  pthread_cond_init( &done_cond_, NULL);
+
+  // Loop: Start threads.  If a thread can't be started, make do with the
+  // ones we have.
+  for( int i=0; i<nthreads; i++) {
+    pthread_t thread;
+    if( pthread_create( &thread, NULL, thread_main, (void*) this) != 0) {
+      cerr << " -WARNING: Worker_Pool could only start " << i
+           << " of " << nthreads << " threads" << endl;
+      break;
+    }
+    threads_.push_back( thread);
+  }
+  nthreads_ = threads_.size();
+}
+
+//***************************************************************************
+// Worker_Pool::~Worker_Pool() -- Destructor.  Let queued jobs finish, then
+// stop the threads.
+Worker_Pool::~Worker_Pool()
+{
+  wait_idle();
+  pthread_mutex_lock( &mutex_);
+  shutdown_ = 1;
+  pthread_cond_broadcast( &work_cond_);
+  pthread_mutex_unlock( &mutex_);
+  for( unsigned int i=0; i<threads_.size(); i++)
+    pthread_join( threads_[i], NULL);
+
+  pthread_cond_destroy( &done_cond_);
+  pthread_cond_destroy( &work_cond_);
+  pthread_mutex_destroy( &mutex_);
+}
+
+//***************************************************************************
+// Worker_Pool::number_of_processors() -- STATIC method to get the number of
+// processors, or 1 if this can't be determined.
+int Worker_Pool::number_of_processors()
+{
+  int nprocs = 1;
+  #ifdef __WIN32__
+    char *cNProcs = getenv( "NUMBER_OF_PROCESSORS");
+    if( cNProcs != NULL) nprocs = atoi( cNProcs);
+  #else
+    nprocs = (int) sysconf( _SC_NPROCESSORS_ONLN);
+  #endif // __WIN32__
+  if( nprocs < 1) nprocs = 1;
+  return nprocs;
+}
+
+//***************************************************************************
+// Worker_Pool::thread_main( *arg) -- STATIC main loop for each worker
+// thread.  Wait for a job, run it, and tell anyone waiting when the queue
+// is empty and all threads are idle.
+void *Worker_Pool::thread_main( void *arg)
+{
+  Worker_Pool *pool = (Worker_Pool *) arg;
+  pthread_mutex_lock( &pool->mutex_);
+  for( ; ;) {
+    while( pool->queue_.empty() && !pool->shutdown_)
+      pthread_cond_wait( &pool->work_cond_, &pool->mutex_);
+    if( pool->queue_.empty() && pool->shutdown_) break;
+
+    Job job = pool->queue_.front();
+    pool->queue_.pop_front();
+    pool->nbusy_++;
+    if( job.range != NULL) job.range->nhelpers++;
+    pthread_mutex_unlock( &pool->mutex_);
+
+    if( job.range != NULL) pool->run_chunks( job.range);
+    else (*job.fn)( job.data);
+
+    pthread_mutex_lock( &pool->mutex_);
+    pool->nbusy_--;
+    if( job.range != NULL) job.range->nhelpers--;
+    pthread_cond_broadcast( &pool->done_cond_);
+  }
+  pthread_mutex_unlock( &pool->mutex_);
+  return NULL;
+}
+
+//***************************************************************************
+// Worker_Pool::submit( fn, data) -- Queue a background job.  The job must
+// not touch FLTK or OpenGL, and data must remain valid until it finishes.
+void Worker_Pool::submit( void (*fn)( void*), void *data)
+{
+  Job job;
+  job.fn = fn;
+  job.data = data;
+  job.range = (Parallel_Range *) NULL;
+  pthread_mutex_lock( &mutex_);
+  queue_.push_back( job);
+  pthread_cond_signal( &work_cond_);
+  pthread_mutex_unlock( &mutex_);
+}
+
+//***************************************************************************
+// Worker_Pool::wait_idle() -- Block until all queued jobs have finished.
+// Used before data that background jobs might be reading is changed.
+void Worker_Pool::wait_idle()
+{
+  pthread_mutex_lock( &mutex_);
+  while( !queue_.empty() || nbusy_ > 0)
+    pthread_cond_wait( &done_cond_, &mutex_);
+  pthread_mutex_unlock( &mutex_);
+}
+
+//***************************************************************************
+// Worker_Pool::run_chunks( *range) -- Claim and execute chunks of a
+// parallel loop until none are left.  Called by the main thread and by
+// helper jobs.
+void Worker_Pool::run_chunks( Parallel_Range *range)
+{
+  for( ; ;) {
+    pthread_mutex_lock( &mutex_);
+    int ichunk = range->next_chunk++;
+    pthread_mutex_unlock( &mutex_);
+    if( ichunk >= range->nchunks) break;
+
+    int begin = (int) ( ((long long) range->n * ichunk) / range->nchunks);
+    int end = (int) ( ((long long) range->n * (ichunk+1)) / range->nchunks);
+    (*range->fn)( begin, end, ichunk, range->data);
+
+    pthread_mutex_lock( &mutex_);
+    range->nfinished++;
+    if( range->nfinished == range->nchunks)
+      pthread_cond_broadcast( &done_cond_);
+    pthread_mutex_unlock( &mutex_);
+  }
+}
+
+//***************************************************************************
+// Worker_Pool::parallel_for( n, nchunks, fn, data) -- Split the range
+// [0,n) into nchunks contiguous chunks and call fn( begin, end, ichunk,
+// data) once for each.  Chunks run concurrently on idle workers and on the
+// calling thread, so fn must only write to storage that belongs to its
+// chunk.  Returns when every chunk has finished.
+void Worker_Pool::parallel_for(
+  int n, int nchunks, void (*fn)( int, int, int, void*), void *data)
+{
+  if( n <= 0) return;
+  if( nchunks < 1) nchunks = 1;
+
+  Parallel_Range range;
+  range.fn = fn;
+  range.data = data;
+  range.n = n;
+  range.nchunks = nchunks;
+  range.next_chunk = 0;
+  range.nfinished = 0;
+  range.nhelpers = 0;
+
+  // Ask idle workers for help.  Helper jobs go to the front of the queue
+  // so they aren't stuck behind background jobs.
+  int nhelp = nchunks-1;
+  if( nhelp > nthreads_) nhelp = nthreads_;
+  pthread_mutex_lock( &mutex_);
+  for( int i=0; i<nhelp; i++) {
+    Job job;
+    job.fn = NULL;
+    job.data = NULL;
+    job.range = &range;
+    queue_.push_front( job);
+  }
+  pthread_cond_broadcast( &work_cond_);
+  pthread_mutex_unlock( &mutex_);
+
+  // Do our share of the work, then withdraw any help that never arrived
+  // and wait for the helpers that did.  The range lives on this stack, so
+  // no helper may still refer to it when we return.
+  run_chunks( &range);
+  pthread_mutex_lock( &mutex_);
+  for( std::deque<Job>::iterator iter = queue_.begin(); iter != queue_.end();) {
+    if( iter->range == &range) iter = queue_.erase( iter);
+    else iter++;
+  }
+  while( range.nfinished < range.nchunks || range.nhelpers > 0)
+    pthread_cond_wait( &done_cond_, &mutex_);
+  pthread_mutex_unlock( &mutex_);
+}
@@ -0,0 +1,107 @@
+// viewpoints - interactive linked scatterplots and more.
+// copyright 2005 Creon Levit and Paul Gazis, all rights reserved.
+//***************************************************************************
+// File name: worker_pool.h
+//
+// Class definitions:
+//   Worker_Pool -- Pool of worker threads
+//
+// Classes referenced: none
+//
+// Required packages
+//    pthreads -- POSIX threads (pthreads-win32 under Windows)
+//
+// Compiler directives:
+//   May require D__WIN32__ for the C++ compiler
+//
+// Purpose: Maintain a small pool of worker threads that can run background
+//   jobs, so that slow computations don't block the user interface, and
+//   split loops over points into chunks that run in parallel.
+//
+// General design philosophy:
+//   1) Worker threads must never call FLTK or OpenGL.  Background jobs
+//      publish their results in memory, and the main thread picks them up
+//      from a timeout or idle callback.
+//   2) The main thread always helps with its own parallel loops, so a loop
+//      finishes even if every worker is busy with a background job.
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+
+// Protection to make sure this header is not included twice
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H 1
+
+// Include the necessary include libraries
+#include "include_libraries_vp.h"
+
+//***************************************************************************
+// Class: Worker_Pool
+//
+// Class definitions:
+//   Worker_Pool -- Pool of worker threads
+//
+// Classes referenced: none
+//
+// Purpose: Run background jobs and parallel loops on worker threads.
+//
+// Functions:
+//   Worker_Pool( nthreads) -- Constructor
+//   ~Worker_Pool() -- Destructor
+//
+//   nthreads() -- Get number of worker threads
+//   submit( fn, data) -- Queue a background job
+//   wait_idle() -- Wait until all queued jobs have finished
+//   parallel_for( n, nchunks, fn, data) -- Run a loop in chunks
+//
+// Static functions:
+//   thread_main( *arg) -- Main loop for each worker thread
+//   run_chunks( *range) -- Execute chunks of a parallel loop
+//   number_of_processors() -- Number of processors, if known
+//
+// Author: P. R. Gazis  19-OCT-2026
+//***************************************************************************
+class Worker_Pool
+{
+  protected:
+    // Parallel loop currently being executed
+    struct Parallel_Range {
+      void (*fn)( int, int, int, void*);
+      void *data;
+      int n, nchunks;
+      int next_chunk, nfinished, nhelpers;
+    };
+
+    // Queued job.  Helper jobs execute chunks of a parallel loop.
+    struct Job {
+      void (*fn)( void*);
+      void *data;
+      Parallel_Range *range;
+    };
+
+    int nthreads_;
+    int shutdown_;
+    int nbusy_;
+    std::vector<pthread_t> threads_;
+    std::deque<Job> queue_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t work_cond_;
+    pthread_cond_t done_cond_;
+
+    static void *thread_main( void *arg);
+    void run_chunks( Parallel_Range *range);
+
+  public:
+    Worker_Pool( int nthreads = 0);
+    ~Worker_Pool();
+
+    int nthreads() { return nthreads_;}
+    void submit( void (*fn)( void*), void *data);
+    void wait_idle();
+    void parallel_for(
+      int n, int nchunks, void (*fn)( int, int, int, void*), void *data);
+
+    static int number_of_processors();
+};
+
+#endif   // WORKER_POOL_H